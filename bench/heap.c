@@ -0,0 +1,150 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/heap.h"
+#include "gb/thread.h"
+#include "gb/time.h"
+#include "gb/io.h"
+
+//
+// Multi-threaded alloc/free benchmark: gb_heap_allocator() against gb_malloc_allocator()
+//
+// Every thread keeps SLOT_COUNT live blocks and keeps replacing a random one with a new
+// block of random size. Half of the replaced blocks are handed to the next thread to be
+// freed there so cross-thread frees are part of the workload.
+//
+
+#define MAX_THREADS 64
+#define SLOT_COUNT  1024
+#define OP_COUNT    (1 << 20)
+#define MAX_SIZE    1024
+
+typedef struct bench_thread {
+  gb_allocator_t allocator;
+  gbAtomicPtr inbox;
+  struct bench_thread *next;
+  uint64_t seed;
+  uint8_t padding[GB_CACHE_LINE_SIZE];
+} bench_thread_t;
+
+gb_internal gb_inline uint64_t bench_rand(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+// NOTE: Lock-free stack of blocks waiting to be freed by the receiving thread
+gb_internal void bench_post(bench_thread_t *t, void *ptr) {
+  void *head;
+  do {
+    head = gb_atomic_ptr_load(&t->inbox);
+    *cast(void **) ptr = head;
+  } while (gb_atomic_ptr_compare_exchange(&t->inbox, head, ptr) != head);
+}
+
+gb_internal void bench_drain(bench_thread_t *t) {
+  void *ptr = gb_atomic_ptr_exchanged(&t->inbox, NULL);
+  while (ptr) {
+    void *next = *cast(void **) ptr;
+    gb_free(t->allocator, ptr);
+    ptr = next;
+  }
+}
+
+GB_THREAD_PROC(bench_proc) {
+  bench_thread_t *t = cast(bench_thread_t *) data;
+  void *slots[SLOT_COUNT] = {0};
+  ssize_t i;
+
+  for (i = 0; i < OP_COUNT; i++) {
+    uint64_t r = bench_rand(&t->seed);
+    ssize_t slot = cast(ssize_t) (r % SLOT_COUNT);
+    ssize_t size = gb_size_of(void *) + cast(ssize_t) ((r >> 16) % MAX_SIZE);
+
+    if (slots[slot]) {
+      if ((r >> 40) & 1)
+        bench_post(t->next, slots[slot]);
+      else
+        gb_free(t->allocator, slots[slot]);
+    }
+    slots[slot] = gb_alloc(t->allocator, size);
+    if ((i & 255) == 0)
+      bench_drain(t);
+  }
+
+  for (i = 0; i < SLOT_COUNT; i++)
+    gb_free(t->allocator, slots[i]);
+}
+
+gb_internal float64_t bench_run(gb_allocator_t a, ssize_t thread_count) {
+  gb_local_persist bench_thread_t ctx[MAX_THREADS];
+  gb_local_persist gbThread threads[MAX_THREADS];
+  float64_t start, end;
+  ssize_t i;
+
+  for (i = 0; i < thread_count; i++) {
+    ctx[i].allocator = a;
+    ctx[i].inbox.value = NULL;
+    ctx[i].next = &ctx[(i + 1) % thread_count];
+    ctx[i].seed = 0x9e3779b97f4a7c15ull * (i + 1);
+    gb_thread_init(&threads[i]);
+  }
+
+  start = gb_time_now();
+  for (i = 0; i < thread_count; i++)
+    gb_thread_start(&threads[i], bench_proc, &ctx[i]);
+  for (i = 0; i < thread_count; i++)
+    gb_thread_join(&threads[i]);
+  end = gb_time_now();
+
+  for (i = 0; i < thread_count; i++) {
+    bench_drain(&ctx[i]);
+    gb_thread_destory(&threads[i]);
+  }
+
+  return (cast(float64_t) OP_COUNT * thread_count) / (end - start);
+}
+
+int main(void) {
+  gb_affinity_t affinity;
+  ssize_t n, max_threads;
+
+  gb_affinity_init(&affinity);
+  max_threads = gb_min(affinity.thread_count, MAX_THREADS);
+  gb_affinity_destroy(&affinity);
+
+  gb_printf("%8s %16s %16s %8s\n", "threads", "heap Mops/s", "malloc Mops/s", "ratio");
+  for (n = 1; n <= max_threads; n *= 2) {
+    float64_t heap = bench_run(gb_heap_allocator(), n);
+    float64_t libc = bench_run(gb_malloc_allocator(), n);
+    gb_printf("%8td %16.2f %16.2f %8.2f\n", n, heap * 1.0e-6, libc * 1.0e-6, heap / libc);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/htable.h"
+#include "gb/time.h"
+#include "gb/io.h"
+
+//
+// GB_FLAT_TABLE against GB_TABLE with uint64_t keys
+//
+// For every size both tables are filled with `count` distinct keys (no reserve, so growth is part of the
+// insert cost), then probed for every key in a scattered order (hits) and for as many absent keys
+// (misses). The sizes go from 1M up to the key count given on the command line, 100M by default, which
+// needs a few gigabytes per table.
+//
+
+#define LOOKUP_STRIDE 2654435761ull // NOTE: Prime, coprime with every size so the order is a permutation
+#define BATCH_SIZE    4096
+
+GB_TABLE(static, ChainTable, chain_table_, uint64_t);
+GB_FLAT_TABLE(static, FlatTable, flat_table_, uint64_t);
+
+gb_internal gb_inline uint64_t bench_key(uint64_t i) {
+  return (i + 1) * 0x9e3779b97f4a7c15ull;
+}
+
+typedef struct bench_result {
+  float64_t insert, hit, miss; // NOTE: Nanoseconds per operation
+} bench_result_t;
+
+#define BENCH_TABLE(FUNC, TYPE, result, count) do { \
+  TYPE h; \
+  uint64_t i, sum = 0; \
+  float64_t t0, t1, t2, t3; \
+  FUNC##init(&h, gb_heap_allocator()); \
+  t0 = gb_time_now(); \
+  for (i = 0; i < (count); i++) \
+    FUNC##set(&h, bench_key(i), i); \
+  t1 = gb_time_now(); \
+  for (i = 0; i < (count); i++) \
+    sum += *FUNC##get(&h, bench_key((i * LOOKUP_STRIDE) % (count))); \
+  t2 = gb_time_now(); \
+  for (i = 0; i < (count); i++) \
+    sum += FUNC##get(&h, bench_key((count) + (i * LOOKUP_STRIDE) % (count))) != NULL; \
+  t3 = gb_time_now(); \
+  GB_ASSERT(sum == (count) * ((count) - 1) / 2); \
+  FUNC##destroy(&h); \
+  (result).insert = (t1 - t0) * 1.0e9 / (count); \
+  (result).hit    = (t2 - t1) * 1.0e9 / (count); \
+  (result).miss   = (t3 - t2) * 1.0e9 / (count); \
+} while (0)
+
+gb_global uint64_t  batch_keys[BATCH_SIZE];
+gb_global uint64_t  batch_values[BATCH_SIZE];
+gb_global uint64_t *batch_found[BATCH_SIZE];
+
+gb_internal void bench_batched(uint64_t count, bench_result_t *single, bench_result_t *batched) {
+  ChainTable h;
+  uint64_t base, i, sum = 0;
+  float64_t t0, t1;
+  int32_t pass;
+
+  for (pass = 0; pass < 2; pass++) {
+    bench_result_t *result = pass ? batched : single;
+    chain_table_init(&h, gb_heap_allocator());
+
+    t0 = gb_time_now();
+    for (base = 0; base < count; base += BATCH_SIZE) {
+      uint64_t n = gb_min(count - base, BATCH_SIZE);
+      for (i = 0; i < n; i++) {
+        batch_keys[i] = bench_key(base + i);
+        batch_values[i] = base + i;
+      }
+      if (pass) {
+        chain_table_set_many(&h, batch_keys, batch_values, cast(ssize_t) n);
+      } else {
+        for (i = 0; i < n; i++)
+          chain_table_set(&h, batch_keys[i], batch_values[i]);
+      }
+    }
+    t1 = gb_time_now();
+    result->insert = (t1 - t0) * 1.0e9 / count;
+
+    t0 = gb_time_now();
+    for (base = 0; base < count; base += BATCH_SIZE) {
+      uint64_t n = gb_min(count - base, BATCH_SIZE);
+      for (i = 0; i < n; i++)
+        batch_keys[i] = bench_key(((base + i) * LOOKUP_STRIDE) % count);
+      if (pass) {
+        chain_table_get_many(&h, batch_keys, cast(ssize_t) n, batch_found);
+      } else {
+        for (i = 0; i < n; i++)
+          batch_found[i] = chain_table_get(&h, batch_keys[i]);
+      }
+      for (i = 0; i < n; i++)
+        sum += *batch_found[i];
+    }
+    t1 = gb_time_now();
+    result->hit = (t1 - t0) * 1.0e9 / count;
+    result->miss = 0;
+
+    chain_table_destroy(&h);
+  }
+  GB_ASSERT(sum == count * (count - 1));
+}
+
+int main(int argc, char **argv) {
+  uint64_t count, max_count = 100000000;
+
+  if (argc > 1)
+    max_count = cast(uint64_t) gb_str_to_i64(argv[1], NULL, 10);
+
+  gb_printf("%12s %8s %14s %14s %8s\n", "keys", "op", "GB_TABLE ns", "FLAT ns", "ratio");
+  for (count = 1000000; count <= max_count; count *= 10) {
+    bench_result_t chain, flat;
+    BENCH_TABLE(chain_table_, ChainTable, chain, count);
+    BENCH_TABLE(flat_table_, FlatTable, flat, count);
+    gb_printf("%12llu %8s %14.1f %14.1f %8.2f\n", cast(unsigned long long) count, "insert", chain.insert, flat.insert, chain.insert / flat.insert);
+    gb_printf("%12llu %8s %14.1f %14.1f %8.2f\n", cast(unsigned long long) count, "hit",    chain.hit,    flat.hit,    chain.hit / flat.hit);
+    gb_printf("%12llu %8s %14.1f %14.1f %8.2f\n", cast(unsigned long long) count, "miss",   chain.miss,   flat.miss,   chain.miss / flat.miss);
+  }
+
+  gb_printf("\n%12s %8s %14s %14s %8s\n", "keys", "op", "one by one ns", "batched ns", "ratio");
+  for (count = 1000000; count <= max_count; count *= 10) {
+    bench_result_t single, batched;
+    bench_batched(count, &single, &batched);
+    gb_printf("%12llu %8s %14.1f %14.1f %8.2f\n", cast(unsigned long long) count, "insert", single.insert, batched.insert, single.insert / batched.insert);
+    gb_printf("%12llu %8s %14.1f %14.1f %8.2f\n", cast(unsigned long long) count, "hit",    single.hit,    batched.hit,    single.hit / batched.hit);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/profile.h"
+#include "gb/heap.h"
+#include "gb/thread.h"
+#include "gb/time.h"
+
+//
+// Overhead of the sampling heap profiler on gb_heap_allocator()
+//
+// Same churn with and without the profiler in front of the heap: SLOT_COUNT live blocks of random
+// sizes, a random one replaced at every step. Every round runs the heap alone, an idle profiler (which
+// never samples) and a sampling one back to back, each on a fresh thread so they start from the same
+// empty thread cache and the sampling countdown of one does not leak into the next. The medians of
+// ROUND_COUNT rounds are reported, machine noise hits all three alike.
+//
+// This churns through gigabytes per second, far more than any real program, so the overhead is split
+// in the cost of the unsampled path (a profiler that never samples) and the cost of a single sample.
+// What a program pays is the first plus the second times its allocation rate over the period, the sampling
+// profiler runs with a short period so the second is measured over many samples.
+//
+
+#define SLOT_COUNT  4096
+#define OP_COUNT    (1 << 22)
+#define ROUND_COUNT 9
+#define MAX_SIZE    2048
+
+typedef struct BenchRun {
+  gb_allocator_t allocator;
+  float64_t ns_per_op;
+  void *slots[SLOT_COUNT];
+} BenchRun;
+
+gb_internal gb_inline uint64_t bench_rand(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+GB_THREAD_PROC(bench_run) {
+  BenchRun *run = cast(BenchRun *) data;
+  gb_allocator_t a = run->allocator;
+  uint64_t seed = 0x9e3779b97f4a7c15ull;
+  float64_t start, end;
+  ssize_t i;
+
+  start = gb_time_now();
+  for (i = 0; i < OP_COUNT; i++) {
+    uint64_t r = bench_rand(&seed);
+    ssize_t slot = cast(ssize_t) (r % SLOT_COUNT);
+    ssize_t size = 1 + cast(ssize_t) ((r >> 16) % MAX_SIZE);
+    if (run->slots[slot])
+      gb_free(a, run->slots[slot]);
+    run->slots[slot] = gb_alloc_uninit(a, size);
+  }
+  for (i = 0; i < SLOT_COUNT; i++) {
+    gb_free(a, run->slots[i]);
+    run->slots[i] = NULL;
+  }
+  end = gb_time_now();
+  gb_heap_thread_flush();
+
+  run->ns_per_op = (end - start) * 1.0e9 / cast(float64_t) OP_COUNT;
+}
+
+gb_internal float64_t bench_thread(BenchRun *run, gb_allocator_t a) {
+  gbThread thread;
+  run->allocator = a;
+  gb_thread_init(&thread);
+  gb_thread_start(&thread, bench_run, run);
+  gb_thread_join(&thread);
+  gb_thread_destory(&thread);
+  return run->ns_per_op;
+}
+
+gb_internal float64_t bench_median(float64_t *values) {
+  ssize_t i, j;
+  for (i = 1; i < ROUND_COUNT; i++) {
+    float64_t v = values[i];
+    for (j = i; j > 0 && values[j - 1] > v; j--)
+      values[j] = values[j - 1];
+    values[j] = v;
+  }
+  return values[ROUND_COUNT / 2];
+}
+
+gb_global BenchRun run;
+
+int main(void) {
+  gb_heap_profiler_t idle, profiler;
+  float64_t heap[ROUND_COUNT], unsampled[ROUND_COUNT], sampled[ROUND_COUNT];
+  float64_t heap_ns, unsampled_ns, sampled_ns, fast_path, per_sample;
+  ssize_t round, i, samples = 0;
+
+  gb_heap_profiler_init(&idle, gb_heap_allocator(), cast(ssize_t) 1 << 62);
+  // NOTE: Far shorter than the default period so the samples stand out of the noise
+  gb_heap_profiler_init(&profiler, gb_heap_allocator(), gb_kilobytes(64));
+  for (round = 0; round < ROUND_COUNT; round++) {
+    heap[round] = bench_thread(&run, gb_heap_allocator());
+    unsampled[round] = bench_thread(&run, gb_heap_profiler_allocator(&idle));
+    sampled[round] = bench_thread(&run, gb_heap_profiler_allocator(&profiler));
+  }
+  for (i = 0; i < gb_array_count(profiler.stacks.entries); i++)
+    samples += profiler.stacks.entries[i].value.alloc_count;
+  samples /= ROUND_COUNT;
+
+  heap_ns = bench_median(heap);
+  unsampled_ns = bench_median(unsampled);
+  sampled_ns = bench_median(sampled);
+  fast_path = unsampled_ns - heap_ns;
+  per_sample = (sampled_ns - unsampled_ns) * OP_COUNT / gb_max(samples, 1);
+
+  gb_printf("%16s %16s %16s %8s\n", "heap ns/op", "unsampled ns/op", "sampled ns/op", "samples");
+  gb_printf("%16.2f %16.2f %16.2f %8td\n", heap_ns, unsampled_ns, sampled_ns, samples);
+  gb_printf("unsampled path %.2f ns/op (%.1f%%), %.0f ns/sample, period %td bytes\n",
+            fast_path, 100.0 * fast_path / heap_ns, per_sample, profiler.sample_period);
+
+  gb_heap_profiler_free(&idle);
+  gb_heap_profiler_free(&profiler);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/shtable.h"
+#include "gb/htable.h"
+#include "gb/thread.h"
+#include "gb/time.h"
+#include "gb/io.h"
+
+//
+// Scaling of GB_SHARDED_TABLE against a GB_TABLE behind a single lock
+//
+// KEY_COUNT keys are inserted up front, then 1 to MAX_THREADS threads run OP_COUNT operations each on
+// random keys: READ_PERCENT lookups, the rest increments of the value. Throughput is reported in millions
+// of operations per second over all threads, the best of ROUND_COUNT runs.
+//
+
+#define KEY_COUNT    (1 << 20)
+#define OP_COUNT     (1 << 20)
+#define READ_PERCENT 90
+#define MAX_THREADS  64
+#define ROUND_COUNT  3
+
+GB_SHARDED_TABLE(static, ShardedTable, sharded_table_, uint64_t);
+GB_TABLE(static, LockedTable, locked_table_, uint64_t);
+
+gb_global ShardedTable sharded;
+gb_global LockedTable  locked;
+gb_global gbAtomic32   locked_lock;
+gb_global gbAtomic32   start_flag;
+
+gb_internal gb_inline uint64_t bench_rand(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+gb_internal void bench_increment(uint64_t *value, byte32_t found, void *data) {
+  ++*value;
+}
+
+gb_internal GB_THREAD_PROC(sharded_worker) {
+  uint64_t seed = 0x9e3779b97f4a7c15ull * (1 + cast(uintptr_t) data), sum = 0, value;
+  ssize_t i;
+
+  while (!gb_atomic32_load(&start_flag))
+    gb_yield_thread();
+  for (i = 0; i < OP_COUNT; i++) {
+    uint64_t r = bench_rand(&seed), key = r % KEY_COUNT;
+    if ((r >> 32) % 100 < READ_PERCENT) {
+      if (sharded_table_get(&sharded, key, &value))
+        sum += value;
+    } else {
+      sharded_table_update(&sharded, key, bench_increment, NULL);
+    }
+  }
+  GB_ASSERT(sum != 1); // NOTE: Keep the lookups alive
+}
+
+gb_internal GB_THREAD_PROC(locked_worker) {
+  uint64_t seed = 0x9e3779b97f4a7c15ull * (1 + cast(uintptr_t) data), sum = 0;
+  ssize_t i;
+
+  while (!gb_atomic32_load(&start_flag))
+    gb_yield_thread();
+  for (i = 0; i < OP_COUNT; i++) {
+    uint64_t r = bench_rand(&seed), key = r % KEY_COUNT, *value;
+    while (!gb_atomic32_spin_lock(&locked_lock, 64))
+      gb_yield();
+    value = locked_table_get(&locked, key);
+    if ((r >> 32) % 100 < READ_PERCENT)
+      sum += *value;
+    else
+      ++*value;
+    gb_atomic32_spin_unlock(&locked_lock);
+  }
+  GB_ASSERT(sum != 1);
+}
+
+gb_internal float64_t bench_run(gbThreadProc *proc, ssize_t thread_count) {
+  gbThread threads[MAX_THREADS];
+  float64_t start, end;
+  ssize_t i;
+
+  gb_atomic32_store(&start_flag, 0);
+  for (i = 0; i < thread_count; i++) {
+    gb_thread_init(&threads[i]);
+    gb_thread_start(&threads[i], proc, cast(void *) cast(uintptr_t) i);
+  }
+  start = gb_time_now();
+  gb_atomic32_store(&start_flag, 1);
+  for (i = 0; i < thread_count; i++) {
+    gb_thread_join(&threads[i]);
+    gb_thread_destory(&threads[i]);
+  }
+  end = gb_time_now();
+
+  return cast(float64_t) thread_count * OP_COUNT / (end - start) / 1.0e6;
+}
+
+int main(void) {
+  ssize_t i, thread_count;
+
+  sharded_table_init(&sharded, gb_heap_allocator(), 0);
+  locked_table_init(&locked, gb_heap_allocator());
+  for (i = 0; i < KEY_COUNT; i++) {
+    sharded_table_set(&sharded, cast(uint64_t) i, 0);
+    locked_table_set(&locked, cast(uint64_t) i, 0);
+  }
+
+  gb_printf("%8s %16s %16s %8s\n", "threads", "locked Mop/s", "sharded Mop/s", "ratio");
+  for (thread_count = 1; thread_count <= MAX_THREADS; thread_count *= 2) {
+    float64_t best_locked = 0, best_sharded = 0;
+    for (i = 0; i < ROUND_COUNT; i++) {
+      float64_t l = bench_run(locked_worker, thread_count);
+      float64_t s = bench_run(sharded_worker, thread_count);
+      if (l > best_locked)  best_locked = l;
+      if (s > best_sharded) best_sharded = s;
+    }
+    gb_printf("%8td %16.2f %16.2f %8.2f\n", thread_count, best_locked, best_sharded, best_sharded / best_locked);
+  }
+
+  sharded_table_destroy(&sharded);
+  locked_table_destroy(&locked);
+  return EXIT_SUCCESS;
+}
@@ -41,6 +41,7 @@
 #include "gb/thread.h"
 #include "gb/affinity.h"
 #include "gb/alloc.h"
+#include "gb/heap.h"
 #include "gb/sort.h"
 #include "gb/ctype.h"
 #include "gb/math.h"
@@ -51,6 +52,10 @@
 #include "gb/vector.h"
 #include "gb/hash.h"
 #include "gb/htable.h"
+#include "gb/slotmap.h"
+#include "gb/shtable.h"
+#include "gb/track.h"
+#include "gb/profile.h"
 #include "gb/fs.h"
 #include "gb/io.h"
 #include "gb/dll.h"
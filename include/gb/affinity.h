@@ -32,10 +32,21 @@
 
 typedef struct gb_affinity gb_affinity_t;
 
+// NOTE: Logical processors and NUMA nodes past these are folded onto node 0
+#ifndef GB_AFFINITY_MAX_THREADS
+#define GB_AFFINITY_MAX_THREADS 256
+#endif
+
+#ifndef GB_AFFINITY_MAX_NODES
+#define GB_AFFINITY_MAX_NODES 16
+#endif
+
 struct gb_affinity {
   byte32_t is_accurate;
   ssize_t core_count;
   ssize_t thread_count;
+  ssize_t node_count;                            // NOTE: Highest NUMA node id + 1, 1 without NUMA
+  uint8_t thread_nodes[GB_AFFINITY_MAX_THREADS]; // NOTE: NUMA node of every logical processor
 #if defined(GB_SYSTEM_WINDOWS)
   # define GB_WIN32_MAX_THREADS (8 * gb_size_of(size_t))
   size_t core_masks[GB_WIN32_MAX_THREADS];
@@ -51,4 +62,9 @@ GB_DEF void     gb_affinity_destroy(gb_affinity_t *a);
 GB_DEF byte32_t gb_affinity_set(gb_affinity_t *a, ssize_t core, ssize_t thread);
 GB_DEF ssize_t  gb_affinity_thread_count_for_core(gb_affinity_t *a, ssize_t core);
 
+// NOTE: Nodes come from /sys/devices/system/node on Linux and GetNumaProcessorNode on Windows
+GB_DEF int32_t  gb_affinity_node_of_thread(gb_affinity_t *a, ssize_t logical_processor);
+// NOTE: NUMA node of the processor the calling thread runs on right now, 0 when unknown
+GB_DEF int32_t  gb_affinity_current_node(void);
+
 #endif /* GB_AFFINITY_H__ */
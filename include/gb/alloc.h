@@ -49,11 +49,22 @@ typedef struct gb_virtual_memory gb_virtual_memory_t;
 typedef struct gb_allocator gb_allocator_t;
 typedef struct gb_arena gb_arena_t;
 typedef struct gb_temp_arena_memory gb_temp_arena_memory_t;
+typedef struct gb_numa_arena gb_numa_arena_t;
 typedef struct gb_pool gb_pool_t;
+typedef struct gb_pool_magazine gb_pool_magazine_t;
+typedef struct gb_concurrent_pool gb_concurrent_pool_t;
+typedef struct gb_slab_page gb_slab_page_t;
+typedef struct gb_slab_large gb_slab_large_t;
+typedef struct gb_slab gb_slab_t;
 typedef struct gb_allocation_header gb_allocation_header_t;
 typedef struct gb_free_list_block gb_free_list_block_t;
 typedef struct gb_free_list gb_free_list_t;
 typedef struct gb_scratch_memory gb_scratch_memory_t;
+typedef struct gb_scratch_frame gb_scratch_frame_t;
+typedef struct gb_fixed_heap gb_fixed_heap_t;
+typedef struct gb_fixed_heap_stats gb_fixed_heap_stats_t;
+typedef struct gb_stack gb_stack_t;
+typedef struct gb_stack_marker gb_stack_marker_t;
 
 struct gb_virtual_memory {
   void *data;
@@ -67,6 +78,27 @@ GB_DEF gb_virtual_memory_t gb_vm_trim(gb_virtual_memory_t vm, ssize_t lead_size,
 GB_DEF byte32_t gb_vm_purge(gb_virtual_memory_t vm);
 GB_DEF ssize_t gb_virtual_memory_page_size(ssize_t *alignment_out);
 
+// NOTE: Address space only, pages must be committed before use
+GB_DEF gb_virtual_memory_t gb_vm_reserve(void *addr, ssize_t size);
+GB_DEF byte32_t gb_vm_commit(gb_virtual_memory_t vm);
+GB_DEF byte32_t gb_vm_decommit(gb_virtual_memory_t vm);
+
+#ifndef GB_VM_HUGE_PAGE_SIZE
+#define GB_VM_HUGE_PAGE_SIZE gb_megabytes(2)
+#endif
+
+#define GB_VM_NUMA_ANY (-1)
+
+enum gb_vm_flag {
+  gbVmFlag_HugePages            = GB_BIT(0), // NOTE: Explicit huge pages, falls back to transparent ones
+  gbVmFlag_TransparentHugePages = GB_BIT(1), // NOTE: Aligned to GB_VM_HUGE_PAGE_SIZE and hinted to the kernel
+  gbVmFlag_Populate             = GB_BIT(2), // NOTE: Every page is faulted in up front
+};
+
+// NOTE: Placement options are best effort, the size can be rounded up so free the returned range.
+// `numa_node` binds the pages to a node (Linux mbind, Windows VirtualAllocExNuma) or GB_VM_NUMA_ANY.
+GB_DEF gb_virtual_memory_t gb_vm_alloc_ex(void *addr, ssize_t size, uint32_t flags, int32_t numa_node);
+
 enum gb_allocation_type {
   gbAllocation_Alloc,
   gbAllocation_Free,
@@ -86,22 +118,35 @@ enum gb_allocator_flag {
 };
 
 GB_DEF void *gb_alloc_align(gb_allocator_t a, ssize_t size, ssize_t alignment);
+GB_DEF void *gb_alloc_align_flags(gb_allocator_t a, ssize_t size, ssize_t alignment, uint64_t flags);
 GB_DEF void *gb_alloc(gb_allocator_t a, ssize_t size);
+GB_DEF void *gb_alloc_uninit(gb_allocator_t a, ssize_t size); // NOTE: Contents are undefined, for buffers written right away
 GB_DEF void gb_free(gb_allocator_t a, void *ptr);
 GB_DEF void gb_free_all(gb_allocator_t a);
 GB_DEF void *gb_resize(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size);
 GB_DEF void *gb_resize_align(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment);
+GB_DEF void *gb_resize_align_flags(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags);
 GB_DEF void *gb_alloc_copy(gb_allocator_t a, void const *src, ssize_t size);
 GB_DEF void *gb_alloc_copy_align(gb_allocator_t a, void const *src, ssize_t size, ssize_t alignment);
 GB_DEF char *gb_alloc_str(gb_allocator_t a, char const *str);
 GB_DEF char *gb_alloc_str_len(gb_allocator_t a, char const *str, ssize_t len);
 GB_DEF void *gb_default_resize_align(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment);
+GB_DEF void *gb_default_resize_align_flags(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags);
 
-// TODO(bill): Probably use a custom heap allocator system that doesn't depend on malloc/free
-// Base it off TCMalloc or something else? Or something entirely custom?
+// NOTE: Same as gb_alloc_align_flags and gb_resize_align_flags, with the call site made visible to trackers
+// (see gb/track.h). Containers pass the __FILE__/__LINE__ of the macro their user called.
+GB_DEF void *gb_alloc_at(gb_allocator_t a, ssize_t size, ssize_t alignment, uint64_t flags, char const *file, int32_t line);
+GB_DEF void *gb_resize_at(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags,
+                          char const *file, int32_t line);
+
+// NOTE: Thread caching general purpose heap, see gb/heap.h
 GB_DEF gb_allocator_t gb_heap_allocator(void);
 GB_DEF GB_ALLOCATOR_PROC(gb_heap_allocator_proc);
 
+// NOTE: Plain libc malloc/free
+GB_DEF gb_allocator_t gb_malloc_allocator(void);
+GB_DEF GB_ALLOCATOR_PROC(gb_malloc_allocator_proc);
+
 #ifndef gb_alloc_item
 # define gb_alloc_item(allocator_, Type)         (Type *)gb_alloc(allocator_, gb_size_of(Type))
 # define gb_alloc_array(allocator_, Type, count) (Type *)gb_alloc(allocator_, gb_size_of(Type) * (count))
@@ -112,22 +157,52 @@ GB_DEF GB_ALLOCATOR_PROC(gb_heap_allocator_proc);
 # define gb_mfree(ptr) gb_free(gb_heap_allocator(), ptr)
 #endif
 
+// NOTE: Granularity at which a virtual arena commits and decommits its pages
+#ifndef GB_ARENA_COMMIT_SIZE
+#define GB_ARENA_COMMIT_SIZE gb_kilobytes(64)
+#endif
+
+// NOTE: Bytes a thread reserves at once from a concurrent arena to serve its small allocations
+#ifndef GB_ARENA_CHUNK_SIZE
+#define GB_ARENA_CHUNK_SIZE gb_kilobytes(16)
+#endif
+
 struct gb_arena {
   gb_allocator_t backing;
   void *physical_start;
   ssize_t total_size;
   ssize_t total_allocated;
   ssize_t temp_count;
+  ssize_t total_committed;
+  ssize_t total_dirty; // NOTE: Memory past this offset is known to be zero
+  byte32_t is_virtual;
+  gb_virtual_memory_t vm; // NOTE: Mapping owned by the arena, see gb_arena_init_from_vm
+
+  // NOTE: Concurrent mode, see gb_arena_set_concurrent
+  byte32_t is_concurrent;
+  gbAtomic64 offset;      // NOTE: The bump offset, total_allocated only catches up on phase boundaries
+  int64_t generation;     // NOTE: Renewed on every rewind so threads drop the chunks they hold
+  gbAtomic32 commit_lock;
 };
 
 GB_DEF void gb_arena_init_from_memory(gb_arena_t *arena, void *start, ssize_t size);
 GB_DEF void gb_arena_init_from_allocator(gb_arena_t *arena, gb_allocator_t backing, ssize_t size);
 GB_DEF void gb_arena_init_sub(gb_arena_t *arena, gb_arena_t *parent_arena, ssize_t size);
+GB_DEF void gb_arena_init_from_vm(gb_arena_t *arena, ssize_t size, uint32_t vm_flags, int32_t numa_node);
+// NOTE: Reserves `reserve_size` bytes of address space but only commits pages as they get allocated,
+// gb_free_all and gb_temp_arena_memory_end decommit what is no longer used
+GB_DEF void gb_arena_init_virtual(gb_arena_t *arena, ssize_t reserve_size);
 GB_DEF void gb_arena_free(gb_arena_t *arena);
 GB_DEF ssize_t gb_arena_alignment_of(gb_arena_t *arena, ssize_t alignment);
 GB_DEF ssize_t gb_arena_size_remaining(gb_arena_t *arena, ssize_t alignment);
 GB_DEF void gb_arena_check(gb_arena_t *arena);
 
+// NOTE: Lets several threads allocate from the arena at once. Allocations are a single atomic add on the
+// offset, small ones are carved out of a chunk the thread reserved beforehand (GB_ARENA_CHUNK_SIZE).
+// Switch the mode, gb_temp_arena_memory_begin/end and free_all only between parallel phases, when no thread
+// is allocating. Resizes always move, and a thread holding a chunk of one arena drops it to use another.
+GB_DEF void gb_arena_set_concurrent(gb_arena_t *arena, byte32_t concurrent);
+
 // Allocation Types: alloc, free_all, resize
 GB_DEF gb_allocator_t gb_arena_allocator(gb_arena_t *arena);
 GB_DEF GB_ALLOCATOR_PROC(gb_arena_allocator_proc);
@@ -140,6 +215,45 @@ struct gb_temp_arena_memory {
 GB_DEF gb_temp_arena_memory_t gb_temp_arena_memory_begin(gb_arena_t *arena);
 GB_DEF void gb_temp_arena_memory_end(gb_temp_arena_memory_t tmp_mem);
 
+//
+// NUMA Arena
+//
+// One concurrent arena per NUMA node found by gb_affinity_init, each mapped with gb_vm_alloc_ex and bound to
+// its node. An allocation goes to the arena of the node the calling thread runs on, so memory-bound
+// workers pinned to a node only touch local DRAM. Pages are faulted in on first use, a node that is never
+// allocated from costs address space only. Same phase rules as gb_arena_set_concurrent.
+//
+
+// NOTE: Allocations between two lookups of the current node, threads migrating between nodes follow late
+#ifndef GB_NUMA_NODE_REFRESH
+#define GB_NUMA_NODE_REFRESH 1024
+#endif
+
+struct gb_numa_arena {
+  ssize_t node_count;
+  gb_arena_t arenas[GB_AFFINITY_MAX_NODES];
+};
+
+GB_DEF void gb_numa_arena_init(gb_numa_arena_t *na, gb_affinity_t *affinity, ssize_t size_per_node, uint32_t vm_flags);
+GB_DEF void gb_numa_arena_free(gb_numa_arena_t *na);
+GB_DEF gb_arena_t *gb_numa_arena_local(gb_numa_arena_t *na);
+
+// Allocation Types: alloc, free_all, resize
+GB_DEF gb_allocator_t gb_numa_arena_allocator(gb_numa_arena_t *na);
+GB_DEF GB_ALLOCATOR_PROC(gb_numa_arena_allocator_proc);
+
+//
+// Pool Allocator
+//
+// Fixed size blocks threaded on an intrusive free list. The thread of the first allocation owns the pool
+// and is the only one allowed to allocate from it, any thread may free. Frees from other threads are
+// pushed on an MPSC remote-free queue with one CAS and the owner takes the whole queue back at once when
+// its free list runs empty, so its own alloc and free never touch an atomic.
+//
+// NOTE: total_size still counts remote frees until they are drained. Use gb_concurrent_pool_t when many
+// threads allocate.
+//
+
 struct gb_pool {
   gb_allocator_t backing;
   void *physical_start;
@@ -147,16 +261,136 @@ struct gb_pool {
   ssize_t block_size;
   ssize_t block_align;
   ssize_t total_size;
+  gb_virtual_memory_t vm; // NOTE: Mapping owned by the pool, see gb_pool_init_from_vm
+  void *owner;
+  gbAtomicPtr remote_free;
 };
 
 GB_DEF void gb_pool_init(gb_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size);
 GB_DEF void gb_pool_init_align(gb_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size, ssize_t block_align);
+GB_DEF void gb_pool_init_from_memory(gb_pool_t *pool, void *start, ssize_t size, ssize_t block_size, ssize_t block_align);
+GB_DEF void gb_pool_init_from_vm(gb_pool_t *pool, ssize_t num_blocks, ssize_t block_size, ssize_t block_align, uint32_t vm_flags, int32_t numa_node);
 GB_DEF void gb_pool_free(gb_pool_t *pool);
 
 // Allocation Types: alloc, free
 GB_DEF gb_allocator_t gb_pool_allocator(gb_pool_t *pool);
 GB_DEF GB_ALLOCATOR_PROC(gb_pool_allocator_proc);
 
+//
+// Concurrent Pool
+//
+// Same contract as gb_pool_t but safe to share between threads without a lock. The shared free list is
+// a lock-free stack whose head packs the index of the top block with a generation counter (ABA guard).
+// Every thread (see gb_thread_slot) also owns a magazine of blocks so most calls never touch the stack;
+// half a magazine is moved at once when it runs empty or full.
+//
+// NOTE: Up to GB_POOL_MAGAZINE_SIZE blocks per thread can sit in magazines, size the pool accordingly
+// NOTE: free_all also empties the magazines of other threads, it must only run between phases, while no
+// other thread allocates from or frees to the pool
+//
+
+#ifndef GB_POOL_MAGAZINE_SIZE
+#define GB_POOL_MAGAZINE_SIZE 32
+#endif
+
+#if defined(GB_ARCH_64_BIT)
+#define GB_POOL_TAG_SHIFT 32
+#else
+#define GB_POOL_TAG_SHIFT 20
+#endif
+
+struct gb_pool_magazine {
+  ssize_t count;
+  void *blocks[GB_POOL_MAGAZINE_SIZE];
+  uint8_t padding[GB_CACHE_LINE_SIZE - gb_size_of(ssize_t)];
+};
+
+struct gb_concurrent_pool {
+  gb_allocator_t backing;
+  void *physical_start;
+  ssize_t block_size;
+  ssize_t block_align;
+  ssize_t actual_block_size;
+  ssize_t num_blocks;
+  gbAtomicPtr free_list; // NOTE: (generation << GB_POOL_TAG_SHIFT) | (block index + 1)
+  gb_pool_magazine_t *magazines;
+};
+
+GB_DEF void gb_concurrent_pool_init(gb_concurrent_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size);
+GB_DEF void gb_concurrent_pool_init_align(gb_concurrent_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size, ssize_t block_align);
+GB_DEF void gb_concurrent_pool_free(gb_concurrent_pool_t *pool);
+
+// Allocation Types: alloc, free, free_all
+GB_DEF gb_allocator_t gb_concurrent_pool_allocator(gb_concurrent_pool_t *pool);
+GB_DEF GB_ALLOCATOR_PROC(gb_concurrent_pool_allocator_proc);
+
+//
+// Slab Allocator
+//
+// Mixed size small objects served from a table of size classes (16 B steps up to 128 B, then 8 classes per
+// power of two up to GB_SLAB_MAX_SIZE, so at most 12.5% waste). Each class owns pages of GB_SLAB_PAGE_SIZE
+// bytes carved by a gb_pool_t. Pages are cut out of chunks of GB_SLAB_CHUNK_PAGES pages taken from the
+// backing allocator on demand, empty pages are shared by all classes and a chunk is given back once all
+// of its pages are empty. Bigger requests are forwarded to the backing allocator at their own alignment
+// and remembered in an address set, which free checks before masking while any is live.
+//
+// NOTE: Pages are aligned to their size so a block finds its page by masking its address, the backing
+// allocator must honour that alignment once per chunk. Only the thread of the first allocation may
+// allocate, frees from other threads go through a remote-free queue drained on the next page miss, like
+// gb_pool_t.
+//
+
+#ifndef GB_SLAB_PAGE_SIZE
+#define GB_SLAB_PAGE_SIZE gb_kilobytes(256)
+#endif
+
+#ifndef GB_SLAB_CHUNK_PAGES
+#define GB_SLAB_CHUNK_PAGES 8
+#endif
+
+#define GB_SLAB_MAX_SIZE gb_kilobytes(32)
+#define GB_SLAB_CLASS_COUNT 72
+
+struct gb_slab_page {
+  gb_pool_t pool;
+  gb_slab_page_t *next, *prev;
+  gb_slab_page_t *chunk; // NOTE: First page of the chunk it was cut from
+  ssize_t size_class;
+  ssize_t size;
+  ssize_t used, capacity;
+  ssize_t chunk_used;          // NOTE: Only on the first page of a chunk, pages of the chunk in use
+  gb_slab_page_t *chunk_next;  // NOTE: Only on the first page of a chunk
+};
+
+struct gb_slab_large {
+  void *ptr; // NOTE: NULL for an empty slot
+  ssize_t size;
+};
+
+struct gb_slab {
+  gb_allocator_t backing;
+  gb_slab_page_t *partial[GB_SLAB_CLASS_COUNT];
+  gb_slab_page_t *full;
+  gb_slab_large_t *large; // NOTE: Open addressing on the address of the large blocks
+  ssize_t large_count;
+  ssize_t large_capacity;
+  gb_slab_page_t *empty;
+  gb_slab_page_t *chunks;
+  ssize_t total_size;
+  ssize_t page_count;
+  void *owner;
+  gbAtomicPtr remote_free;
+};
+
+GB_DEF void gb_slab_init(gb_slab_t *slab, gb_allocator_t backing);
+GB_DEF void gb_slab_free(gb_slab_t *slab);
+GB_DEF ssize_t gb_slab_size_class(ssize_t size);
+GB_DEF ssize_t gb_slab_class_size(ssize_t size_class);
+
+// Allocation Types: alloc, free, free_all, resize
+GB_DEF gb_allocator_t gb_slab_allocator(gb_slab_t *slab);
+GB_DEF GB_ALLOCATOR_PROC(gb_slab_allocator_proc);
+
 // NOTE(bill): Used for allocators to keep track of sizes
 struct gb_allocation_header {
   ssize_t size;
@@ -174,20 +408,28 @@ GB_DEF void gb_allocation_header_fill(gb_allocation_header_t *header, void *data
 # error
 #endif
 
-// IMPORTANT TODO(bill): Thoroughly test the free list allocator!
-// NOTE(bill): This is a very shitty free list as it just picks the first free block not the best size
-// as I am just being lazy. Also, I will probably remove it later; it's only here because why not?!
 //
-// NOTE(bill): I may also complete remove this if I completely implement a fixed heap allocator
+// Free List Allocator
+//
+// Segregated fit over a fixed block of memory. Free blocks sit in size bins (16 B steps below 256 B, then
+// 4 bins per power of two) and the best fit of the first bin able to serve a request is taken. Every
+// block starts with a size word whose low bits flag whether it and the previous block are in use, free
+// blocks also end with their size so both neighbours are coalesced in O(1) on free. Resize grows in place
+// when the next block is free.
+//
+
+#define GB_FREE_LIST_BIN_COUNT 64
+
 struct gb_free_list_block {
-  gb_free_list_block_t *next;
-  ssize_t size;
+  ssize_t size; // NOTE: Low bits are the used flags of this block and the previous one
+  gb_free_list_block_t *next, *prev;
 };
 
 struct gb_free_list {
   void *physical_start;
   ssize_t total_size;
-  gb_free_list_block_t *curr_block;
+  gb_free_list_block_t *bins[GB_FREE_LIST_BIN_COUNT];
+  uint64_t bin_mask;
   ssize_t total_allocated;
   ssize_t allocation_count;
 };
@@ -199,11 +441,26 @@ GB_DEF void gb_free_list_init_from_allocator(gb_free_list_t *fl, gb_allocator_t
 GB_DEF gb_allocator_t gb_free_list_allocator(gb_free_list_t *fl);
 GB_DEF GB_ALLOCATOR_PROC(gb_free_list_allocator_proc);
 
+//
+// Scratch Allocator
+//
+// Ring buffer over a fixed block of memory, blocks are freed in any order but only reclaimed once every
+// older block is free. A frame records the alloc point and its end releases everything allocated inside
+// it in O(1), frames nest.
+//
+
 struct gb_scratch_memory {
   void *physical_start;
   ssize_t total_size;
   void *alloc_point;
   void *free_point;
+  ssize_t frame_count;
+  void *frame_point; // NOTE: Alloc point of the outermost open frame
+};
+
+struct gb_scratch_frame {
+  gb_scratch_memory_t *scratch;
+  void *alloc_point;
 };
 
 GB_DEF void gb_scratch_memory_init(gb_scratch_memory_t *s, void *start, ssize_t size);
@@ -213,8 +470,123 @@ GB_DEF byte32_t gb_scratch_memory_is_in_use(gb_scratch_memory_t *s, void *ptr);
 GB_DEF gb_allocator_t gb_scratch_allocator(gb_scratch_memory_t *s);
 GB_DEF GB_ALLOCATOR_PROC(gb_scratch_allocator_proc);
 
-// TODO(bill): Stack allocator
-// TODO(bill): Fixed heap allocator
-// TODO(bill): General heap allocator. Maybe a TCMalloc like clone?
+GB_DEF gb_scratch_frame_t gb_scratch_frame_begin(gb_scratch_memory_t *s);
+GB_DEF void gb_scratch_frame_end(gb_scratch_frame_t frame);
+
+//
+// Thread Scratch
+//
+// Every thread lazily maps its own scratch ring of GB_THREAD_SCRATCH_SIZE bytes, released on thread exit.
+// Its allocator never fails while the ring is large enough: when full, the oldest blocks allocated
+// outside any open frame are dropped, free is a no-op. Memory obtained outside a frame is therefore only
+// valid until the ring wraps over it, wrap temporaries in a frame to bound their lifetime instead.
+// This is where the library takes its temporary buffers from (printf formatting, UTF conversions, paths).
+// NOTE: The ring is not released on thread exit on Windows yet (no exit callback is registered), every
+// thread that touched its scratch leaks GB_THREAD_SCRATCH_SIZE bytes of address space and committed pages.
+// Prefer long lived worker threads there, or a smaller GB_THREAD_SCRATCH_SIZE.
+//
+
+#ifndef GB_THREAD_SCRATCH_SIZE
+#define GB_THREAD_SCRATCH_SIZE gb_kilobytes(256)
+#endif
+
+GB_DEF gb_scratch_memory_t *gb_thread_scratch(void);
+GB_DEF gb_scratch_frame_t gb_thread_scratch_begin(void);
+
+// Allocation Types: alloc, free_all, resize
+GB_DEF gb_allocator_t gb_thread_scratch_allocator(void);
+GB_DEF GB_ALLOCATOR_PROC(gb_thread_scratch_allocator_proc);
+
+//
+// Fixed Heap Allocator
+//
+// Two-Level Segregated Fit over a fixed region: the first level splits free blocks by power of two and
+// the second level in 2^GB_FIXED_HEAP_SL_LOG2 linear steps, a bitmap per level finds a suitable non empty
+// list with two bit scans. Requests are rounded up to the next list so its head always fits (good fit),
+// and blocks carry boundary tags like the free list allocator. Alloc, free and resize are O(1) with a
+// bounded worst case, only the copy of a moving resize depends on the size.
+//
+
+#ifndef GB_FIXED_HEAP_SL_LOG2
+#define GB_FIXED_HEAP_SL_LOG2 5
+#endif
+
+#define GB_FIXED_HEAP_SL_COUNT (1 << GB_FIXED_HEAP_SL_LOG2)
+#if defined(GB_ARCH_64_BIT)
+#define GB_FIXED_HEAP_FL_COUNT 32
+#else
+#define GB_FIXED_HEAP_FL_COUNT 24
+#endif
+
+struct gb_fixed_heap {
+  void *physical_start;
+  ssize_t total_size;
+  gb_virtual_memory_t vm;
+
+  uint32_t fl_bitmap;
+  uint32_t sl_bitmap[GB_FIXED_HEAP_FL_COUNT];
+  gb_free_list_block_t *blocks[GB_FIXED_HEAP_FL_COUNT][GB_FIXED_HEAP_SL_COUNT];
+
+  ssize_t total_allocated;
+  ssize_t allocation_count;
+  ssize_t total_free;
+  ssize_t free_block_count;
+};
+
+struct gb_fixed_heap_stats {
+  ssize_t total_size;
+  ssize_t total_allocated;
+  ssize_t allocation_count;
+  ssize_t total_free;
+  ssize_t free_block_count;
+  ssize_t largest_free_block;
+  float32_t fragmentation; // NOTE: 1 - largest_free_block / total_free, 0 when all free space is contiguous
+};
+
+GB_DEF void gb_fixed_heap_init(gb_fixed_heap_t *heap, void *start, ssize_t size);
+GB_DEF void gb_fixed_heap_init_virtual(gb_fixed_heap_t *heap, ssize_t size);
+GB_DEF void gb_fixed_heap_free(gb_fixed_heap_t *heap);
+GB_DEF gb_fixed_heap_stats_t gb_fixed_heap_stats(gb_fixed_heap_t *heap);
+
+// Allocation Types: alloc, free, free_all, resize
+GB_DEF gb_allocator_t gb_fixed_heap_allocator(gb_fixed_heap_t *heap);
+GB_DEF GB_ALLOCATOR_PROC(gb_fixed_heap_allocator_proc);
+
+//
+// Stack Allocator
+//
+// LIFO allocations from a fixed block. Every allocation is preceded by a small header linking it to the
+// previous top so the top can be freed in O(1), and the top grows or shrinks in place. Markers free
+// everything allocated since they were pushed at once.
+//
+// NOTE: Only the top allocation can be freed, resizing any other allocation leaves the old block behind
+// until a marker below it is popped
+//
+
+struct gb_stack {
+  gb_allocator_t backing;
+  void *physical_start;
+  ssize_t total_size;
+  ssize_t total_allocated;
+  ssize_t top; // NOTE: Offset of the top allocation, -1 when empty
+  ssize_t marker_count;
+};
+
+struct gb_stack_marker {
+  gb_stack_t *stack;
+  ssize_t total_allocated;
+  ssize_t top;
+};
+
+GB_DEF void gb_stack_init_from_memory(gb_stack_t *stack, void *start, ssize_t size);
+GB_DEF void gb_stack_init_from_allocator(gb_stack_t *stack, gb_allocator_t backing, ssize_t size);
+GB_DEF void gb_stack_free(gb_stack_t *stack);
+
+GB_DEF gb_stack_marker_t gb_stack_push_marker(gb_stack_t *stack);
+GB_DEF void gb_stack_pop_marker(gb_stack_marker_t marker);
+
+// Allocation Types: alloc, free, free_all, resize
+GB_DEF gb_allocator_t gb_stack_allocator(gb_stack_t *stack);
+GB_DEF GB_ALLOCATOR_PROC(gb_stack_allocator_proc);
 
 #endif /* GB_ALLOC_H__ */
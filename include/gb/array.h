@@ -44,15 +44,20 @@
 
 // Available Procedures for gbArray(Type)
 // gb_array_init
+// gb_array_init_align
 // gb_array_free
 // gb_array_set_capacity
 // gb_array_grow
 // gb_array_append
 // gb_array_appendv
+// gb_array_insertv
+// gb_array_erase_range
+// gb_array_remove_swap
 // gb_array_pop
 // gb_array_clear
 // gb_array_resize
 // gb_array_reserve
+// gb_array_shrink_to_fit
 //
 
 #if 0 // Example
@@ -97,6 +102,7 @@ typedef struct gbArrayHeader {
   gb_allocator_t allocator;
   ssize_t count;
   ssize_t capacity;
+  ssize_t alignment;
 } gbArrayHeader;
 
 // NOTE(bill): This thing is magic!
@@ -108,38 +114,51 @@ typedef struct gbArrayHeader {
 
 GB_STATIC_ASSERT(GB_ARRAY_GROW_FORMULA(0) > 0);
 
+// NOTE: The elements are aligned to the alignment of their type (at least GB_DEFAULT_MEMORY_ALIGNMENT) or
+// the one given to gb_array_init_align, e.g. 64 for AVX-512. The header sits right before them after some
+// padding, GB_ARRAY_BLOCK is the start of the allocation.
 #define GB_ARRAY_HEADER(x)    (cast(gbArrayHeader *)(x) - 1)
+#define GB_ARRAY_HEADER_OFFSET(alignment) ((gb_size_of(gbArrayHeader) + (alignment) - 1) & ~((alignment) - 1))
+#define GB_ARRAY_BLOCK(x)     gb_pointer_sub((x), GB_ARRAY_HEADER_OFFSET(GB_ARRAY_HEADER(x)->alignment))
 #define gb_array_allocator(x) (GB_ARRAY_HEADER(x)->allocator)
 #define gb_array_count(x)     (GB_ARRAY_HEADER(x)->count)
 #define gb_array_capacity(x)  (GB_ARRAY_HEADER(x)->capacity)
 
-// TODO(bill): Have proper alignment!
-#define gb_array_init_reserve(x, allocator_, cap) do { \
+#define gb_array_init_reserve_align(x, allocator_, cap, alignment_) do { \
   void **gb__array_ = cast(void **)&(x); \
-  gbArrayHeader *gb__ah = cast(gbArrayHeader *)gb_alloc(allocator_, gb_size_of(gbArrayHeader)+gb_size_of(*(x))*(cap)); \
+  ssize_t gb__align = gb_max((alignment_), GB_DEFAULT_MEMORY_ALIGNMENT); \
+  ssize_t gb__offset = GB_ARRAY_HEADER_OFFSET(gb__align); \
+  void *gb__block = gb_alloc_at(allocator_, gb__offset+gb_size_of(*(x))*(cap), gb__align, \
+                                GB_DEFAULT_ALLOCATOR_FLAGS, __FILE__, __LINE__); \
+  gbArrayHeader *gb__ah = cast(gbArrayHeader *)gb_pointer_add(gb__block, gb__offset) - 1; \
+  GB_ASSERT(gb_is_power_of_two(gb__align)); \
   gb__ah->allocator = allocator_; \
   gb__ah->count = 0; \
   gb__ah->capacity = cap; \
+  gb__ah->alignment = gb__align; \
   *gb__array_ = cast(void *)(gb__ah+1); \
 } while (0)
 
+#define gb_array_init_reserve(x, allocator_, cap) gb_array_init_reserve_align(x, allocator_, cap, gb_align_of_expr(*(x)))
+
 // NOTE(bill): Give it an initial default capacity
 #define gb_array_init(x, allocator) gb_array_init_reserve(x, allocator, GB_ARRAY_GROW_FORMULA(0))
+#define gb_array_init_align(x, allocator, alignment) gb_array_init_reserve_align(x, allocator, GB_ARRAY_GROW_FORMULA(0), alignment)
 
 #define gb_array_free(x) do { \
   gbArrayHeader *gb__ah = GB_ARRAY_HEADER(x); \
-  gb_free(gb__ah->allocator, gb__ah); \
+  gb_free(gb__ah->allocator, GB_ARRAY_BLOCK(x)); \
 } while (0)
 
 #define gb_array_set_capacity(x, capacity) do { \
   if (x) { \
     void **gb__array_ = cast(void **)&(x); \
-    *gb__array_ = gb__array_set_capacity((x), (capacity), gb_size_of(*(x))); \
+    *gb__array_ = gb__array_set_capacity((x), (capacity), gb_size_of(*(x)), __FILE__, __LINE__); \
   } \
 } while (0)
 
 // NOTE(bill): Do not use the thing below directly, use the macro
-GB_DEF void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t element_size);
+GB_DEF void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t element_size, char const *file, int32_t line);
 
 
 // TODO(bill): Decide on a decent growing formula for gbArray
@@ -165,6 +184,33 @@ GB_DEF void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t eleme
   gb__ah->count += (item_count); \
 } while (0)
 
+// NOTE: Inserts `item_count` items before `index`, shifting the tail once
+#define gb_array_insertv(x, index, items, item_count) do { \
+  ssize_t gb__index = (index), gb__n = (item_count); \
+  GB_ASSERT(gb_size_of((items)[0]) == gb_size_of((x)[0])); \
+  GB_ASSERT(0 <= gb__index && gb__index <= gb_array_count(x)); \
+  if (gb_array_capacity(x) < gb_array_count(x)+gb__n) \
+    gb_array_grow(x, gb_array_count(x)+gb__n); \
+  gb_memmove(&(x)[gb__index+gb__n], &(x)[gb__index], gb_size_of((x)[0])*(gb_array_count(x)-gb__index)); \
+  gb_memcopy(&(x)[gb__index], (items), gb_size_of((x)[0])*gb__n); \
+  gb_array_count(x) += gb__n; \
+} while (0)
+
+// NOTE: Removes `count` items from `index` on keeping the order, a single move of the tail
+#define gb_array_erase_range(x, index, count) do { \
+  ssize_t gb__index = (index), gb__n = (count); \
+  GB_ASSERT(0 <= gb__index && 0 <= gb__n && gb__index+gb__n <= gb_array_count(x)); \
+  gb_memmove(&(x)[gb__index], &(x)[gb__index+gb__n], gb_size_of((x)[0])*(gb_array_count(x)-gb__index-gb__n)); \
+  gb_array_count(x) -= gb__n; \
+} while (0)
+
+// NOTE: O(1) removal, the last item takes the place of the removed one
+#define gb_array_remove_swap(x, index) do { \
+  ssize_t gb__index = (index); \
+  GB_ASSERT(0 <= gb__index && gb__index < gb_array_count(x)); \
+  (x)[gb__index] = (x)[--gb_array_count(x)]; \
+} while (0)
+
 #define gb_array_pop(x)   do { GB_ASSERT(GB_ARRAY_HEADER(x)->count > 0); GB_ARRAY_HEADER(x)->count--; } while (0)
 #define gb_array_clear(x) do { GB_ARRAY_HEADER(x)->count = 0; } while (0)
 
@@ -179,4 +225,106 @@ GB_DEF void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t eleme
     gb_array_set_capacity(x, new_capacity); \
 } while (0)
 
+// NOTE: Shrinks through resize, the heap moves the elements to a smaller block and the stack shrinks its top in
+// place, allocators built on gb_default_resize_align (arenas, scratch) keep the whole block
+#define gb_array_shrink_to_fit(x) gb_array_set_capacity(x, gb_array_count(x))
+
+
+//
+// Small Array (POD Types)
+//
+// gbSmallArray(Type, N) keeps its first N elements inline, on the stack or inside the parent struct, and
+// only moves them to the allocator once it outgrows them (back again if shrunk with set_capacity). Unlike
+// gbArray it is a struct, the elements are `x.data[i]`.
+//
+// NOTE: `data` points into the struct while inline, never copy a small array by value
+//
+
+// Available Procedures for gbSmallArray(Type, N)
+// gb_small_array_init
+// gb_small_array_free
+// gb_small_array_set_capacity
+// gb_small_array_grow
+// gb_small_array_append
+// gb_small_array_appendv
+// gb_small_array_pop
+// gb_small_array_clear
+// gb_small_array_resize
+// gb_small_array_reserve
+//
+
+#define gbSmallArray(Type, N) struct { \
+  gb_allocator_t allocator; \
+  Type *data; \
+  ssize_t count; \
+  ssize_t capacity; \
+  Type inline_data[N]; \
+}
+
+#define gb_small_array_count(x)     ((x).count)
+#define gb_small_array_capacity(x)  ((x).capacity)
+#define gb_small_array_is_inline(x) ((x).data == (x).inline_data)
+
+#define gb_small_array_init(x, allocator_) do { \
+  (x).allocator = (allocator_); \
+  (x).data = (x).inline_data; \
+  (x).count = 0; \
+  (x).capacity = gb_count_of((x).inline_data); \
+} while (0)
+
+#define gb_small_array_free(x) do { \
+  if (!gb_small_array_is_inline(x)) \
+    gb_free((x).allocator, (x).data); \
+  (x).data = (x).inline_data; \
+  (x).count = 0; \
+  (x).capacity = gb_count_of((x).inline_data); \
+} while (0)
+
+#define gb_small_array_set_capacity(x, capacity_) do { \
+  void **gb__data_ = cast(void **)&(x).data; \
+  *gb__data_ = gb__small_array_set_capacity((x).allocator, (x).data, (x).inline_data, gb_count_of((x).inline_data), \
+                                            &(x).count, &(x).capacity, (capacity_), \
+                                            gb_size_of((x).data[0]), gb_align_of_expr((x).data[0]), __FILE__, __LINE__); \
+} while (0)
+
+// NOTE(bill): Do not use the thing below directly, use the macro
+GB_DEF void *gb__small_array_set_capacity(gb_allocator_t a, void *data, void *inline_data, ssize_t inline_capacity,
+                                          ssize_t *count, ssize_t *capacity, ssize_t new_capacity,
+                                          ssize_t element_size, ssize_t alignment, char const *file, int32_t line);
+
+#define gb_small_array_grow(x, min_capacity) do { \
+  ssize_t gb__new_capacity = GB_ARRAY_GROW_FORMULA((x).capacity); \
+  if (gb__new_capacity < (min_capacity)) \
+    gb__new_capacity = (min_capacity); \
+  gb_small_array_set_capacity(x, gb__new_capacity); \
+} while (0)
+
+#define gb_small_array_append(x, item) do { \
+  if ((x).capacity < (x).count+1) \
+    gb_small_array_grow(x, 0); \
+  (x).data[(x).count++] = (item); \
+} while (0)
+
+#define gb_small_array_appendv(x, items, item_count) do { \
+  GB_ASSERT(gb_size_of((items)[0]) == gb_size_of((x).data[0])); \
+  if ((x).capacity < (x).count+(item_count)) \
+    gb_small_array_grow(x, (x).count+(item_count)); \
+  gb_memcopy(&(x).data[(x).count], (items), gb_size_of((x).data[0])*(item_count)); \
+  (x).count += (item_count); \
+} while (0)
+
+#define gb_small_array_pop(x)   do { GB_ASSERT((x).count > 0); (x).count--; } while (0)
+#define gb_small_array_clear(x) do { (x).count = 0; } while (0)
+
+#define gb_small_array_resize(x, new_count) do { \
+  if ((x).capacity < (new_count)) \
+    gb_small_array_grow(x, (new_count)); \
+  (x).count = (new_count); \
+} while (0)
+
+#define gb_small_array_reserve(x, new_capacity) do { \
+  if ((x).capacity < (new_capacity)) \
+    gb_small_array_set_capacity(x, new_capacity); \
+} while (0)
+
 #endif /* GB_ARRAY_H__ */
@@ -41,23 +41,35 @@
 typedef struct gbBufferHeader {
   ssize_t count;
   ssize_t capacity;
+  ssize_t alignment;
 } gbBufferHeader;
 
 #define gbBuffer(Type) Type *
 
+// NOTE: The elements are aligned to the alignment of their type (at least GB_DEFAULT_MEMORY_ALIGNMENT) or
+// the one given to gb_buffer_init_align, the header sits right before them after some padding
 #define GB_BUFFER_HEADER(x)   (cast(gbBufferHeader *)(x) - 1)
+#define GB_BUFFER_HEADER_OFFSET(alignment) ((gb_size_of(gbBufferHeader) + (alignment) - 1) & ~((alignment) - 1))
+#define GB_BUFFER_BLOCK(x)    gb_pointer_sub((x), GB_BUFFER_HEADER_OFFSET(GB_BUFFER_HEADER(x)->alignment))
 #define gb_buffer_count(x)    (GB_BUFFER_HEADER(x)->count)
 #define gb_buffer_capacity(x) (GB_BUFFER_HEADER(x)->capacity)
 
-#define gb_buffer_init(x, allocator, cap) do { \
+#define gb_buffer_init_align(x, allocator, cap, alignment_) do { \
   void **nx = cast(void **)&(x); \
-  gbBufferHeader *gb__bh = cast(gbBufferHeader *)gb_alloc((allocator), (cap)*gb_size_of(*(x))); \
+  ssize_t gb__align = gb_max((alignment_), GB_DEFAULT_MEMORY_ALIGNMENT); \
+  ssize_t gb__offset = GB_BUFFER_HEADER_OFFSET(gb__align); \
+  void *gb__block = gb_alloc_align((allocator), gb__offset+(cap)*gb_size_of(*(x)), gb__align); \
+  gbBufferHeader *gb__bh = cast(gbBufferHeader *)gb_pointer_add(gb__block, gb__offset) - 1; \
+  GB_ASSERT(gb_is_power_of_two(gb__align)); \
   gb__bh->count = 0; \
   gb__bh->capacity = cap; \
+  gb__bh->alignment = gb__align; \
   *nx = cast(void *)(gb__bh+1); \
 } while (0)
 
-#define gb_buffer_free(x, allocator) (gb_free(allocator, GB_BUFFER_HEADER(x)))
+#define gb_buffer_init(x, allocator, cap) gb_buffer_init_align(x, allocator, cap, gb_align_of_expr(*(x)))
+
+#define gb_buffer_free(x, allocator) (gb_free(allocator, GB_BUFFER_BLOCK(x)))
 
 #define gb_buffer_append(x, item) do { (x)[gb_buffer_count(x)++] = (item); } while (0)
 
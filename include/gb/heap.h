@@ -0,0 +1,87 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#ifndef  GB_HEAP_H__
+# define GB_HEAP_H__
+
+#include "gb/alloc.h"
+
+//
+// Thread Caching Heap
+//
+// This is the allocator behind gb_heap_allocator(). It is loosely based on TCMalloc:
+//
+//     - Small requests (<= GB_HEAP_MAX_SMALL_SIZE) are rounded up to one of GB_HEAP_CLASS_COUNT size classes
+//       and served from a per-thread cache of free blocks, no locks involved.
+//     - When a thread cache runs dry (or grows too long) it exchanges a batch of blocks with the central
+//       free list of that class, which is guarded by a spin lock. Blocks freed from another thread simply
+//       end up in the freeing thread's cache and travel back to the central lists in batches.
+//     - Central free lists carve their blocks out of spans (GB_HEAP_SPAN_SIZE) which come from segments
+//       (GB_HEAP_SEGMENT_SIZE) reserved with gb_vm_alloc and aligned to their size, so the owning span of
+//       any block is found by masking its address.
+//     - Large requests get a segment of their own.
+//
+// NOTE: The thread cache is flushed back on thread exit (POSIX only) or with gb_heap_thread_flush()
+// NOTE: Windows has no exit hook registered, the blocks cached by a thread that exits without calling
+// gb_heap_thread_flush() are never reused (up to two batches per size class). Call it at the end of short
+// lived threads there.
+//
+
+#ifndef GB_HEAP_SEGMENT_SIZE
+#define GB_HEAP_SEGMENT_SIZE gb_megabytes(4)
+#endif
+
+#ifndef GB_HEAP_SPAN_SIZE
+#define GB_HEAP_SPAN_SIZE gb_kilobytes(64)
+#endif
+
+#ifndef GB_HEAP_MAX_SMALL_SIZE
+#define GB_HEAP_MAX_SMALL_SIZE gb_kilobytes(32)
+#endif
+
+// NOTE: Number of completely free segments kept around instead of being given back to the OS
+#ifndef GB_HEAP_RETAINED_SEGMENTS
+#define GB_HEAP_RETAINED_SEGMENTS 2
+#endif
+
+#define GB_HEAP_SPANS_PER_SEGMENT (GB_HEAP_SEGMENT_SIZE / GB_HEAP_SPAN_SIZE)
+
+// NOTE: 16 byte steps up to 128 bytes then 4 classes per power of two up to 32 KiB
+#define GB_HEAP_CLASS_COUNT 40
+
+GB_DEF void *  gb_heap_alloc(ssize_t size, ssize_t alignment);
+GB_DEF void    gb_heap_free(void *ptr);
+GB_DEF void *  gb_heap_resize(void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment);
+GB_DEF ssize_t gb_heap_usable_size(void const *ptr);
+
+// NOTE: Returns every block cached by the calling thread to the central free lists
+GB_DEF void    gb_heap_thread_flush(void);
+
+GB_DEF ssize_t gb_heap_size_class(ssize_t size);
+GB_DEF ssize_t gb_heap_class_size(ssize_t size_class);
+
+#endif /* GB_HEAP_H__ */
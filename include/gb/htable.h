@@ -44,9 +44,31 @@
 //     FUNC    - the name will prefix function names
 //     VALUE   - the type of the value to be stored
 //
+// Entries are kept packed in `entries` (iterate over it to visit the table) and chained from the `hashes`
+// buckets. remove moves the last entry into the hole, so it invalidates the index of that entry and pointers
+// returned by get.
+//
+// A rehash relinks the existing entries into a new bucket array without copying them. By default it runs
+// to completion as soon as the table is 3/4 full; after set_rehash_step(h, n) the old buckets are kept
+// alive instead and every get, set and remove migrates n of them, lookups checking the old bucket of a key
+// until it is migrated. A grow that trips before the previous migration is over finishes it first, so n
+// should be at least 4 for a migration to complete within the inserts that fill the new buckets.
+// NOTE: The new bucket array is still allocated and cleared in one go and `entries` still grows geometrically,
+// reserve it up front when insert latency matters.
+//
+// get_many and set_many work on windows of GB_TABLE_PREFETCH_WINDOW keys: every bucket of the window is
+// located and prefetched, then the first entry of every chain, and only then are the keys resolved, so the
+// cache misses of a window overlap instead of being paid one key after the other. This pays off once the
+// table no longer fits in cache. get_many fills values with the same pointers get returns (NULL when
+// missing) and returns how many were found, set_many is set for each key in order.
+//
 // NOTE(bill): I really wish C had decent metaprogramming capabilities (and no I don't mean C++'s templates either)
 //
 
+#ifndef GB_TABLE_PREFETCH_WINDOW
+#define GB_TABLE_PREFETCH_WINDOW 16
+#endif
+
 typedef struct gbHashTableFindResult {
   ssize_t hash_index;
   ssize_t entry_prev;
@@ -67,25 +89,36 @@ typedef struct GB_JOIN2(NAME,Entry) { \
 typedef struct NAME { \
   gbArray(ssize_t) hashes; \
   gbArray(GB_JOIN2(NAME,Entry)) entries; \
+  gbArray(ssize_t) old_hashes; /* NOTE: Buckets still being migrated, NULL when no rehash is pending */ \
+  ssize_t migrated; \
+  ssize_t rehash_step; \
 } NAME; \
 \
-PREFIX void                  GB_JOIN2(FUNC,init)       (NAME *h, gb_allocator_t a); \
-PREFIX void                  GB_JOIN2(FUNC,destroy)    (NAME *h); \
-PREFIX VALUE *               GB_JOIN2(FUNC,get)        (NAME *h, uint64_t key); \
-PREFIX void                  GB_JOIN2(FUNC,set)        (NAME *h, uint64_t key, VALUE value); \
-PREFIX void                  GB_JOIN2(FUNC,grow)       (NAME *h); \
-PREFIX void                  GB_JOIN2(FUNC,rehash)     (NAME *h, ssize_t new_count); \
+PREFIX void                  GB_JOIN2(FUNC,init)            (NAME *h, gb_allocator_t a); \
+PREFIX void                  GB_JOIN2(FUNC,destroy)         (NAME *h); \
+PREFIX VALUE *               GB_JOIN2(FUNC,get)             (NAME *h, uint64_t key); \
+PREFIX void                  GB_JOIN2(FUNC,set)             (NAME *h, uint64_t key, VALUE value); \
+PREFIX ssize_t               GB_JOIN2(FUNC,get_many)        (NAME *h, uint64_t const *keys, ssize_t count, VALUE **values); \
+PREFIX void                  GB_JOIN2(FUNC,set_many)        (NAME *h, uint64_t const *keys, VALUE const *values, ssize_t count); \
+PREFIX byte32_t              GB_JOIN2(FUNC,remove)          (NAME *h, uint64_t key); \
+PREFIX void                  GB_JOIN2(FUNC,grow)            (NAME *h); \
+PREFIX void                  GB_JOIN2(FUNC,rehash)          (NAME *h, ssize_t new_count); \
+PREFIX void                  GB_JOIN2(FUNC,set_rehash_step) (NAME *h, ssize_t buckets_per_call); \
 
 
 #define GB_TABLE_DEFINE(NAME, FUNC, VALUE) \
 void GB_JOIN2(FUNC,init)(NAME *h, gb_allocator_t a) { \
   gb_array_init(h->hashes,  a); \
   gb_array_init(h->entries, a); \
+  h->old_hashes  = NULL; \
+  h->migrated    = 0; \
+  h->rehash_step = 0; \
 } \
 \
 void GB_JOIN2(FUNC,destroy)(NAME *h) { \
-  if (h->entries) gb_array_free(h->entries); \
-  if (h->hashes)  gb_array_free(h->hashes); \
+  if (h->entries)    gb_array_free(h->entries); \
+  if (h->hashes)     gb_array_free(h->hashes); \
+  if (h->old_hashes) gb_array_free(h->old_hashes); \
 } \
 \
 gb_internal ssize_t GB_JOIN2(FUNC,_add_entry)(NAME *h, uint64_t key) { \
@@ -98,62 +131,113 @@ gb_internal ssize_t GB_JOIN2(FUNC,_add_entry)(NAME *h, uint64_t key) { \
   return index; \
 } \
 \
+gb_internal ssize_t *GB_JOIN2(FUNC,_bucket)(NAME *h, uint64_t key, ssize_t *hash_index) { \
+  if (h->old_hashes) { \
+    *hash_index = key % gb_array_count(h->old_hashes); \
+    if (*hash_index >= h->migrated) \
+      return h->old_hashes; \
+  } \
+  *hash_index = key % gb_array_count(h->hashes); \
+  return h->hashes; \
+} \
+\
+gb_internal gbHashTableFindResult GB_JOIN2(FUNC,_find_at)(NAME *h, uint64_t key, ssize_t const *buckets, ssize_t hash_index) { \
+  gbHashTableFindResult r = {-1, -1, -1}; \
+  r.hash_index  = hash_index; \
+  r.entry_index = buckets[hash_index]; \
+  while (r.entry_index >= 0) { \
+    if (h->entries[r.entry_index].key == key) \
+      return r; \
+    r.entry_prev = r.entry_index; \
+    r.entry_index = h->entries[r.entry_index].next; \
+  } \
+  return r; \
+} \
+\
 gb_internal gbHashTableFindResult GB_JOIN2(FUNC,_find)(NAME *h, uint64_t key) { \
   gbHashTableFindResult r = {-1, -1, -1}; \
   if (gb_array_count(h->hashes) > 0) { \
-    r.hash_index  = key % gb_array_count(h->hashes); \
-    r.entry_index = h->hashes[r.hash_index]; \
-    while (r.entry_index >= 0) { \
-      if (h->entries[r.entry_index].key == key) \
-        return r; \
-      r.entry_prev = r.entry_index; \
-      r.entry_index = h->entries[r.entry_index].next; \
-    } \
+    ssize_t hash_index; \
+    ssize_t *buckets = GB_JOIN2(FUNC,_bucket)(h, key, &hash_index); \
+    r = GB_JOIN2(FUNC,_find_at)(h, key, buckets, hash_index); \
   } \
   return r; \
 } \
 \
+gb_internal void GB_JOIN2(FUNC,_link)(NAME *h, gbHashTableFindResult fr, ssize_t index) { \
+  if (fr.entry_prev >= 0) { \
+    h->entries[fr.entry_prev].next = index; \
+  } else { \
+    ssize_t hash_index; \
+    GB_JOIN2(FUNC,_bucket)(h, h->entries[index].key, &hash_index)[hash_index] = index; \
+  } \
+} \
+\
 gb_internal byte32_t GB_JOIN2(FUNC,_full)(NAME *h) { \
   return 0.75f * gb_array_count(h->hashes) < gb_array_count(h->entries); \
 } \
 \
+gb_internal void GB_JOIN2(FUNC,_migrate)(NAME *h, ssize_t bucket_count) { \
+  ssize_t count, end; \
+  if (!h->old_hashes) \
+    return; \
+  count = gb_array_count(h->hashes); \
+  end = gb_array_count(h->old_hashes); \
+  /* NOTE: Compare against what is left, migrated + bucket_count overflows for SSIZE_MAX */ \
+  if (bucket_count < end - h->migrated) \
+    end = h->migrated + bucket_count; \
+  for (; h->migrated < end; h->migrated++) { \
+    ssize_t index = h->old_hashes[h->migrated]; \
+    while (index >= 0) { \
+      GB_JOIN2(NAME,Entry) *e = &h->entries[index]; \
+      ssize_t next = e->next, hash_index = e->key % count; \
+      e->next = h->hashes[hash_index]; \
+      h->hashes[hash_index] = index; \
+      index = next; \
+    } \
+  } \
+  if (h->migrated == gb_array_count(h->old_hashes)) { \
+    gb_array_free(h->old_hashes); \
+    h->old_hashes = NULL; \
+  } \
+} \
+\
+gb_internal void GB_JOIN2(FUNC,_rehash_begin)(NAME *h, ssize_t new_count) { \
+  gb_allocator_t a = gb_array_allocator(h->hashes); \
+  GB_JOIN2(FUNC,_migrate)(h, SSIZE_MAX); \
+  if (gb_array_count(h->hashes) > 0) { \
+    h->old_hashes = h->hashes; \
+    h->migrated = 0; \
+    gb_array_init(h->hashes, a); \
+  } \
+  gb_array_resize(h->hashes, new_count); \
+  gb_memset(h->hashes, 0xff, new_count * gb_size_of(ssize_t)); /* NOTE: Every bucket to -1 */ \
+} \
+\
+gb_internal void GB_JOIN2(FUNC,_grow_to)(NAME *h, ssize_t new_count) { \
+  GB_JOIN2(FUNC,_rehash_begin)(h, new_count); \
+  GB_JOIN2(FUNC,_migrate)(h, h->rehash_step > 0 ? h->rehash_step : SSIZE_MAX); \
+} \
+\
 void GB_JOIN2(FUNC,grow)(NAME *h) { \
-  ssize_t new_count = GB_ARRAY_GROW_FORMULA(gb_array_count(h->entries)); \
-  GB_JOIN2(FUNC,rehash)(h, new_count); \
+  GB_JOIN2(FUNC,_grow_to)(h, GB_ARRAY_GROW_FORMULA(gb_array_count(h->entries))); \
 } \
 \
 void GB_JOIN2(FUNC,rehash)(NAME *h, ssize_t new_count) { \
-  ssize_t i, j; \
-  NAME nh = {0}; \
-  GB_JOIN2(FUNC,init)(&nh, gb_array_allocator(h->hashes)); \
-  gb_array_resize(nh.hashes, new_count); \
-  gb_array_reserve(nh.entries, gb_array_count(h->entries)); \
-  for (i = 0; i < new_count; i++) \
-    nh.hashes[i] = -1; \
-  for (i = 0; i < gb_array_count(h->entries); i++) { \
-    GB_JOIN2(NAME,Entry) *e; \
-    gbHashTableFindResult fr; \
-    if (gb_array_count(nh.hashes) == 0) \
-      GB_JOIN2(FUNC,grow)(&nh); \
-    e = &nh.entries[i]; \
-    fr = GB_JOIN2(FUNC,_find)(&nh, e->key); \
-    j = GB_JOIN2(FUNC,_add_entry)(&nh, e->key); \
-    if (fr.entry_prev < 0) \
-      nh.hashes[fr.hash_index] = j; \
-    else \
-      nh.entries[fr.entry_prev].next = j; \
-    nh.entries[j].next = fr.entry_index; \
-    nh.entries[j].value = e->value; \
-    if (GB_JOIN2(FUNC,_full)(&nh)) \
-      GB_JOIN2(FUNC,grow)(&nh); \
-  } \
-  GB_JOIN2(FUNC,destroy)(h); \
-  h->hashes  = nh.hashes; \
-  h->entries = nh.entries; \
+  GB_JOIN2(FUNC,_rehash_begin)(h, new_count); \
+  GB_JOIN2(FUNC,_migrate)(h, SSIZE_MAX); \
+} \
+\
+void GB_JOIN2(FUNC,set_rehash_step)(NAME *h, ssize_t buckets_per_call) { \
+  h->rehash_step = buckets_per_call; \
+  if (buckets_per_call <= 0) \
+    GB_JOIN2(FUNC,_migrate)(h, SSIZE_MAX); \
 } \
 \
 VALUE *GB_JOIN2(FUNC,get)(NAME *h, uint64_t key) { \
-  ssize_t index = GB_JOIN2(FUNC,_find)(h, key).entry_index; \
+  ssize_t index; \
+  GB_JOIN2(FUNC,_migrate)(h, h->rehash_step); \
+  index = GB_JOIN2(FUNC,_find)(h, key).entry_index; \
   if (index >= 0) \
     return &h->entries[index].value; \
   return NULL; \
@@ -164,20 +248,450 @@ void GB_JOIN2(FUNC,set)(NAME *h, uint64_t key, VALUE value) { \
   gbHashTableFindResult fr; \
   if (gb_array_count(h->hashes) == 0) \
     GB_JOIN2(FUNC,grow)(h); \
+  GB_JOIN2(FUNC,_migrate)(h, h->rehash_step); \
   fr = GB_JOIN2(FUNC,_find)(h, key); \
   if (fr.entry_index >= 0) { \
     index = fr.entry_index; \
   } else { \
     index = GB_JOIN2(FUNC,_add_entry)(h, key); \
-    if (fr.entry_prev >= 0) { \
-      h->entries[fr.entry_prev].next = index; \
-    } else { \
-      h->hashes[fr.hash_index] = index; \
-    } \
+    GB_JOIN2(FUNC,_link)(h, fr, index); \
   } \
   h->entries[index].value = value; \
   if (GB_JOIN2(FUNC,_full)(h)) \
     GB_JOIN2(FUNC,grow)(h); \
+} \
+\
+/* NOTE: Bucket of every key in the window, then the first entry of every chain, both prefetched */ \
+gb_internal void GB_JOIN2(FUNC,_prefetch)(NAME *h, uint64_t const *keys, ssize_t count, ssize_t **buckets, ssize_t *hash_indices) { \
+  ssize_t i; \
+  for (i = 0; i < count; i++) { \
+    buckets[i] = GB_JOIN2(FUNC,_bucket)(h, keys[i], &hash_indices[i]); \
+    gb_prefetch(&buckets[i][hash_indices[i]]); \
+  } \
+  for (i = 0; i < count; i++) { \
+    ssize_t index = buckets[i][hash_indices[i]]; \
+    if (index >= 0) \
+      gb_prefetch(&h->entries[index]); \
+  } \
+} \
+\
+ssize_t GB_JOIN2(FUNC,get_many)(NAME *h, uint64_t const *keys, ssize_t count, VALUE **values) { \
+  ssize_t *buckets[GB_TABLE_PREFETCH_WINDOW]; \
+  ssize_t hash_indices[GB_TABLE_PREFETCH_WINDOW]; \
+  ssize_t base, i, found = 0; \
+  for (base = 0; base < count; base += GB_TABLE_PREFETCH_WINDOW) { \
+    ssize_t window = gb_min(count - base, GB_TABLE_PREFETCH_WINDOW); \
+    if (gb_array_count(h->hashes) == 0) { \
+      for (i = 0; i < window; i++) \
+        values[base + i] = NULL; \
+      continue; \
+    } \
+    GB_JOIN2(FUNC,_migrate)(h, h->rehash_step > SSIZE_MAX / window ? SSIZE_MAX : h->rehash_step * window); \
+    GB_JOIN2(FUNC,_prefetch)(h, keys + base, window, buckets, hash_indices); \
+    for (i = 0; i < window; i++) { \
+      ssize_t index = GB_JOIN2(FUNC,_find_at)(h, keys[base + i], buckets[i], hash_indices[i]).entry_index; \
+      values[base + i] = index >= 0 ? &h->entries[index].value : NULL; \
+      found += index >= 0; \
+    } \
+  } \
+  return found; \
+} \
+\
+void GB_JOIN2(FUNC,set_many)(NAME *h, uint64_t const *keys, VALUE const *values, ssize_t count) { \
+  ssize_t *buckets[GB_TABLE_PREFETCH_WINDOW]; \
+  ssize_t hash_indices[GB_TABLE_PREFETCH_WINDOW]; \
+  ssize_t base, i; \
+  for (base = 0; base < count; base += GB_TABLE_PREFETCH_WINDOW) { \
+    ssize_t window = gb_min(count - base, GB_TABLE_PREFETCH_WINDOW); \
+    /* NOTE: Grow up front, the buckets located for the window have to stay put while it is inserted */ \
+    if (0.75f * gb_array_count(h->hashes) < gb_array_count(h->entries) + window) \
+      GB_JOIN2(FUNC,_grow_to)(h, GB_ARRAY_GROW_FORMULA(gb_array_count(h->entries) + window)); \
+    GB_JOIN2(FUNC,_migrate)(h, h->rehash_step > SSIZE_MAX / window ? SSIZE_MAX : h->rehash_step * window); \
+    GB_JOIN2(FUNC,_prefetch)(h, keys + base, window, buckets, hash_indices); \
+    for (i = 0; i < window; i++) { \
+      gbHashTableFindResult fr = GB_JOIN2(FUNC,_find_at)(h, keys[base + i], buckets[i], hash_indices[i]); \
+      ssize_t index = fr.entry_index; \
+      if (index < 0) { \
+        index = GB_JOIN2(FUNC,_add_entry)(h, keys[base + i]); \
+        if (fr.entry_prev >= 0) \
+          h->entries[fr.entry_prev].next = index; \
+        else \
+          buckets[i][hash_indices[i]] = index; \
+      } \
+      h->entries[index].value = values[base + i]; \
+    } \
+  } \
+} \
+\
+byte32_t GB_JOIN2(FUNC,remove)(NAME *h, uint64_t key) { \
+  ssize_t last; \
+  gbHashTableFindResult fr; \
+  GB_JOIN2(FUNC,_migrate)(h, h->rehash_step); \
+  fr = GB_JOIN2(FUNC,_find)(h, key); \
+  if (fr.entry_index < 0) \
+    return false; \
+  if (fr.entry_prev >= 0) \
+    h->entries[fr.entry_prev].next = h->entries[fr.entry_index].next; \
+  else \
+    GB_JOIN2(FUNC,_bucket)(h, key, &fr.hash_index)[fr.hash_index] = h->entries[fr.entry_index].next; \
+  last = gb_array_count(h->entries) - 1; \
+  if (fr.entry_index != last) { \
+    gbHashTableFindResult moved = GB_JOIN2(FUNC,_find)(h, h->entries[last].key); \
+    h->entries[fr.entry_index] = h->entries[last]; \
+    GB_JOIN2(FUNC,_link)(h, moved, fr.entry_index); \
+  } \
+  gb_array_pop(h->entries); \
+  return true; \
+}
+
+
+//
+// Instantiated Keyed Hash Table
+//
+// GB_TABLE for keys that are not a uint64_t: strings, byte slices, POD structs. Each entry stores the full
+// 64-bit hash of its key next to it, so a lookup only calls EQ_FN on entries whose hash matches and a
+// rehash relinks the entries from their cached hash without hashing any key again.
+//
+// Keyed hash table type and function declaration, call: GB_TABLE_KEYED_DECLARE(PREFIX, NAME, FUNC, KEY, VALUE)
+// Keyed hash table function definitions, call: GB_TABLE_KEYED_DEFINE(NAME, FUNC, KEY, VALUE, HASH_FN, EQ_FN)
+//
+//     KEY     - the type of the key, passed by pointer and copied bytewise into the table
+//     HASH_FN - uint64_t HASH_FN(KEY const *key)
+//     EQ_FN   - byte32_t EQ_FN(KEY const *a, KEY const *b), nonzero when equal
+//
+// Ready made functions for gbString keys (gb_table_hash_string/gb_table_eq_string) and gbByteSlice keys
+// (gb_table_hash_bytes/gb_table_eq_bytes) are below. gb_table_hash_pod/gb_table_eq_pod hash and compare the
+// bytes of any plain struct key, gb_zero_item it before filling the fields so padding compares equal.
+// NOTE: The table does not own the memory a key points to, it has to outlive the entry.
+//
+
+typedef struct gbByteSlice {
+  void const *data;
+  ssize_t size;
+} gbByteSlice;
+
+GB_DEF gbByteSlice gb_byte_slice(void const *data, ssize_t size);
+
+GB_DEF uint64_t gb_table_hash_string(gbString const *key);
+GB_DEF byte32_t gb_table_eq_string(gbString const *a, gbString const *b);
+
+GB_DEF uint64_t gb_table_hash_bytes(gbByteSlice const *key);
+GB_DEF byte32_t gb_table_eq_bytes(gbByteSlice const *a, gbByteSlice const *b);
+
+#define gb_table_hash_pod(key) gb_murmur64((key), gb_size_of(*(key)))
+#define gb_table_eq_pod(a, b)  (gb_memcompare((a), (b), gb_size_of(*(a))) == 0)
+
+#define GB_TABLE_KEYED(PREFIX, NAME, FUNC, KEY, VALUE, HASH_FN, EQ_FN) \
+  GB_TABLE_KEYED_DECLARE(PREFIX, NAME, FUNC, KEY, VALUE); \
+  GB_TABLE_KEYED_DEFINE(NAME, FUNC, KEY, VALUE, HASH_FN, EQ_FN);
+
+#define GB_TABLE_KEYED_DECLARE(PREFIX, NAME, FUNC, KEY, VALUE) \
+typedef struct GB_JOIN2(NAME,Entry) { \
+  uint64_t hash; \
+  ssize_t next; \
+  KEY key; \
+  VALUE value; \
+} GB_JOIN2(NAME,Entry); \
+\
+typedef struct NAME { \
+  gbArray(ssize_t) hashes; \
+  gbArray(GB_JOIN2(NAME,Entry)) entries; \
+} NAME; \
+\
+PREFIX void                  GB_JOIN2(FUNC,init)       (NAME *h, gb_allocator_t a); \
+PREFIX void                  GB_JOIN2(FUNC,destroy)    (NAME *h); \
+PREFIX VALUE *               GB_JOIN2(FUNC,get)        (NAME *h, KEY const *key); \
+PREFIX void                  GB_JOIN2(FUNC,set)        (NAME *h, KEY const *key, VALUE value); \
+PREFIX byte32_t              GB_JOIN2(FUNC,remove)     (NAME *h, KEY const *key); \
+PREFIX void                  GB_JOIN2(FUNC,grow)       (NAME *h); \
+PREFIX void                  GB_JOIN2(FUNC,rehash)     (NAME *h, ssize_t new_count); \
+
+
+#define GB_TABLE_KEYED_DEFINE(NAME, FUNC, KEY, VALUE, HASH_FN, EQ_FN) \
+void GB_JOIN2(FUNC,init)(NAME *h, gb_allocator_t a) { \
+  gb_array_init(h->hashes,  a); \
+  gb_array_init(h->entries, a); \
+} \
+\
+void GB_JOIN2(FUNC,destroy)(NAME *h) { \
+  if (h->entries) gb_array_free(h->entries); \
+  if (h->hashes)  gb_array_free(h->hashes); \
+} \
+\
+gb_internal gbHashTableFindResult GB_JOIN2(FUNC,_find)(NAME *h, KEY const *key, uint64_t hash) { \
+  gbHashTableFindResult r = {-1, -1, -1}; \
+  if (gb_array_count(h->hashes) > 0) { \
+    r.hash_index  = hash % gb_array_count(h->hashes); \
+    r.entry_index = h->hashes[r.hash_index]; \
+    while (r.entry_index >= 0) { \
+      GB_JOIN2(NAME,Entry) *e = &h->entries[r.entry_index]; \
+      if (e->hash == hash && EQ_FN(&e->key, key)) \
+        return r; \
+      r.entry_prev = r.entry_index; \
+      r.entry_index = e->next; \
+    } \
+  } \
+  return r; \
+} \
+\
+gb_internal void GB_JOIN2(FUNC,_link)(NAME *h, gbHashTableFindResult fr, ssize_t index) { \
+  if (fr.entry_prev >= 0) \
+    h->entries[fr.entry_prev].next = index; \
+  else \
+    h->hashes[fr.hash_index] = index; \
+} \
+\
+void GB_JOIN2(FUNC,rehash)(NAME *h, ssize_t new_count) { \
+  ssize_t i; \
+  gb_array_resize(h->hashes, new_count); \
+  gb_memset(h->hashes, 0xff, new_count * gb_size_of(ssize_t)); /* NOTE: Every bucket to -1 */ \
+  for (i = gb_array_count(h->entries) - 1; i >= 0; i--) { \
+    ssize_t hash_index = h->entries[i].hash % new_count; \
+    h->entries[i].next = h->hashes[hash_index]; \
+    h->hashes[hash_index] = i; \
+  } \
+} \
+\
+void GB_JOIN2(FUNC,grow)(NAME *h) { \
+  GB_JOIN2(FUNC,rehash)(h, GB_ARRAY_GROW_FORMULA(gb_array_count(h->entries))); \
+} \
+\
+VALUE *GB_JOIN2(FUNC,get)(NAME *h, KEY const *key) { \
+  ssize_t index = GB_JOIN2(FUNC,_find)(h, key, HASH_FN(key)).entry_index; \
+  if (index >= 0) \
+    return &h->entries[index].value; \
+  return NULL; \
+} \
+\
+void GB_JOIN2(FUNC,set)(NAME *h, KEY const *key, VALUE value) { \
+  ssize_t index; \
+  uint64_t hash = HASH_FN(key); \
+  gbHashTableFindResult fr; \
+  if (gb_array_count(h->hashes) == 0) \
+    GB_JOIN2(FUNC,grow)(h); \
+  fr = GB_JOIN2(FUNC,_find)(h, key, hash); \
+  if (fr.entry_index >= 0) { \
+    index = fr.entry_index; \
+  } else { \
+    GB_JOIN2(NAME,Entry) *e; \
+    index = gb_array_count(h->entries); \
+    gb_array_resize(h->entries, index + 1); \
+    e = &h->entries[index]; \
+    e->hash = hash; \
+    e->next = -1; \
+    gb_memcopy(&e->key, key, gb_size_of(KEY)); \
+    GB_JOIN2(FUNC,_link)(h, fr, index); \
+  } \
+  h->entries[index].value = value; \
+  if (0.75f * gb_array_count(h->hashes) < gb_array_count(h->entries)) \
+    GB_JOIN2(FUNC,grow)(h); \
+} \
+\
+byte32_t GB_JOIN2(FUNC,remove)(NAME *h, KEY const *key) { \
+  ssize_t last; \
+  gbHashTableFindResult fr = GB_JOIN2(FUNC,_find)(h, key, HASH_FN(key)); \
+  if (fr.entry_index < 0) \
+    return false; \
+  GB_JOIN2(FUNC,_link)(h, fr, h->entries[fr.entry_index].next); \
+  last = gb_array_count(h->entries) - 1; \
+  if (fr.entry_index != last) { \
+    GB_JOIN2(NAME,Entry) *e = &h->entries[last]; \
+    gbHashTableFindResult moved = GB_JOIN2(FUNC,_find)(h, &e->key, e->hash); \
+    gb_memcopy(&h->entries[fr.entry_index], e, gb_size_of(*e)); \
+    GB_JOIN2(FUNC,_link)(h, moved, fr.entry_index); \
+  } \
+  gb_array_pop(h->entries); \
+  return true; \
+}
+
+
+//
+// Instantiated Flat Hash Table
+//
+// Open addressing alternative to GB_TABLE with the same init/get/set/destroy surface. Slots hold the key
+// and value inline and a separate array holds one control byte per slot: GB_FLAT_TABLE_EMPTY or the top
+// 7 bits of the hash of its key. A lookup loads the 16 control bytes from the home slot of the key and
+// compares them all at once (SSE2, a plain loop elsewhere), only slots whose tag matches are compared, and
+// an empty slot in the group ends the search. The next groups are probed triangularly.
+// The capacity is a power of two (at least 16) indexed with a mask and kept under 7/8 full, the first 16
+// control bytes are mirrored past the end so a group can start at any slot.
+//
+// Flat hash table type and function declaration, call: GB_FLAT_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE)
+// Flat hash table function definitions, call: GB_FLAT_TABLE_DEFINE(NAME, FUNC, VALUE)
+//
+// NOTE: Keys are mixed with the murmur3 finalizer so any key distribution is fine. Iterate over the
+// `capacity` slots whose control byte is >= 0. Pointers returned by get are invalidated by set.
+//
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GB_FLAT_TABLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define GB_FLAT_TABLE_GROUP_SIZE 16
+#define GB_FLAT_TABLE_EMPTY      (-128)
+
+#define GB_FLAT_TABLE(PREFIX, NAME, FUNC, VALUE) \
+  GB_FLAT_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE); \
+  GB_FLAT_TABLE_DEFINE(NAME, FUNC, VALUE);
+
+#define GB_FLAT_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE) \
+typedef struct GB_JOIN2(NAME,Slot) { \
+  uint64_t key; \
+  VALUE value; \
+} GB_JOIN2(NAME,Slot); \
+\
+typedef struct NAME { \
+  gb_allocator_t allocator; \
+  GB_JOIN2(NAME,Slot) *slots; \
+  int8_t *ctrl; \
+  ssize_t capacity; \
+  ssize_t count; \
+} NAME; \
+\
+PREFIX void                  GB_JOIN2(FUNC,init)       (NAME *h, gb_allocator_t a); \
+PREFIX void                  GB_JOIN2(FUNC,destroy)    (NAME *h); \
+PREFIX VALUE *               GB_JOIN2(FUNC,get)        (NAME *h, uint64_t key); \
+PREFIX void                  GB_JOIN2(FUNC,set)        (NAME *h, uint64_t key, VALUE value); \
+PREFIX void                  GB_JOIN2(FUNC,grow)       (NAME *h); \
+PREFIX void                  GB_JOIN2(FUNC,rehash)     (NAME *h, ssize_t new_capacity); \
+
+
+#if defined(GB_FLAT_TABLE_SSE2)
+#define GB__FLAT_TABLE_MATCH(FUNC) \
+gb_internal gb_inline uint32_t GB_JOIN2(FUNC,_match)(int8_t const *group, int8_t tag) { \
+  __m128i g = _mm_loadu_si128(cast(__m128i const *) group); \
+  return cast(uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(tag))); \
+}
+#else
+#define GB__FLAT_TABLE_MATCH(FUNC) \
+gb_internal gb_inline uint32_t GB_JOIN2(FUNC,_match)(int8_t const *group, int8_t tag) { \
+  uint32_t mask = 0; \
+  int32_t i; \
+  for (i = 0; i < GB_FLAT_TABLE_GROUP_SIZE; i++) \
+    mask |= cast(uint32_t) (group[i] == tag) << i; \
+  return mask; \
+}
+#endif
+
+#if defined(GB_COMPILER_MSVC)
+#define GB__FLAT_TABLE_CTZ(FUNC) \
+gb_internal gb_inline ssize_t GB_JOIN2(FUNC,_ctz)(uint32_t mask) { \
+  unsigned long index; \
+  _BitScanForward(&index, mask); \
+  return cast(ssize_t) index; \
+}
+#else
+#define GB__FLAT_TABLE_CTZ(FUNC) \
+gb_internal gb_inline ssize_t GB_JOIN2(FUNC,_ctz)(uint32_t mask) { \
+  return cast(ssize_t) __builtin_ctz(mask); \
+}
+#endif
+
+#define GB_FLAT_TABLE_DEFINE(NAME, FUNC, VALUE) \
+GB__FLAT_TABLE_MATCH(FUNC) \
+GB__FLAT_TABLE_CTZ(FUNC) \
+\
+gb_internal gb_inline uint64_t GB_JOIN2(FUNC,_hash)(uint64_t key) { \
+  key ^= key >> 33; \
+  key *= 0xff51afd7ed558ccdull; \
+  key ^= key >> 33; \
+  key *= 0xc4ceb9fe1a85ec53ull; \
+  key ^= key >> 33; \
+  return key; \
+} \
+\
+void GB_JOIN2(FUNC,init)(NAME *h, gb_allocator_t a) { \
+  gb_zero_item(h); \
+  h->allocator = a; \
+} \
+\
+void GB_JOIN2(FUNC,destroy)(NAME *h) { \
+  if (h->slots) gb_free(h->allocator, h->slots); \
+  h->slots = NULL; \
+  h->ctrl = NULL; \
+  h->capacity = h->count = 0; \
+} \
+\
+gb_internal ssize_t GB_JOIN2(FUNC,_find)(NAME *h, uint64_t key) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  ssize_t mask = h->capacity - 1, pos, stride = 0; \
+  int8_t tag = cast(int8_t) (hash >> 57); \
+  if (h->capacity == 0) \
+    return -1; \
+  pos = cast(ssize_t) hash & mask; \
+  for (;;) { \
+    uint32_t m = GB_JOIN2(FUNC,_match)(h->ctrl + pos, tag); \
+    while (m) { \
+      ssize_t i = (pos + GB_JOIN2(FUNC,_ctz)(m)) & mask; \
+      if (h->slots[i].key == key) \
+        return i; \
+      m &= m - 1; \
+    } \
+    if (GB_JOIN2(FUNC,_match)(h->ctrl + pos, GB_FLAT_TABLE_EMPTY)) \
+      return -1; \
+    stride += GB_FLAT_TABLE_GROUP_SIZE; \
+    pos = (pos + stride) & mask; \
+  } \
+} \
+\
+gb_internal ssize_t GB_JOIN2(FUNC,_insert)(NAME *h, uint64_t key) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  ssize_t mask = h->capacity - 1, pos = cast(ssize_t) hash & mask, stride = 0, i; \
+  int8_t tag = cast(int8_t) (hash >> 57); \
+  uint32_t m; \
+  while ((m = GB_JOIN2(FUNC,_match)(h->ctrl + pos, GB_FLAT_TABLE_EMPTY)) == 0) { \
+    stride += GB_FLAT_TABLE_GROUP_SIZE; \
+    pos = (pos + stride) & mask; \
+  } \
+  i = (pos + GB_JOIN2(FUNC,_ctz)(m)) & mask; \
+  h->ctrl[i] = tag; \
+  h->ctrl[((i - GB_FLAT_TABLE_GROUP_SIZE) & mask) + GB_FLAT_TABLE_GROUP_SIZE] = tag; \
+  h->slots[i].key = key; \
+  h->count++; \
+  return i; \
+} \
+\
+void GB_JOIN2(FUNC,grow)(NAME *h) { \
+  GB_JOIN2(FUNC,rehash)(h, h->capacity ? 2 * h->capacity : GB_FLAT_TABLE_GROUP_SIZE); \
+} \
+\
+void GB_JOIN2(FUNC,rehash)(NAME *h, ssize_t new_capacity) { \
+  ssize_t i, capacity = GB_FLAT_TABLE_GROUP_SIZE; \
+  NAME nh = *h; \
+  while (capacity < new_capacity || capacity * 7 < h->count * 8) \
+    capacity *= 2; \
+  /* NOTE: Not cleared, a slot is only read once its control byte marks it full */ \
+  nh.slots = cast(GB_JOIN2(NAME,Slot) *) gb_alloc_align_flags(h->allocator, \
+                                                               capacity * (gb_size_of(GB_JOIN2(NAME,Slot)) + 1) + GB_FLAT_TABLE_GROUP_SIZE, \
+                                                               gb_max(gb_align_of(GB_JOIN2(NAME,Slot)), GB_DEFAULT_MEMORY_ALIGNMENT), 0); \
+  nh.ctrl = cast(int8_t *) (nh.slots + capacity); \
+  nh.capacity = capacity; \
+  nh.count = 0; \
+  gb_memset(nh.ctrl, cast(uint8_t) GB_FLAT_TABLE_EMPTY, capacity + GB_FLAT_TABLE_GROUP_SIZE); \
+  for (i = 0; i < h->capacity; i++) { \
+    if (h->ctrl[i] >= 0) \
+      nh.slots[GB_JOIN2(FUNC,_insert)(&nh, h->slots[i].key)].value = h->slots[i].value; \
+  } \
+  GB_JOIN2(FUNC,destroy)(h); \
+  *h = nh; \
+} \
+\
+VALUE *GB_JOIN2(FUNC,get)(NAME *h, uint64_t key) { \
+  ssize_t index = GB_JOIN2(FUNC,_find)(h, key); \
+  if (index >= 0) \
+    return &h->slots[index].value; \
+  return NULL; \
+} \
+\
+void GB_JOIN2(FUNC,set)(NAME *h, uint64_t key, VALUE value) { \
+  ssize_t index = GB_JOIN2(FUNC,_find)(h, key); \
+  if (index < 0) { \
+    if ((h->count + 1) * 8 > h->capacity * 7) \
+      GB_JOIN2(FUNC,grow)(h); \
+    index = GB_JOIN2(FUNC,_insert)(h, key); \
+  } \
+  h->slots[index].value = value; \
 }
 
 #endif /* GB_HTABLE_H__ */
@@ -30,6 +30,10 @@
 
 #include "gb/fs.h"
 
+#ifndef GB_PRINTF_BUFFER_SIZE
+#define GB_PRINTF_BUFFER_SIZE 4096
+#endif
+
 GB_DEF ssize_t gb_printf(char const *fmt, ...) GB_PRINTF_ARGS(1);
 
 GB_DEF ssize_t gb_printf_va(char const *fmt, va_list va);
@@ -42,10 +46,11 @@ GB_DEF ssize_t gb_fprintf(gbFile *f, char const *fmt, ...) GB_PRINTF_ARGS(2);
 
 GB_DEF ssize_t gb_fprintf_va(gbFile *f, char const *fmt, va_list va);
 
+// NOTE: Formats into GB_PRINTF_BUFFER_SIZE bytes of the thread scratch ring, see gb_thread_scratch_allocator
 GB_DEF char *
-gb_bprintf(char const *fmt, ...) GB_PRINTF_ARGS(1); // NOTE(bill): A locally persisting buffer is used internally
+gb_bprintf(char const *fmt, ...) GB_PRINTF_ARGS(1);
 GB_DEF char *
-gb_bprintf_va(char const *fmt, va_list va);            // NOTE(bill): A locally persisting buffer is used internally
+gb_bprintf_va(char const *fmt, va_list va);
 GB_DEF ssize_t gb_snprintf(char *str, ssize_t n, char const *fmt, ...) GB_PRINTF_ARGS(3);
 
 GB_DEF ssize_t gb_snprintf_va(char *str, ssize_t n, char const *fmt, va_list va);
@@ -46,6 +46,9 @@ GB_DEF uint64_t gb_endian_swap64(uint64_t i);
 
 GB_DEF ssize_t gb_count_set_bits(uint64_t mask);
 
+// NOTE: Index of the highest set bit, x must not be 0
+GB_DEF ssize_t gb_log2(uint64_t x);
+
 #if defined(GB_PLATFORM)
 
 // NOTE(bill):
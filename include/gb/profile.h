@@ -0,0 +1,123 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#ifndef  GB_PROFILE_H__
+# define GB_PROFILE_H__
+
+#include "gb/htable.h"
+#include "gb/io.h"
+#include "gb/atomic.h"
+
+//
+// Sampling Heap Profiler
+//
+// Wraps any gb_allocator_t and samples about one allocation every `sample_period` bytes. The distance to the
+// next sample is drawn from an exponential distribution so every byte has the same chance of being picked
+// whatever the allocation pattern, the same scheme TCMalloc and Go use.
+//
+//     - Unsampled allocations cost a thread local countdown on alloc and one bit of a filter on free before a
+//       tail call into the backing allocator, no
+//       header, no lock.
+//     - Sampled allocations unwind their stack, which is interned in a GB_TABLE keyed by its hash, and are
+//       remembered in an address set until they are freed.
+//
+// gb_heap_profiler_write() dumps the samples in the legacy heap profile text format ("heap_v2"), which
+// `pprof` reads and unsamples itself:
+//
+//     - gbHeapProfile_Live, bytes in use and allocated since the profiler started.
+//     - gbHeapProfile_Allocs, bytes in use and allocated since the previous gbHeapProfile_Allocs write, divide
+//       by the time between writes to get allocation rates.
+//
+// NOTE: The countdown is per thread and shared by every profiler on that thread, running a single one is the
+// intended use.
+//
+// Allocation Types: alloc, free, free_all, resize
+//
+
+#ifndef GB_HEAP_PROFILE_SAMPLE_PERIOD
+#define GB_HEAP_PROFILE_SAMPLE_PERIOD gb_megabytes(2)
+#endif
+
+#ifndef GB_HEAP_PROFILE_MAX_DEPTH
+#define GB_HEAP_PROFILE_MAX_DEPTH 32
+#endif
+
+// NOTE: Slots of the filter checked on every free, must be a power of two and a multiple of 32. The free
+// path only reads their bits (GB_HEAP_PROFILE_FILTER_SIZE / 8 bytes) so they stay in cache under heavy churn
+#ifndef GB_HEAP_PROFILE_FILTER_SIZE
+#define GB_HEAP_PROFILE_FILTER_SIZE 16384
+#endif
+
+typedef struct gb_heap_profile_stack gb_heap_profile_stack_t;
+typedef struct gb_heap_profile_sample gb_heap_profile_sample_t;
+typedef struct gb_heap_profiler gb_heap_profiler_t;
+
+typedef enum gbHeapProfileKind {
+  gbHeapProfile_Live,
+  gbHeapProfile_Allocs,
+} gbHeapProfileKind;
+
+struct gb_heap_profile_stack {
+  void *frames[GB_HEAP_PROFILE_MAX_DEPTH];
+  int32_t depth;
+  ssize_t live_count;
+  ssize_t live_bytes;
+  ssize_t alloc_count;
+  ssize_t alloc_bytes;
+  ssize_t last_alloc_count; // NOTE: Values at the previous gbHeapProfile_Allocs write
+  ssize_t last_alloc_bytes;
+};
+
+struct gb_heap_profile_sample {
+  void *ptr;
+  ssize_t size;
+  uint64_t stack;
+};
+
+GB_TABLE_DECLARE(extern, gbHeapProfileStackTable, gb_heap_profile_stack_table_, gb_heap_profile_stack_t)
+
+struct gb_heap_profiler {
+  gb_allocator_t backing;
+  ssize_t sample_period;
+  gbAtomic32 lock;
+  gbHeapProfileStackTable stacks;     // NOTE: Allocated from the backing allocator, like the samples
+  gb_heap_profile_sample_t *samples;  // NOTE: Open addressing on the address, NULL for an empty slot
+  ssize_t sample_capacity;
+  ssize_t sample_count;
+  gbAtomic32 filter[GB_HEAP_PROFILE_FILTER_SIZE / 32]; // NOTE: Bit set while a live sample hashes to the slot
+  uint16_t filter_counts[GB_HEAP_PROFILE_FILTER_SIZE]; // NOTE: Live samples per slot, under the lock
+};
+
+// NOTE: sample_period <= 0 picks GB_HEAP_PROFILE_SAMPLE_PERIOD
+GB_DEF void gb_heap_profiler_init(gb_heap_profiler_t *profiler, gb_allocator_t backing, ssize_t sample_period);
+GB_DEF void gb_heap_profiler_free(gb_heap_profiler_t *profiler);
+GB_DEF byte32_t gb_heap_profiler_write(gb_heap_profiler_t *profiler, gbFile *f, gbHeapProfileKind kind);
+
+GB_DEF gb_allocator_t gb_heap_profiler_allocator(gb_heap_profiler_t *profiler);
+GB_DEF GB_ALLOCATOR_PROC(gb_heap_profiler_allocator_proc);
+
+#endif /* GB_PROFILE_H__ */
@@ -0,0 +1,316 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#ifndef  GB_SHTABLE_H__
+# define GB_SHTABLE_H__
+
+#include "gb/alloc.h"
+#include "gb/sem.h"
+
+//
+// Instantiated Sharded Hash Table
+//
+// Concurrent uint64_t keyed map for caches shared by many threads. The key space is split over a power of
+// two count of shards picked by the hash of the key, each with its own open addressing (linear probing)
+// block of slots, writer spin lock and sequence counter:
+//     - Writers take the shard lock and bump the sequence to odd before touching the block, back to even
+//       after, so readers of other shards never contend with them.
+//     - Readers take no lock: they copy the value out between two reads of the sequence and retry when it
+//       changed or was odd, so a lookup is a handful of loads while no writer is in its shard.
+//     - A grow publishes a new block and keeps the old one alive until destroy, a reader still probing it
+//       reads stale but valid memory and retries. The retired blocks add up to less than the live one.
+//
+// Sharded hash table type and function declaration, call: GB_SHARDED_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE)
+// Sharded hash table function definitions, call: GB_SHARDED_TABLE_DEFINE(NAME, FUNC, VALUE)
+//
+//     init(h, a, shard_count)      - shard_count a power of two, 0 for GB_SHARDED_TABLE_DEFAULT_SHARDS
+//     get(h, key, &value)          - lock free, true and a copy of the value when found
+//     set(h, key, value)           - insert or overwrite
+//     get_or_insert(h, key, value, &out) - atomically insert value when absent, out is what ends up stored,
+//                                    true when it was inserted
+//     update(h, key, proc, data)   - proc(&value, found, data) under the shard lock, a missing key is
+//                                    inserted zeroed first, true when it was found
+//     remove(h, key)               - true when it was there
+//
+// NOTE: Values are copied in and out, no pointer into the table is handed out. Keep update procs short,
+// readers of the shard spin while they run.
+//
+
+#ifndef GB_SHARDED_TABLE_DEFAULT_SHARDS
+#define GB_SHARDED_TABLE_DEFAULT_SHARDS 64
+#endif
+
+#define GB_SHARDED_TABLE_MIN_CAPACITY 16
+
+#define GB_SHARDED_TABLE(PREFIX, NAME, FUNC, VALUE) \
+  GB_SHARDED_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE); \
+  GB_SHARDED_TABLE_DEFINE(NAME, FUNC, VALUE);
+
+#define GB_SHARDED_TABLE_DECLARE(PREFIX, NAME, FUNC, VALUE) \
+typedef struct GB_JOIN2(NAME,Slot) { \
+  uint64_t key; \
+  byte32_t used; \
+  VALUE value; \
+} GB_JOIN2(NAME,Slot); \
+\
+typedef struct GB_JOIN2(NAME,Block) { \
+  struct GB_JOIN2(NAME,Block) *retired; \
+  ssize_t capacity; \
+  GB_JOIN2(NAME,Slot) slots[]; \
+} GB_JOIN2(NAME,Block); \
+\
+typedef struct GB_JOIN2(NAME,Shard) { \
+  gbAtomic32 seq; \
+  gbAtomic32 lock; \
+  gbAtomicPtr block; \
+  ssize_t count; \
+  uint8_t padding[GB_CACHE_LINE_SIZE - 2 * gb_size_of(gbAtomic32) - gb_size_of(gbAtomicPtr) - gb_size_of(ssize_t)]; \
+} GB_JOIN2(NAME,Shard); \
+\
+typedef void GB_JOIN2(NAME,UpdateProc)(VALUE *value, byte32_t found, void *data); \
+\
+typedef struct NAME { \
+  gb_allocator_t allocator; \
+  GB_JOIN2(NAME,Shard) *shards; \
+  ssize_t shard_count; \
+} NAME; \
+\
+PREFIX void                  GB_JOIN2(FUNC,init)          (NAME *h, gb_allocator_t a, ssize_t shard_count); \
+PREFIX void                  GB_JOIN2(FUNC,destroy)       (NAME *h); \
+PREFIX byte32_t              GB_JOIN2(FUNC,get)           (NAME *h, uint64_t key, VALUE *value); \
+PREFIX void                  GB_JOIN2(FUNC,set)           (NAME *h, uint64_t key, VALUE value); \
+PREFIX byte32_t              GB_JOIN2(FUNC,get_or_insert) (NAME *h, uint64_t key, VALUE value, VALUE *out); \
+PREFIX byte32_t              GB_JOIN2(FUNC,update)        (NAME *h, uint64_t key, GB_JOIN2(NAME,UpdateProc) *proc, void *data); \
+PREFIX byte32_t              GB_JOIN2(FUNC,remove)        (NAME *h, uint64_t key); \
+PREFIX ssize_t               GB_JOIN2(FUNC,count)         (NAME *h); \
+
+
+#define GB_SHARDED_TABLE_DEFINE(NAME, FUNC, VALUE) \
+gb_internal gb_inline uint64_t GB_JOIN2(FUNC,_hash)(uint64_t key) { \
+  key ^= key >> 33; \
+  key *= 0xff51afd7ed558ccdull; \
+  key ^= key >> 33; \
+  key *= 0xc4ceb9fe1a85ec53ull; \
+  key ^= key >> 33; \
+  return key; \
+} \
+\
+gb_internal GB_JOIN2(NAME,Shard) *GB_JOIN2(FUNC,_shard)(NAME *h, uint64_t hash) { \
+  return &h->shards[(hash >> 32) & (h->shard_count - 1)]; \
+} \
+\
+gb_internal GB_JOIN2(NAME,Block) *GB_JOIN2(FUNC,_block_alloc)(NAME *h, ssize_t capacity) { \
+  ssize_t i; \
+  GB_JOIN2(NAME,Block) *b = cast(GB_JOIN2(NAME,Block) *) \
+    gb_alloc_align_flags(h->allocator, gb_size_of(GB_JOIN2(NAME,Block)) + capacity * gb_size_of(GB_JOIN2(NAME,Slot)), \
+                         GB_DEFAULT_MEMORY_ALIGNMENT, 0); /* NOTE: Only the used flags need clearing */ \
+  b->retired = NULL; \
+  b->capacity = capacity; \
+  for (i = 0; i < capacity; i++) \
+    b->slots[i].used = false; \
+  return b; \
+} \
+\
+/* NOTE: Slot holding key or the empty slot ending its probe, -1 only on a block torn by a writer */ \
+gb_internal ssize_t GB_JOIN2(FUNC,_probe)(GB_JOIN2(NAME,Block) *b, uint64_t key, uint64_t hash) { \
+  ssize_t mask = b->capacity - 1, i = cast(ssize_t) hash & mask, n; \
+  for (n = 0; n < b->capacity; n++, i = (i + 1) & mask) { \
+    if (!b->slots[i].used || b->slots[i].key == key) \
+      return i; \
+  } \
+  return -1; \
+} \
+\
+gb_internal void GB_JOIN2(FUNC,_lock)(GB_JOIN2(NAME,Shard) *s) { \
+  while (!gb_atomic32_spin_lock(&s->lock, 64)) \
+    gb_yield(); \
+  gb_atomic32_fetch_add(&s->seq, 1); \
+} \
+\
+gb_internal void GB_JOIN2(FUNC,_unlock)(GB_JOIN2(NAME,Shard) *s) { \
+  gb_atomic32_fetch_add(&s->seq, 1); \
+  gb_atomic32_spin_unlock(&s->lock); \
+} \
+\
+/* NOTE: Under the shard lock, slot of key after inserting it unset when it was missing */ \
+gb_internal ssize_t GB_JOIN2(FUNC,_insert)(NAME *h, GB_JOIN2(NAME,Shard) *s, uint64_t key, uint64_t hash, byte32_t *found) { \
+  GB_JOIN2(NAME,Block) *b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+  ssize_t i = GB_JOIN2(FUNC,_probe)(b, key, hash); \
+  if ((*found = b->slots[i].used)) \
+    return i; \
+  if (4 * (s->count + 1) > 3 * b->capacity) { \
+    GB_JOIN2(NAME,Block) *nb = GB_JOIN2(FUNC,_block_alloc)(h, 2 * b->capacity); \
+    ssize_t j; \
+    for (j = 0; j < b->capacity; j++) { \
+      if (b->slots[j].used) { \
+        GB_JOIN2(NAME,Slot) *slot = &b->slots[j]; \
+        nb->slots[GB_JOIN2(FUNC,_probe)(nb, slot->key, GB_JOIN2(FUNC,_hash)(slot->key))] = *slot; \
+      } \
+    } \
+    nb->retired = b; \
+    gb_atomic_ptr_store(&s->block, nb); \
+    b = nb; \
+    i = GB_JOIN2(FUNC,_probe)(b, key, hash); \
+  } \
+  b->slots[i].key = key; \
+  b->slots[i].used = true; \
+  s->count++; \
+  return i; \
+} \
+\
+void GB_JOIN2(FUNC,init)(NAME *h, gb_allocator_t a, ssize_t shard_count) { \
+  ssize_t i; \
+  if (shard_count <= 0) \
+    shard_count = GB_SHARDED_TABLE_DEFAULT_SHARDS; \
+  GB_ASSERT(gb_is_power_of_two(shard_count)); \
+  h->allocator = a; \
+  h->shard_count = shard_count; \
+  h->shards = cast(GB_JOIN2(NAME,Shard) *) gb_alloc_align(a, shard_count * gb_size_of(GB_JOIN2(NAME,Shard)), GB_CACHE_LINE_SIZE); \
+  for (i = 0; i < shard_count; i++) \
+    gb_atomic_ptr_store(&h->shards[i].block, GB_JOIN2(FUNC,_block_alloc)(h, GB_SHARDED_TABLE_MIN_CAPACITY)); \
+} \
+\
+void GB_JOIN2(FUNC,destroy)(NAME *h) { \
+  ssize_t i; \
+  for (i = 0; i < h->shard_count; i++) { \
+    GB_JOIN2(NAME,Block) *b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&h->shards[i].block); \
+    while (b) { \
+      GB_JOIN2(NAME,Block) *retired = b->retired; \
+      gb_free(h->allocator, b); \
+      b = retired; \
+    } \
+  } \
+  gb_free(h->allocator, h->shards); \
+} \
+\
+byte32_t GB_JOIN2(FUNC,get)(NAME *h, uint64_t key, VALUE *value) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  GB_JOIN2(NAME,Shard) *s = GB_JOIN2(FUNC,_shard)(h, hash); \
+  for (;;) { \
+    int32_t seq = gb_atomic32_load(&s->seq); \
+    GB_JOIN2(NAME,Block) *b; \
+    ssize_t i; \
+    byte32_t found = false; \
+    if (seq & 1) { \
+      gb_yield_thread(); \
+      continue; \
+    } \
+    gb_lfence(); \
+    b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+    i = GB_JOIN2(FUNC,_probe)(b, key, hash); \
+    if (i >= 0 && b->slots[i].used && b->slots[i].key == key) { \
+      *value = b->slots[i].value; \
+      found = true; \
+    } \
+    gb_lfence(); \
+    if (gb_atomic32_load(&s->seq) == seq) \
+      return found; \
+  } \
+} \
+\
+void GB_JOIN2(FUNC,set)(NAME *h, uint64_t key, VALUE value) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  GB_JOIN2(NAME,Shard) *s = GB_JOIN2(FUNC,_shard)(h, hash); \
+  GB_JOIN2(NAME,Block) *b; \
+  byte32_t found; \
+  ssize_t i; \
+  GB_JOIN2(FUNC,_lock)(s); \
+  i = GB_JOIN2(FUNC,_insert)(h, s, key, hash, &found); \
+  b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+  b->slots[i].value = value; \
+  GB_JOIN2(FUNC,_unlock)(s); \
+} \
+\
+byte32_t GB_JOIN2(FUNC,get_or_insert)(NAME *h, uint64_t key, VALUE value, VALUE *out) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  GB_JOIN2(NAME,Shard) *s = GB_JOIN2(FUNC,_shard)(h, hash); \
+  GB_JOIN2(NAME,Block) *b; \
+  byte32_t found; \
+  ssize_t i; \
+  if (GB_JOIN2(FUNC,get)(h, key, out)) \
+    return false; \
+  GB_JOIN2(FUNC,_lock)(s); \
+  i = GB_JOIN2(FUNC,_insert)(h, s, key, hash, &found); \
+  b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+  if (!found) \
+    b->slots[i].value = value; \
+  *out = b->slots[i].value; \
+  GB_JOIN2(FUNC,_unlock)(s); \
+  return !found; \
+} \
+\
+byte32_t GB_JOIN2(FUNC,update)(NAME *h, uint64_t key, GB_JOIN2(NAME,UpdateProc) *proc, void *data) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  GB_JOIN2(NAME,Shard) *s = GB_JOIN2(FUNC,_shard)(h, hash); \
+  GB_JOIN2(NAME,Block) *b; \
+  byte32_t found; \
+  ssize_t i; \
+  GB_JOIN2(FUNC,_lock)(s); \
+  i = GB_JOIN2(FUNC,_insert)(h, s, key, hash, &found); \
+  b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+  if (!found) \
+    gb_zero_item(&b->slots[i].value); \
+  proc(&b->slots[i].value, found, data); \
+  GB_JOIN2(FUNC,_unlock)(s); \
+  return found; \
+} \
+\
+byte32_t GB_JOIN2(FUNC,remove)(NAME *h, uint64_t key) { \
+  uint64_t hash = GB_JOIN2(FUNC,_hash)(key); \
+  GB_JOIN2(NAME,Shard) *s = GB_JOIN2(FUNC,_shard)(h, hash); \
+  GB_JOIN2(NAME,Block) *b; \
+  ssize_t i, j, mask; \
+  GB_JOIN2(FUNC,_lock)(s); \
+  b = cast(GB_JOIN2(NAME,Block) *) gb_atomic_ptr_load(&s->block); \
+  i = GB_JOIN2(FUNC,_probe)(b, key, hash); \
+  if (!b->slots[i].used) { \
+    GB_JOIN2(FUNC,_unlock)(s); \
+    return false; \
+  } \
+  /* NOTE: Backward shift, pull every later slot of the run that may live at i into the hole */ \
+  mask = b->capacity - 1; \
+  for (j = (i + 1) & mask; b->slots[j].used; j = (j + 1) & mask) { \
+    ssize_t home = cast(ssize_t) GB_JOIN2(FUNC,_hash)(b->slots[j].key) & mask; \
+    if (((j - home) & mask) >= ((j - i) & mask)) { \
+      b->slots[i] = b->slots[j]; \
+      i = j; \
+    } \
+  } \
+  b->slots[i].used = false; \
+  s->count--; \
+  GB_JOIN2(FUNC,_unlock)(s); \
+  return true; \
+} \
+\
+ssize_t GB_JOIN2(FUNC,count)(NAME *h) { \
+  ssize_t i, count = 0; \
+  for (i = 0; i < h->shard_count; i++) \
+    count += h->shards[i].count; \
+  return count; \
+}
+
+#endif /* GB_SHTABLE_H__ */
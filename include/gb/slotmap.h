@@ -0,0 +1,178 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#ifndef  GB_SLOTMAP_H__
+# define GB_SLOTMAP_H__
+
+#include "gb/array.h"
+
+//
+// Instantiated Slot Map
+//
+// Values are stored packed in a gbArray and addressed by 64-bit handles: the low 32 bits index a slot, the
+// high 32 bits are the generation the slot had when the value was inserted. Removing a value bumps the
+// generation of its slot, so stale handles are detected instead of reaching another value, and moves the
+// last value into the hole. Insert, remove and get are O(1), iterate with a linear scan over `values`.
+//
+// Slot map type and function declaration, call: GB_SLOT_MAP_DECLARE(PREFIX, NAME, FUNC, VALUE)
+// Slot map function definitions, call: GB_SLOT_MAP_DEFINE(NAME, FUNC, VALUE)
+//
+//     PREFIX  - a prefix for function prototypes e.g. extern, static, etc.
+//     NAME    - Name of the Slot Map
+//     FUNC    - the name will prefix function names
+//     VALUE   - the type of the value to be stored
+//
+// NOTE: Pointers into `values` are only valid until the next insert or remove, keep handles instead
+//
+
+#if 0 // Example
+GB_SLOT_MAP(static, gbEntityMap, gb_entity_map_, gbEntity);
+
+void foo(gbEntityMap *entities) {
+  ssize_t i;
+  for (i = 0; i < gb_array_count(entities->values); i++)
+    gb_entity_update(&entities->values[i]);
+}
+#endif
+
+#define GB_SLOT_HANDLE_NONE 0
+
+#define gb_slot_handle(index, generation) ((cast(uint64_t) (generation) << 32) | cast(uint32_t) (index))
+#define gb_slot_handle_index(handle)      cast(uint32_t) (handle)
+#define gb_slot_handle_generation(handle) cast(uint32_t) ((handle) >> 32)
+
+typedef struct gbSlotMapSlot {
+  uint32_t generation;
+  uint32_t index; // NOTE: Packed value index when used, next free slot otherwise
+} gbSlotMapSlot;
+
+#define GB_SLOT_MAP(PREFIX, NAME, FUNC, VALUE) \
+  GB_SLOT_MAP_DECLARE(PREFIX, NAME, FUNC, VALUE); \
+  GB_SLOT_MAP_DEFINE(NAME, FUNC, VALUE);
+
+#define GB_SLOT_MAP_DECLARE(PREFIX, NAME, FUNC, VALUE) \
+typedef struct NAME { \
+  gbArray(gbSlotMapSlot) slots; \
+  gbArray(VALUE) values; \
+  gbArray(uint32_t) owners; \
+  uint32_t free_slot; \
+} NAME; \
+\
+PREFIX void                  GB_JOIN2(FUNC,init)       (NAME *m, gb_allocator_t a); \
+PREFIX void                  GB_JOIN2(FUNC,destroy)    (NAME *m); \
+PREFIX uint64_t              GB_JOIN2(FUNC,insert)     (NAME *m, VALUE value); \
+PREFIX byte32_t              GB_JOIN2(FUNC,remove)     (NAME *m, uint64_t handle); \
+PREFIX VALUE *               GB_JOIN2(FUNC,get)        (NAME *m, uint64_t handle); \
+PREFIX uint64_t              GB_JOIN2(FUNC,handle)     (NAME *m, ssize_t value_index); \
+PREFIX void                  GB_JOIN2(FUNC,clear)      (NAME *m); \
+
+
+#define GB_SLOT_MAP_DEFINE(NAME, FUNC, VALUE) \
+void GB_JOIN2(FUNC,init)(NAME *m, gb_allocator_t a) { \
+  gb_array_init(m->slots,  a); \
+  gb_array_init(m->values, a); \
+  gb_array_init(m->owners, a); \
+  m->free_slot = UINT32_MAX; \
+} \
+\
+void GB_JOIN2(FUNC,destroy)(NAME *m) { \
+  if (m->owners) gb_array_free(m->owners); \
+  if (m->values) gb_array_free(m->values); \
+  if (m->slots)  gb_array_free(m->slots); \
+} \
+\
+gb_internal gbSlotMapSlot *GB_JOIN2(FUNC,_slot)(NAME *m, uint64_t handle) { \
+  uint32_t i = gb_slot_handle_index(handle); \
+  if (i < cast(uint64_t) gb_array_count(m->slots) && m->slots[i].generation == gb_slot_handle_generation(handle)) \
+    return &m->slots[i]; \
+  return NULL; \
+} \
+\
+uint64_t GB_JOIN2(FUNC,insert)(NAME *m, VALUE value) { \
+  uint32_t i = m->free_slot; \
+  if (i == UINT32_MAX) { \
+    gbSlotMapSlot slot = {1, 0}; \
+    GB_ASSERT(gb_array_count(m->slots) < UINT32_MAX); \
+    i = cast(uint32_t) gb_array_count(m->slots); \
+    gb_array_append(m->slots, slot); \
+  } else { \
+    m->free_slot = m->slots[i].index; \
+  } \
+  m->slots[i].index = cast(uint32_t) gb_array_count(m->values); \
+  gb_array_append(m->values, value); \
+  gb_array_append(m->owners, i); \
+  return gb_slot_handle(i, m->slots[i].generation); \
+} \
+\
+byte32_t GB_JOIN2(FUNC,remove)(NAME *m, uint64_t handle) { \
+  gbSlotMapSlot *slot = GB_JOIN2(FUNC,_slot)(m, handle); \
+  uint32_t last; \
+  if (!slot) \
+    return false; \
+  last = cast(uint32_t) gb_array_count(m->values) - 1; \
+  if (slot->index != last) { \
+    m->values[slot->index] = m->values[last]; \
+    m->owners[slot->index] = m->owners[last]; \
+    m->slots[m->owners[last]].index = slot->index; \
+  } \
+  gb_array_pop(m->values); \
+  gb_array_pop(m->owners); \
+  if (++slot->generation == 0) \
+    slot->generation = 1; \
+  slot->index = m->free_slot; \
+  m->free_slot = gb_slot_handle_index(handle); \
+  return true; \
+} \
+\
+VALUE *GB_JOIN2(FUNC,get)(NAME *m, uint64_t handle) { \
+  gbSlotMapSlot *slot = GB_JOIN2(FUNC,_slot)(m, handle); \
+  if (slot) \
+    return &m->values[slot->index]; \
+  return NULL; \
+} \
+\
+uint64_t GB_JOIN2(FUNC,handle)(NAME *m, ssize_t value_index) { \
+  uint32_t i; \
+  GB_ASSERT(value_index >= 0 && value_index < gb_array_count(m->values)); \
+  i = m->owners[value_index]; \
+  return gb_slot_handle(i, m->slots[i].generation); \
+} \
+\
+void GB_JOIN2(FUNC,clear)(NAME *m) { \
+  ssize_t i; \
+  for (i = gb_array_count(m->owners) - 1; i >= 0; i--) { \
+    gbSlotMapSlot *slot = &m->slots[m->owners[i]]; \
+    if (++slot->generation == 0) \
+      slot->generation = 1; \
+    slot->index = m->free_slot; \
+    m->free_slot = m->owners[i]; \
+  } \
+  gb_array_clear(m->values); \
+  gb_array_clear(m->owners); \
+}
+
+#endif /* GB_SLOTMAP_H__ */
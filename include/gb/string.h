@@ -203,15 +203,23 @@ GB_DEF ssize_t gb_string_available_space(gbString const str);
 
 GB_DEF void gb_string_clear(gbString str);
 
-GB_DEF gbString gb_string_append(gbString str, gbString const other);
+// NOTE: The functions that may grow the string take the call site for trackers (see gb/track.h), the macros
+// below pass the one of their caller
+GB_DEF gbString gb_string_append_at(gbString str, gbString const other, char const *file, int32_t line);
 
-GB_DEF gbString gb_string_append_length(gbString str, void const *other, ssize_t num_bytes);
+GB_DEF gbString gb_string_append_length_at(gbString str, void const *other, ssize_t num_bytes, char const *file, int32_t line);
 
-GB_DEF gbString gb_string_appendc(gbString str, char const *other);
+GB_DEF gbString gb_string_appendc_at(gbString str, char const *other, char const *file, int32_t line);
 
-GB_DEF gbString gb_string_set(gbString str, char const *cstr);
+GB_DEF gbString gb_string_set_at(gbString str, char const *cstr, char const *file, int32_t line);
 
-GB_DEF gbString gb_string_make_space_for(gbString str, ssize_t add_len);
+GB_DEF gbString gb_string_make_space_for_at(gbString str, ssize_t add_len, char const *file, int32_t line);
+
+#define gb_string_append(str, other)                gb_string_append_at(str, other, __FILE__, __LINE__)
+#define gb_string_append_length(str, other, length) gb_string_append_length_at(str, other, length, __FILE__, __LINE__)
+#define gb_string_appendc(str, other)               gb_string_appendc_at(str, other, __FILE__, __LINE__)
+#define gb_string_set(str, cstr)                    gb_string_set_at(str, cstr, __FILE__, __LINE__)
+#define gb_string_make_space_for(str, add_len)      gb_string_make_space_for_at(str, add_len, __FILE__, __LINE__)
 
 GB_DEF ssize_t gb_string_allocation_size(gbString const str);
 
@@ -65,6 +65,14 @@ GB_DEF uint32_t gb_thread_current_id(void);
 
 GB_DEF void gb_thread_set_name(gbThread *t, char const *name);
 
+// NOTE: Small dense index of the calling thread in [0, GB_THREAD_SLOT_COUNT), -1 when all are taken.
+// Slots are given back when the thread exits (POSIX only) so per-thread tables can be indexed by it.
+#ifndef GB_THREAD_SLOT_COUNT
+#define GB_THREAD_SLOT_COUNT 64
+#endif
+
+GB_DEF ssize_t gb_thread_slot(void);
+
 // NOTE(bill): Thread Merge Operation
 // Based on Sean Barrett's stb_sync
 typedef struct gbSync {
@@ -0,0 +1,112 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#ifndef  GB_TRACK_H__
+# define GB_TRACK_H__
+
+#include "gb/htable.h"
+#include "gb/io.h"
+#include "gb/atomic.h"
+
+//
+// Tracking Allocator
+//
+// Wraps any gb_allocator_t and keeps statistics about the traffic going through it:
+//
+//     - live and peak bytes, alloc/free/resize counts and a power of two histogram of the requested sizes.
+//     - optionally, the same numbers per call site. Sites are recorded by gb_alloc_at/gb_resize_at and the
+//       `_here` macros below and are kept in a GB_TABLE keyed by a hash of __FILE__ and __LINE__. gbArray,
+//       gbSmallArray and gbString charge their allocations and grows to the line that called their macro.
+//       Allocations made through the plain entry points go to the unknown site.
+//
+// Every allocation gets a small header in front of it to remember its size and site, so a tracked block
+// must be freed through the same tracker. All the bookkeeping is behind a spin lock, the backing allocator
+// is called as is.
+//
+// Allocation Types: alloc, free, free_all, resize
+//
+
+// NOTE: Bucket 0 counts empty requests, bucket n requests of [2^(n-1), 2^n) bytes, the last one everything above
+#ifndef GB_TRACK_HISTOGRAM_COUNT
+#define GB_TRACK_HISTOGRAM_COUNT 32
+#endif
+
+typedef struct gb_track_stats gb_track_stats_t;
+typedef struct gb_track_site gb_track_site_t;
+typedef struct gb_tracker gb_tracker_t;
+
+struct gb_track_stats {
+  ssize_t live_bytes;
+  ssize_t peak_bytes;
+  ssize_t total_bytes;
+  ssize_t alloc_count;
+  ssize_t free_count;
+  ssize_t resize_count;
+  ssize_t histogram[GB_TRACK_HISTOGRAM_COUNT];
+};
+
+struct gb_track_site {
+  char const *file;
+  int32_t line;
+  ssize_t live_bytes;
+  ssize_t peak_bytes;
+  ssize_t total_bytes;
+  ssize_t alloc_count;
+  ssize_t free_count;
+  ssize_t resize_count;
+};
+
+GB_TABLE_DECLARE(extern, gbTrackSiteTable, gb_track_site_table_, gb_track_site_t)
+
+struct gb_tracker {
+  gb_allocator_t backing;
+  gbAtomic32 lock;
+  byte32_t track_sites;
+  gb_track_stats_t stats;
+  gbTrackSiteTable sites; // NOTE: Allocated from the backing allocator
+};
+
+GB_DEF void gb_tracker_init(gb_tracker_t *tracker, gb_allocator_t backing, byte32_t track_sites);
+GB_DEF void gb_tracker_free(gb_tracker_t *tracker);
+GB_DEF gb_track_stats_t gb_tracker_stats(gb_tracker_t *tracker);
+GB_DEF gb_track_site_t *gb_tracker_site(gb_tracker_t *tracker, char const *file, int32_t line);
+
+// NOTE: Totals, histogram and then sites sorted by total requested bytes, at most `max_sites` of them (< 0 for all)
+GB_DEF void gb_tracker_dump(gb_tracker_t *tracker, gbFile *f, ssize_t max_sites);
+
+GB_DEF gb_allocator_t gb_tracker_allocator(gb_tracker_t *tracker);
+GB_DEF GB_ALLOCATOR_PROC(gb_tracker_allocator_proc);
+
+// NOTE: gb_alloc_at and gb_resize_at are declared in gb/alloc.h
+#define gb_alloc_here(a, size) \
+  gb_alloc_at(a, size, GB_DEFAULT_MEMORY_ALIGNMENT, GB_DEFAULT_ALLOCATOR_FLAGS, __FILE__, __LINE__)
+#define gb_alloc_uninit_here(a, size) \
+  gb_alloc_at(a, size, GB_DEFAULT_MEMORY_ALIGNMENT, 0, __FILE__, __LINE__)
+#define gb_resize_here(a, ptr, old_size, new_size) \
+  gb_resize_at(a, ptr, old_size, new_size, GB_DEFAULT_MEMORY_ALIGNMENT, GB_DEFAULT_ALLOCATOR_FLAGS, __FILE__, __LINE__)
+
+#endif /* GB_TRACK_H__ */
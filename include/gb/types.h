@@ -195,8 +195,8 @@ typedef uint8_t bool;
 # ifndef SSIZE_MIN
 #   define SSIZE_MIN INT64_MIN
 # endif
-# ifndef SSIZE_MIN
-#   define SSIZE_MIN INT64_MAX
+# ifndef SSIZE_MAX
+#   define SSIZE_MAX INT64_MAX
 # endif
 #else
 # error Unknown architecture size. This library only supports 32 bit and 64 bit architectures.
@@ -264,6 +264,17 @@ typedef uint8_t bool;
 # endif
 #endif
 
+// NOTE: Hint only, ptr may be anything (even NULL) and is never dereferenced
+#if !defined(gb_prefetch)
+# if defined(_MSC_VER)
+#   define gb_prefetch(ptr) _mm_prefetch(cast(char const *) (ptr), _MM_HINT_T0)
+# elif defined(__GNUC__)
+#   define gb_prefetch(ptr) __builtin_prefetch(ptr)
+# else
+#   define gb_prefetch(ptr) cast(void) (ptr)
+# endif
+#endif
+
 #if !defined(gb_thread_local)
 # if defined(_MSC_VER) && _MSC_VER >= 1300
 #   define gb_thread_local __declspec(thread)
@@ -311,6 +322,16 @@ extern "C++" {
 # endif
 #endif
 
+// NOTE: Alignment of the type of an expression. Without __alignof__ it falls back to the lowest set bit of
+// the size (always a multiple of the alignment) capped to 64
+#ifndef gb_align_of_expr
+# if defined(GB_COMPILER_GCC) || defined(GB_COMPILER_CLANG)
+#   define gb_align_of_expr(x) (ssize_t)__alignof__(x)
+# else
+#   define gb_align_of_expr(x) ((gb_size_of(x) & -gb_size_of(x)) < 64 ? (gb_size_of(x) & -gb_size_of(x)) : 64)
+# endif
+#endif
+
 // NOTE(bill): I do wish I had a type_of that was portable
 #ifndef gb_swap
 # define gb_swap(Type, a, b) do { Type tmp = (a); (a) = (b); (b) = tmp; } while (0)
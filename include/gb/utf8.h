@@ -40,8 +40,13 @@ GB_DEF uint16_t *gb_utf8_to_ucs2(uint16_t *buffer, ssize_t len, uint8_t const *s
 
 GB_DEF uint8_t *gb_ucs2_to_utf8(uint8_t *buffer, ssize_t len, uint16_t const *str);
 
-GB_DEF uint16_t *gb_utf8_to_ucs2_buf(uint8_t const *str);   // NOTE(bill): Uses locally persisting buffer
-GB_DEF uint8_t *gb_ucs2_to_utf8_buf(uint16_t const *str); // NOTE(bill): Uses locally persisting buffer
+#ifndef GB_UTF8_BUFFER_SIZE
+#define GB_UTF8_BUFFER_SIZE 4096
+#endif
+
+// NOTE: Converts into GB_UTF8_BUFFER_SIZE elements of the thread scratch ring, see gb_thread_scratch_allocator
+GB_DEF uint16_t *gb_utf8_to_ucs2_buf(uint8_t const *str);
+GB_DEF uint8_t *gb_ucs2_to_utf8_buf(uint16_t const *str);
 
 // NOTE(bill): Returns size of codepoint in bytes
 GB_DEF ssize_t gb_utf8_decode(uint8_t const *str, ssize_t str_len, rune_t *codepoint);
@@ -27,6 +27,7 @@
 
 #include "gb/affinity.h"
 #include "gb/alloc.h"
+#include "gb/io.h"
 
 #if defined(GB_SYSTEM_WINDOWS)
 void gb_affinity_init(gb_affinity_t *a) {
@@ -77,6 +78,17 @@ void gb_affinity_init(gb_affinity_t *a) {
     a->core_masks[0] = 1;
   }
 
+  a->node_count = 1;
+  {
+    ULONG highest;
+    UCHAR processor, node;
+    if (GetNumaHighestNodeNumber(&highest))
+      a->node_count = gb_min(cast(ssize_t) highest + 1, GB_AFFINITY_MAX_NODES);
+    for (processor = 0; processor < gb_min(GB_WIN32_MAX_THREADS, GB_AFFINITY_MAX_THREADS); processor++) {
+      if (GetNumaProcessorNode(processor, &node) && node != 0xff && node < a->node_count)
+        a->thread_nodes[processor] = node;
+    }
+  }
 }
 void gb_affinity_destroy(gb_affinity_t *a) {
   gb_unused(a);
@@ -104,14 +116,25 @@ ssize_t gb_affinity_thread_count_for_core(gb_affinity_t *a, ssize_t core) {
   return gb_count_set_bits(a->core_masks[core]);
 }
 
+int32_t gb_affinity_current_node(void) {
+  PROCESSOR_NUMBER processor;
+  USHORT node;
+  GetCurrentProcessorNumberEx(&processor);
+  if (GetNumaProcessorNodeEx(&processor, &node) && node < GB_AFFINITY_MAX_NODES)
+    return node;
+  return 0;
+}
+
 #elif defined(GB_SYSTEM_OSX)
 void gb_affinity_init(gb_affinity_t *a) {
   size_t count, count_size = gb_size_of(count);
 
+  gb_zero_item(a);
   a->is_accurate      = false;
   a->thread_count     = 1;
   a->core_count       = 1;
   a->threads_per_core = 1;
+  a->node_count       = 1;
 
   if (sysctlbyname("hw.logicalcpu", &count, &count_size, NULL, 0) == 0) {
     if (count > 0) {
@@ -157,16 +180,74 @@ ssize_t gb_affinity_thread_count_for_core(gb_affinity_t *a, ssize_t core) {
   return a->threads_per_core;
 }
 
+gb_inline int32_t gb_affinity_current_node(void) {
+  return 0;
+}
+
 #elif defined(GB_SYSTEM_LINUX)
 // IMPORTANT TODO(bill): This gb_affinity_t stuff for linux needs be improved a lot!
 // NOTE(zangent): I have to read /proc/cpuinfo to get the number of threads per core.
 #include <stdio.h>
+#include <sys/syscall.h>
+
+// NOTE: Reads a sysfs list such as "0-3,8-11\n" into a bit per entry, returns the highest entry + 1
+gb_internal ssize_t gb__affinity_read_list(char const *path, uint8_t *bits, ssize_t max_count) {
+  char buf[1024], *p;
+  ssize_t end = 0;
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL)
+    return 0;
+  p = fgets(buf, gb_size_of(buf), fp);
+  fclose(fp);
+
+  while (p && *p >= '0' && *p <= '9') {
+    ssize_t first = 0, last, i;
+    while (*p >= '0' && *p <= '9')
+      first = first * 10 + (*p++ - '0');
+    last = first;
+    if (*p == '-') {
+      last = 0;
+      for (p++; *p >= '0' && *p <= '9'; p++)
+        last = last * 10 + (*p - '0');
+    }
+    for (i = first; i <= last && i < max_count; i++)
+      bits[i / 8] |= cast(uint8_t) (1 << (i % 8));
+    end = gb_max(end, gb_min(last + 1, max_count));
+    if (*p == ',')
+      p++;
+  }
+  return end;
+}
+
+gb_internal void gb__affinity_init_nodes(gb_affinity_t *a) {
+  uint8_t nodes[(GB_AFFINITY_MAX_NODES + 7) / 8] = {0};
+  ssize_t node, node_end, cpu;
+
+  a->node_count = 1;
+  node_end = gb__affinity_read_list("/sys/devices/system/node/online", nodes, GB_AFFINITY_MAX_NODES);
+  for (node = 0; node < node_end; node++) {
+    uint8_t cpus[(GB_AFFINITY_MAX_THREADS + 7) / 8] = {0};
+    char path[64];
+    ssize_t cpu_end;
+    if ((nodes[node / 8] & (1 << (node % 8))) == 0)
+      continue;
+    gb_snprintf(path, gb_size_of(path), "/sys/devices/system/node/node%td/cpulist", node);
+    cpu_end = gb__affinity_read_list(path, cpus, GB_AFFINITY_MAX_THREADS);
+    for (cpu = 0; cpu < cpu_end; cpu++) {
+      if (cpus[cpu / 8] & (1 << (cpu % 8)))
+        a->thread_nodes[cpu] = cast(uint8_t) node;
+    }
+    a->node_count = node + 1;
+  }
+}
 
 void gb_affinity_init(gb_affinity_t *a) {
   byte32_t accurate = true;
   ssize_t threads = 0;
   FILE *fp;
 
+  gb_zero_item(a);
+  gb__affinity_init_nodes(a);
   a->thread_count = 1;
   a->core_count = sysconf(_SC_NPROCESSORS_ONLN);
   a->threads_per_core = 1;
@@ -237,6 +318,19 @@ ssize_t gb_affinity_thread_count_for_core(gb_affinity_t *a, ssize_t core) {
   return a->threads_per_core;
 }
 
+int32_t gb_affinity_current_node(void) {
+  unsigned int cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0 && node < GB_AFFINITY_MAX_NODES)
+    return cast(int32_t) node;
+  return 0;
+}
+
 #else
 #error TODO(bill): Unknown system
 #endif
+
+int32_t gb_affinity_node_of_thread(gb_affinity_t *a, ssize_t logical_processor) {
+  if (logical_processor < 0 || logical_processor >= GB_AFFINITY_MAX_THREADS)
+    return 0;
+  return a->thread_nodes[logical_processor];
+}
@@ -29,12 +29,24 @@
 #include "gb/string.h"
 #include "gb/io.h"
 
+#if defined(GB_SYSTEM_LINUX)
+#include <sys/syscall.h>
+#endif
+
 gb_inline void *gb_alloc_align(gb_allocator_t a, ssize_t size, ssize_t alignment) {
   return a.proc(a.data, gbAllocation_Alloc, size, alignment, NULL, 0, GB_DEFAULT_ALLOCATOR_FLAGS);
 }
 
+gb_inline void *gb_alloc_align_flags(gb_allocator_t a, ssize_t size, ssize_t alignment, uint64_t flags) {
+  return a.proc(a.data, gbAllocation_Alloc, size, alignment, NULL, 0, flags);
+}
+
 gb_inline void *gb_alloc(gb_allocator_t a, ssize_t size) { return gb_alloc_align(a, size, GB_DEFAULT_MEMORY_ALIGNMENT); }
 
+gb_inline void *gb_alloc_uninit(gb_allocator_t a, ssize_t size) {
+  return gb_alloc_align_flags(a, size, GB_DEFAULT_MEMORY_ALIGNMENT, GB_DEFAULT_ALLOCATOR_FLAGS & ~gbAllocatorFlag_ClearToZero);
+}
+
 gb_inline void gb_free(gb_allocator_t a, void *ptr) {
   if (ptr != NULL)
     a.proc(a.data, gbAllocation_Free, 0, 0, ptr, 0, GB_DEFAULT_ALLOCATOR_FLAGS);
@@ -52,12 +64,21 @@ gb_inline void *gb_resize_align(gb_allocator_t a, void *ptr, ssize_t old_size, s
   return a.proc(a.data, gbAllocation_Resize, new_size, alignment, ptr, old_size, GB_DEFAULT_ALLOCATOR_FLAGS);
 }
 
+gb_inline void *gb_resize_align_flags(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags) {
+  return a.proc(a.data, gbAllocation_Resize, new_size, alignment, ptr, old_size, flags);
+}
+
+// NOTE: Returns the block itself, gb_memcopy may hand back the end of the copy (rep movsb)
 gb_inline void *gb_alloc_copy(gb_allocator_t a, void const *src, ssize_t size) {
-  return gb_memcopy(gb_alloc(a, size), src, size);
+  void *ptr = gb_alloc_uninit(a, size);
+  if (ptr) gb_memcopy(ptr, src, size);
+  return ptr;
 }
 
 gb_inline void *gb_alloc_copy_align(gb_allocator_t a, void const *src, ssize_t size, ssize_t alignment) {
-  return gb_memcopy(gb_alloc_align(a, size, alignment), src, size);
+  void *ptr = gb_alloc_align_flags(a, size, alignment, GB_DEFAULT_ALLOCATOR_FLAGS & ~gbAllocatorFlag_ClearToZero);
+  if (ptr) gb_memcopy(ptr, src, size);
+  return ptr;
 }
 
 gb_inline char *gb_alloc_str(gb_allocator_t a, char const *str) {
@@ -73,7 +94,12 @@ gb_inline char *gb_alloc_str_len(gb_allocator_t a, char const *str, ssize_t len)
 
 gb_inline void *
 gb_default_resize_align(gb_allocator_t a, void *old_memory, ssize_t old_size, ssize_t new_size, ssize_t alignment) {
-  if (!old_memory) return gb_alloc_align(a, new_size, alignment);
+  return gb_default_resize_align_flags(a, old_memory, old_size, new_size, alignment, GB_DEFAULT_ALLOCATOR_FLAGS);
+}
+
+void *
+gb_default_resize_align_flags(gb_allocator_t a, void *old_memory, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags) {
+  if (!old_memory) return gb_alloc_align_flags(a, new_size, alignment, flags);
 
   if (new_size == 0) {
     gb_free(a, old_memory);
@@ -86,9 +112,12 @@ gb_default_resize_align(gb_allocator_t a, void *old_memory, ssize_t old_size, ss
   if (old_size == new_size) {
     return old_memory;
   } else {
-    void *new_memory = gb_alloc_align(a, new_size, alignment);
+    // NOTE: Only the tail past the copy needs clearing
+    void *new_memory = gb_alloc_align_flags(a, new_size, alignment, flags & ~gbAllocatorFlag_ClearToZero);
     if (!new_memory) return NULL;
     gb_memmove(new_memory, old_memory, gb_min(new_size, old_size));
+    if (flags & gbAllocatorFlag_ClearToZero)
+      gb_zero_size(gb_pointer_add(new_memory, old_size), new_size - old_size);
     gb_free(a, old_memory);
     return new_memory;
   }
@@ -101,10 +130,16 @@ gb_inline gb_allocator_t gb_heap_allocator(void) {
   return a;
 }
 
-GB_ALLOCATOR_PROC(gb_heap_allocator_proc) {
+gb_inline gb_allocator_t gb_malloc_allocator(void) {
+  gb_allocator_t a;
+  a.proc = gb_malloc_allocator_proc;
+  a.data = NULL;
+  return a;
+}
+
+GB_ALLOCATOR_PROC(gb_malloc_allocator_proc) {
   void *ptr = NULL;
   gb_unused(allocator_data);
-  gb_unused(old_size);
 // TODO(bill): Throughly test!
   switch (type) {
 #if defined(GB_COMPILER_MSVC)
@@ -118,14 +153,19 @@ GB_ALLOCATOR_PROC(gb_heap_allocator_proc) {
     break;
   case gbAllocation_Resize:
     ptr = _aligned_realloc(old_memory, size, alignment);
+    if (ptr && size > old_size && (flags & gbAllocatorFlag_ClearToZero))
+      gb_zero_size(gb_pointer_add(ptr, old_size), size - old_size);
     break;
 #else
-    // TODO(bill): *nix version that's decent
     case gbAllocation_Alloc: {
-      posix_memalign(&ptr, alignment, size);
-
-      if (flags & gbAllocatorFlag_ClearToZero) {
-        gb_zero_size(ptr, size);
+      // NOTE: calloc can hand out fresh pages without touching them
+      if ((flags & gbAllocatorFlag_ClearToZero) && alignment <= GB_DEFAULT_MEMORY_ALIGNMENT) {
+        ptr = calloc(1, size);
+      } else {
+        if (posix_memalign(&ptr, gb_max(alignment, gb_size_of(void *)), size) != 0)
+          ptr = NULL;
+        if (ptr && (flags & gbAllocatorFlag_ClearToZero))
+          gb_zero_size(ptr, size);
       }
     }
       break;
@@ -136,8 +176,15 @@ GB_ALLOCATOR_PROC(gb_heap_allocator_proc) {
       break;
 
     case gbAllocation_Resize: {
-      gb_allocator_t a = gb_heap_allocator();
-      ptr = gb_default_resize_align(a, old_memory, old_size, size, alignment);
+      // NOTE: realloc only keeps the alignment malloc gives, it can also grow in place or remap huge blocks
+      if (old_memory && size > 0 && alignment <= GB_DEFAULT_MEMORY_ALIGNMENT) {
+        ptr = realloc(old_memory, size);
+        if (ptr && size > old_size && (flags & gbAllocatorFlag_ClearToZero))
+          gb_zero_size(gb_pointer_add(ptr, old_size), size - old_size);
+      } else {
+        gb_allocator_t a = gb_malloc_allocator();
+        ptr = gb_default_resize_align_flags(a, old_memory, old_size, size, alignment, flags);
+      }
     }
       break;
 #endif
@@ -156,6 +203,14 @@ gb_virtual_memory_t gb_virtual_memory(void *data, ssize_t size) {
   return vm;
 }
 
+// NOTE: Faults every page in by writing to it, the pages are fresh so writing zero keeps them zero
+gb_internal void gb__vm_touch(gb_virtual_memory_t vm) {
+  ssize_t page_size = gb_virtual_memory_page_size(NULL);
+  ssize_t offset;
+  for (offset = 0; offset < vm.size; offset += page_size)
+    *(cast(uint8_t volatile *) vm.data + offset) = 0;
+}
+
 #if defined(GB_SYSTEM_WINDOWS)
 gb_inline gb_virtual_memory_t gb_vm_alloc(void *addr, ssize_t size) {
   gb_virtual_memory_t vm;
@@ -172,7 +227,7 @@ gb_inline byte32_t gb_vm_free(gb_virtual_memory_t vm) {
       return false;
     if (info.BaseAddress != vm.data ||
         info.AllocationBase != vm.data ||
-        info.State != MEM_COMMIT || info.RegionSize > cast(size_t)vm.size) {
+        (info.State != MEM_COMMIT && info.State != MEM_RESERVE) || info.RegionSize > cast(size_t)vm.size) {
       return false;
     }
     if (VirtualFree(vm.data, 0, MEM_RELEASE) == 0)
@@ -212,6 +267,53 @@ ssize_t gb_virtual_memory_page_size(ssize_t *alignment_out) {
   return info.dwPageSize;
 }
 
+gb_inline gb_virtual_memory_t gb_vm_reserve(void *addr, ssize_t size) {
+  gb_virtual_memory_t vm;
+  GB_ASSERT(size > 0);
+  vm.data = VirtualAlloc(addr, size, MEM_RESERVE, PAGE_NOACCESS);
+  vm.size = size;
+  return vm;
+}
+
+gb_inline byte32_t gb_vm_commit(gb_virtual_memory_t vm) {
+  return VirtualAlloc(vm.data, vm.size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+gb_inline byte32_t gb_vm_decommit(gb_virtual_memory_t vm) {
+  return VirtualFree(vm.data, vm.size, MEM_DECOMMIT) != 0;
+}
+
+gb_virtual_memory_t gb_vm_alloc_ex(void *addr, ssize_t size, uint32_t flags, int32_t numa_node) {
+  gb_virtual_memory_t vm = {0};
+  DWORD type = MEM_COMMIT | MEM_RESERVE;
+  GB_ASSERT(size > 0);
+
+  // NOTE: Large pages need SeLockMemoryPrivilege, plain pages are used when they cannot be had
+  if (flags & gbVmFlag_HugePages) {
+    ssize_t large_page = cast(ssize_t) GetLargePageMinimum();
+    if (large_page > 0) {
+      ssize_t large_size = (size + large_page - 1) & ~(large_page - 1);
+      if (numa_node >= 0)
+        vm.data = VirtualAllocExNuma(GetCurrentProcess(), addr, large_size, type | MEM_LARGE_PAGES, PAGE_READWRITE, numa_node);
+      else
+        vm.data = VirtualAlloc(addr, large_size, type | MEM_LARGE_PAGES, PAGE_READWRITE);
+      if (vm.data) {
+        vm.size = large_size;
+        return vm; // NOTE: Large pages are always resident
+      }
+    }
+  }
+
+  if (numa_node >= 0)
+    vm.data = VirtualAllocExNuma(GetCurrentProcess(), addr, size, type, PAGE_READWRITE, numa_node);
+  else
+    vm.data = VirtualAlloc(addr, size, type, PAGE_READWRITE);
+  vm.size = size;
+  if (vm.data && (flags & gbVmFlag_Populate))
+    gb__vm_touch(vm);
+  return vm;
+}
+
 #else
 
 #ifndef MAP_ANONYMOUS
@@ -222,6 +324,8 @@ gb_inline gb_virtual_memory_t gb_vm_alloc(void *addr, ssize_t size) {
   gb_virtual_memory_t vm;
   GB_ASSERT(size > 0);
   vm.data = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (vm.data == MAP_FAILED)
+    vm.data = NULL; // NOTE: Same as VirtualAlloc
   vm.size = size;
   return vm;
 }
@@ -242,7 +346,7 @@ gb_inline gb_virtual_memory_t gb_vm_trim(gb_virtual_memory_t vm, ssize_t lead_si
   if (lead_size != 0)
     gb_vm_free(gb_virtual_memory(vm.data, lead_size));
   if (trail_size != 0)
-    gb_vm_free(gb_virtual_memory(ptr, trail_size));
+    gb_vm_free(gb_virtual_memory(gb_pointer_add(ptr, size), trail_size));
   return gb_virtual_memory(ptr, size);
 
 }
@@ -259,6 +363,104 @@ ssize_t gb_virtual_memory_page_size(ssize_t *alignment_out) {
   return result;
 }
 
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+gb_inline gb_virtual_memory_t gb_vm_reserve(void *addr, ssize_t size) {
+  gb_virtual_memory_t vm;
+  GB_ASSERT(size > 0);
+  vm.data = mmap(addr, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+  if (vm.data == MAP_FAILED)
+    vm.data = NULL;
+  vm.size = size;
+  return vm;
+}
+
+gb_inline byte32_t gb_vm_commit(gb_virtual_memory_t vm) {
+  return mprotect(vm.data, vm.size, PROT_READ | PROT_WRITE) == 0;
+}
+
+gb_inline byte32_t gb_vm_decommit(gb_virtual_memory_t vm) {
+  gb_vm_purge(vm);
+  return mprotect(vm.data, vm.size, PROT_NONE) == 0;
+}
+
+#if defined(GB_SYSTEM_LINUX)
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+gb_internal byte32_t gb__vm_bind(gb_virtual_memory_t vm, int32_t numa_node) {
+  unsigned long mask[1024 / (8 * gb_size_of(unsigned long))] = {0};
+  if (numa_node < 0 || numa_node >= 1024)
+    return false;
+  mask[numa_node / (8 * gb_size_of(unsigned long))] |= 1ul << (numa_node % (8 * gb_size_of(unsigned long)));
+  return syscall(SYS_mbind, vm.data, vm.size, MPOL_BIND, mask, 1024, 0) == 0;
+}
+#endif
+
+gb_virtual_memory_t gb_vm_alloc_ex(void *addr, ssize_t size, uint32_t flags, int32_t numa_node) {
+  gb_virtual_memory_t vm = {0};
+  int map_flags = MAP_ANONYMOUS | MAP_PRIVATE;
+#if defined(GB_SYSTEM_LINUX)
+  byte32_t populated = false;
+#endif
+  GB_ASSERT(size > 0);
+
+#if defined(GB_SYSTEM_LINUX)
+  // NOTE: Pages must be bound before they are first touched, populate afterwards in that case
+  if ((flags & gbVmFlag_Populate) && numa_node < 0)
+    map_flags |= MAP_POPULATE;
+
+  if (flags & gbVmFlag_HugePages) {
+    ssize_t huge_size = (size + GB_VM_HUGE_PAGE_SIZE - 1) & ~(GB_VM_HUGE_PAGE_SIZE - 1);
+    vm.data = mmap(addr, huge_size, PROT_READ | PROT_WRITE, map_flags | MAP_HUGETLB, -1, 0);
+    if (vm.data != MAP_FAILED) {
+      vm.size = huge_size;
+      if (numa_node >= 0) {
+        gb__vm_bind(vm, numa_node);
+        if (flags & gbVmFlag_Populate)
+          gb__vm_touch(vm);
+      }
+      return vm;
+    }
+    // NOTE: No huge page pool reserved, fall back to transparent huge pages
+    flags |= gbVmFlag_TransparentHugePages;
+  }
+
+  if (flags & gbVmFlag_TransparentHugePages) {
+    ssize_t huge_size = (size + GB_VM_HUGE_PAGE_SIZE - 1) & ~(GB_VM_HUGE_PAGE_SIZE - 1);
+    vm.data = mmap(addr, huge_size + GB_VM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, map_flags & ~MAP_POPULATE, -1, 0);
+    if (vm.data == MAP_FAILED)
+      return gb_virtual_memory(NULL, size);
+    vm.size = huge_size + GB_VM_HUGE_PAGE_SIZE;
+    vm = gb_vm_trim(vm, gb_pointer_diff(vm.data, gb_align_forward(vm.data, GB_VM_HUGE_PAGE_SIZE)), huge_size);
+    madvise(vm.data, vm.size, MADV_HUGEPAGE);
+  } else {
+    vm.data = mmap(addr, size, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+    if (vm.data == MAP_FAILED)
+      return gb_virtual_memory(NULL, size);
+    vm.size = size;
+    populated = (map_flags & MAP_POPULATE) != 0;
+  }
+
+  if (numa_node >= 0)
+    gb__vm_bind(vm, numa_node);
+  if ((flags & gbVmFlag_Populate) && !populated)
+    gb__vm_touch(vm);
+#else
+  gb_unused(numa_node);
+  vm.data = mmap(addr, size, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+  if (vm.data == MAP_FAILED)
+    return gb_virtual_memory(NULL, size);
+  vm.size = size;
+  if (flags & gbVmFlag_Populate)
+    gb__vm_touch(vm);
+#endif
+  return vm;
+}
+
 #endif
 
 
@@ -282,22 +484,109 @@ gb_inline void gb_arena_init_from_memory(gb_arena_t *arena, void *start, ssize_t
   arena->total_size = size;
   arena->total_allocated = 0;
   arena->temp_count = 0;
+  arena->total_committed = size;
+  arena->total_dirty = size;
+  arena->is_virtual = false;
+  arena->vm = gb_virtual_memory(NULL, 0);
+  arena->is_concurrent = false;
+  gb_atomic64_store(&arena->offset, 0);
+  arena->generation = 0;
+  gb_atomic32_store(&arena->commit_lock, 0);
 }
 
 gb_inline void gb_arena_init_from_allocator(gb_arena_t *arena, gb_allocator_t backing, ssize_t size) {
   arena->backing = backing;
-  arena->physical_start = gb_alloc(backing, size); // NOTE(bill): Uses default alignment
+  arena->physical_start = gb_alloc_uninit(backing, size); // NOTE(bill): Uses default alignment
   arena->total_size = size;
   arena->total_allocated = 0;
   arena->temp_count = 0;
+  arena->total_committed = size;
+  arena->total_dirty = size;
+  arena->is_virtual = false;
+  arena->vm = gb_virtual_memory(NULL, 0);
+  arena->is_concurrent = false;
+  gb_atomic64_store(&arena->offset, 0);
+  arena->generation = 0;
+  gb_atomic32_store(&arena->commit_lock, 0);
 }
 
 gb_inline void gb_arena_init_sub(gb_arena_t *arena, gb_arena_t *parent_arena, ssize_t size) {
   gb_arena_init_from_allocator(arena, gb_arena_allocator(parent_arena), size);
 }
 
+void gb_arena_init_from_vm(gb_arena_t *arena, ssize_t size, uint32_t vm_flags, int32_t numa_node) {
+  gb_virtual_memory_t vm = gb_vm_alloc_ex(NULL, size, vm_flags, numa_node);
+  gb_arena_init_from_memory(arena, vm.data, vm.data ? vm.size : 0);
+  arena->total_dirty = 0;
+  arena->vm = vm;
+}
+
+void gb_arena_init_virtual(gb_arena_t *arena, ssize_t reserve_size) {
+  ssize_t page_size = gb_virtual_memory_page_size(NULL);
+  gb_virtual_memory_t vm;
+
+  reserve_size = (reserve_size + GB_ARENA_COMMIT_SIZE - 1) & ~(GB_ARENA_COMMIT_SIZE - 1);
+  GB_ASSERT(GB_ARENA_COMMIT_SIZE % page_size == 0);
+  vm = gb_vm_reserve(NULL, reserve_size);
+
+  gb_arena_init_from_memory(arena, vm.data, vm.data ? reserve_size : 0);
+  arena->total_committed = 0;
+  arena->total_dirty = 0;
+  arena->is_virtual = true;
+}
+
+// NOTE: Commits whole GB_ARENA_COMMIT_SIZE chunks until `size` bytes are usable
+gb_internal byte32_t gb__arena_commit(gb_arena_t *arena, ssize_t size) {
+  ssize_t new_committed = (size + GB_ARENA_COMMIT_SIZE - 1) & ~(GB_ARENA_COMMIT_SIZE - 1);
+  gb_virtual_memory_t vm;
+
+  new_committed = gb_min(new_committed, arena->total_size);
+  vm.data = gb_pointer_add(arena->physical_start, arena->total_committed);
+  vm.size = new_committed - arena->total_committed;
+  if (!gb_vm_commit(vm))
+    return false;
+  arena->total_committed = new_committed;
+  return true;
+}
+
+// NOTE: Gives back the pages above the current allocation, one chunk is kept to avoid commit thrashing
+gb_internal void gb__arena_decommit(gb_arena_t *arena) {
+  ssize_t keep = (arena->total_allocated + 2 * GB_ARENA_COMMIT_SIZE - 1) & ~(GB_ARENA_COMMIT_SIZE - 1);
+  gb_virtual_memory_t vm;
+
+  if (keep >= arena->total_committed)
+    return;
+  vm.data = gb_pointer_add(arena->physical_start, keep);
+  vm.size = arena->total_committed - keep;
+  gb_vm_decommit(vm);
+  arena->total_committed = keep;
+  arena->total_dirty = gb_min(arena->total_dirty, keep);
+}
+
+// NOTE: Clears [offset, offset + size) skipping the part that was never handed out since it was committed
+gb_internal gb_inline void gb__arena_zero(gb_arena_t *arena, ssize_t offset, ssize_t size) {
+  ssize_t end = offset + size;
+  if (offset < arena->total_dirty)
+    gb_zero_size(gb_pointer_add(arena->physical_start, offset), gb_min(end, arena->total_dirty) - offset);
+  if (end > arena->total_dirty)
+    arena->total_dirty = end;
+}
+
 gb_inline void gb_arena_free(gb_arena_t *arena) {
-  if (arena->backing.proc) {
+  if (arena->is_virtual) {
+    if (arena->physical_start) {
+      // NOTE: Leaves a single reserved region behind which is what gb_vm_free expects on Windows
+      if (arena->total_committed > 0)
+        gb_vm_decommit(gb_virtual_memory(arena->physical_start, arena->total_committed));
+      gb_vm_free(gb_virtual_memory(arena->physical_start, arena->total_size));
+    }
+    arena->physical_start = NULL;
+    arena->total_committed = 0;
+  } else if (arena->vm.data) {
+    gb_vm_free(arena->vm);
+    arena->vm = gb_virtual_memory(NULL, 0);
+    arena->physical_start = NULL;
+  } else if (arena->backing.proc) {
     gb_free(arena->backing, arena->physical_start);
     arena->physical_start = NULL;
   }
@@ -317,12 +606,117 @@ gb_inline ssize_t gb_arena_alignment_of(gb_arena_t *arena, ssize_t alignment) {
 }
 
 gb_inline ssize_t gb_arena_size_remaining(gb_arena_t *arena, ssize_t alignment) {
-  ssize_t result = arena->total_size - (arena->total_allocated + gb_arena_alignment_of(arena, alignment));
+  ssize_t result;
+  if (arena->is_concurrent)
+    return gb_max(arena->total_size - cast(ssize_t) gb_atomic64_load(&arena->offset), 0);
+  result = arena->total_size - (arena->total_allocated + gb_arena_alignment_of(arena, alignment));
   return result;
 }
 
 gb_inline void gb_arena_check(gb_arena_t *arena) { GB_ASSERT(arena->temp_count == 0); }
 
+//
+// Concurrent Arena
+//
+
+typedef struct gb__arena_chunk {
+  gb_arena_t *arena;
+  int64_t generation;
+  ssize_t offset;
+  ssize_t end;
+} gb__arena_chunk_t;
+
+// NOTE: Chunk of the concurrent arena the thread allocated from last
+gb_global gb_thread_local gb__arena_chunk_t gb__arena_chunk = {0};
+
+// NOTE: Shared by every arena so a new arena at the address of an old one never matches a stale chunk
+gb_global gbAtomic64 gb__arena_generation = {0};
+
+// NOTE: Brings the plain counters up to date, only between parallel phases
+gb_internal void gb__arena_sync(gb_arena_t *arena) {
+  ssize_t offset = gb_min(cast(ssize_t) gb_atomic64_load(&arena->offset), arena->total_size);
+  if (offset > arena->total_dirty)
+    arena->total_dirty = offset;
+  arena->total_allocated = offset;
+}
+
+gb_internal void gb__arena_rewind(gb_arena_t *arena, ssize_t offset) {
+  gb__arena_sync(arena);
+  arena->total_allocated = offset;
+  gb_atomic64_store(&arena->offset, offset);
+  arena->generation = gb_atomic64_fetch_add(&gb__arena_generation, 1) + 1;
+}
+
+void gb_arena_set_concurrent(gb_arena_t *arena, byte32_t concurrent) {
+  if (arena->is_concurrent == !!concurrent)
+    return;
+  if (concurrent)
+    gb__arena_rewind(arena, arena->total_allocated);
+  else
+    gb__arena_sync(arena);
+  arena->is_concurrent = !!concurrent;
+}
+
+// NOTE: Returns the offset of `size` fresh bytes or -1
+gb_internal ssize_t gb__arena_reserve(gb_arena_t *arena, ssize_t size) {
+  ssize_t offset = cast(ssize_t) gb_atomic64_fetch_add(&arena->offset, size);
+
+  if (offset + size > arena->total_size) {
+    gb_printf_err("Arena out of memory\n");
+    return -1;
+  }
+  if (arena->is_virtual) {
+    byte32_t ok = true;
+    while (!gb_atomic32_spin_lock(&arena->commit_lock, 64))
+      gb_yield();
+    if (offset + size > arena->total_committed)
+      ok = gb__arena_commit(arena, offset + size);
+    gb_atomic32_spin_unlock(&arena->commit_lock);
+    if (!ok) {
+      gb_printf_err("Arena failed to commit memory\n");
+      return -1;
+    }
+  }
+  return offset;
+}
+
+gb_internal void *gb__arena_concurrent_alloc(gb_arena_t *arena, ssize_t size, ssize_t alignment, uint64_t flags) {
+  gb__arena_chunk_t *chunk = &gb__arena_chunk;
+  ssize_t offset, end;
+  void *ptr;
+
+  if (size + alignment <= GB_ARENA_CHUNK_SIZE / 8) {
+    ptr = NULL;
+    if (chunk->arena == arena && chunk->generation == arena->generation) {
+      ptr = gb_align_forward(gb_pointer_add(arena->physical_start, chunk->offset), alignment);
+      if (gb_pointer_diff(arena->physical_start, ptr) + size > chunk->end)
+        ptr = NULL;
+    }
+    if (!ptr) {
+      offset = gb__arena_reserve(arena, GB_ARENA_CHUNK_SIZE);
+      if (offset < 0)
+        return NULL;
+      chunk->arena = arena;
+      chunk->generation = arena->generation;
+      chunk->end = offset + GB_ARENA_CHUNK_SIZE;
+      ptr = gb_align_forward(gb_pointer_add(arena->physical_start, offset), alignment);
+    }
+    chunk->offset = gb_pointer_diff(arena->physical_start, ptr) + size;
+  } else {
+    offset = gb__arena_reserve(arena, size + alignment - 1);
+    if (offset < 0)
+      return NULL;
+    ptr = gb_align_forward(gb_pointer_add(arena->physical_start, offset), alignment);
+  }
+
+  // NOTE: total_dirty only moves between phases, so it is safe to read here
+  offset = gb_pointer_diff(arena->physical_start, ptr);
+  end = gb_min(offset + size, arena->total_dirty);
+  if ((flags & gbAllocatorFlag_ClearToZero) && offset < end)
+    gb_zero_size(ptr, end - offset);
+  return ptr;
+}
+
 gb_inline gb_allocator_t gb_arena_allocator(gb_arena_t *arena) {
   gb_allocator_t allocator;
   allocator.proc = gb_arena_allocator_proc;
@@ -334,12 +728,25 @@ GB_ALLOCATOR_PROC(gb_arena_allocator_proc) {
   gb_arena_t *arena = cast(gb_arena_t *) allocator_data;
   void *ptr = NULL;
 
-  gb_unused(old_size);
+  if (arena->is_concurrent) {
+    switch (type) {
+      case gbAllocation_Alloc:
+        return gb__arena_concurrent_alloc(arena, size, alignment, flags);
+      case gbAllocation_FreeAll:
+        gb__arena_rewind(arena, 0);
+        if (arena->is_virtual)
+          gb__arena_decommit(arena);
+        return NULL;
+      case gbAllocation_Resize:
+        return gb_default_resize_align_flags(gb_arena_allocator(arena), old_memory, old_size, size, alignment, flags);
+      default:
+        return NULL;
+    }
+  }
 
   switch (type) {
     case gbAllocation_Alloc: {
-      void *end = gb_pointer_add(arena->physical_start, arena->total_allocated);
-      ssize_t total_size = size + alignment;
+      ssize_t total_size = gb_arena_alignment_of(arena, alignment) + size;
 
       // NOTE(bill): Out of memory
       if (arena->total_allocated + total_size > cast(ssize_t) arena->total_size) {
@@ -347,10 +754,19 @@ GB_ALLOCATOR_PROC(gb_arena_allocator_proc) {
         return NULL;
       }
 
-      ptr = gb_align_forward(end, alignment);
-      arena->total_allocated += total_size;
+      if (arena->is_virtual && arena->total_allocated + total_size > arena->total_committed) {
+        if (!gb__arena_commit(arena, arena->total_allocated + total_size)) {
+          gb_printf_err("Arena failed to commit memory\n");
+          return NULL;
+        }
+      }
+
+      ptr = gb_pointer_add(arena->physical_start, arena->total_allocated + total_size - size);
       if (flags & gbAllocatorFlag_ClearToZero)
-        gb_zero_size(ptr, size);
+        gb__arena_zero(arena, arena->total_allocated + total_size - size, size);
+      else if (arena->total_allocated + total_size > arena->total_dirty)
+        arena->total_dirty = arena->total_allocated + total_size;
+      arena->total_allocated += total_size;
     }
       break;
 
@@ -361,12 +777,29 @@ GB_ALLOCATOR_PROC(gb_arena_allocator_proc) {
 
     case gbAllocation_FreeAll:
       arena->total_allocated = 0;
+      if (arena->is_virtual)
+        gb__arena_decommit(arena);
       break;
 
     case gbAllocation_Resize: {
-      // TODO(bill): Check if ptr is on top of stack and just extend
       gb_allocator_t a = gb_arena_allocator(arena);
-      ptr = gb_default_resize_align(a, old_memory, old_size, size, alignment);
+      void *end = gb_pointer_add(arena->physical_start, arena->total_allocated);
+
+      // NOTE: The last allocation grows in place when there is room
+      if (old_memory && size > old_size && gb_pointer_add(old_memory, old_size) == end &&
+          (cast(uintptr_t) old_memory & (alignment - 1)) == 0) {
+        ssize_t total_allocated = gb_pointer_diff(arena->physical_start, old_memory) + size;
+        if (total_allocated <= arena->total_size &&
+            (!arena->is_virtual || total_allocated <= arena->total_committed || gb__arena_commit(arena, total_allocated))) {
+          if (flags & gbAllocatorFlag_ClearToZero)
+            gb__arena_zero(arena, arena->total_allocated, size - old_size);
+          else if (total_allocated > arena->total_dirty)
+            arena->total_dirty = total_allocated;
+          arena->total_allocated = total_allocated;
+          return old_memory;
+        }
+      }
+      ptr = gb_default_resize_align_flags(a, old_memory, old_size, size, alignment, flags);
     }
       break;
   }
@@ -376,48 +809,179 @@ GB_ALLOCATOR_PROC(gb_arena_allocator_proc) {
 gb_inline gb_temp_arena_memory_t gb_temp_arena_memory_begin(gb_arena_t *arena) {
   gb_temp_arena_memory_t tmp;
   tmp.arena = arena;
+  if (arena->is_concurrent)
+    gb__arena_sync(arena);
   tmp.original_count = arena->total_allocated;
   arena->temp_count++;
   return tmp;
 }
 
 gb_inline void gb_temp_arena_memory_end(gb_temp_arena_memory_t tmp) {
+  if (tmp.arena->is_concurrent)
+    gb__arena_sync(tmp.arena);
   GB_ASSERT(tmp.arena->total_allocated >= tmp.original_count);
   GB_ASSERT(tmp.arena->temp_count > 0);
+  if (tmp.arena->is_concurrent)
+    gb__arena_rewind(tmp.arena, tmp.original_count);
   tmp.arena->total_allocated = tmp.original_count;
   tmp.arena->temp_count--;
+  if (tmp.arena->is_virtual)
+    gb__arena_decommit(tmp.arena);
+}
+
+
+
+
+//
+// NUMA Arena
+//
+
+gb_global gb_thread_local int32_t gb__numa_node;
+gb_global gb_thread_local int32_t gb__numa_node_countdown;
+
+void gb_numa_arena_init(gb_numa_arena_t *na, gb_affinity_t *affinity, ssize_t size_per_node, uint32_t vm_flags) {
+  ssize_t i;
+  gb_zero_item(na);
+  na->node_count = gb_clamp(affinity->node_count, 1, GB_AFFINITY_MAX_NODES);
+  for (i = 0; i < na->node_count; i++) {
+    gb_arena_init_from_vm(&na->arenas[i], size_per_node, vm_flags, na->node_count > 1 ? cast(int32_t) i : GB_VM_NUMA_ANY);
+    GB_ASSERT_MSG(na->arenas[i].physical_start != NULL, "Unable to map the arena of node %td", i);
+    gb_arena_set_concurrent(&na->arenas[i], true);
+  }
+}
+
+void gb_numa_arena_free(gb_numa_arena_t *na) {
+  ssize_t i;
+  for (i = 0; i < na->node_count; i++) {
+    gb_arena_set_concurrent(&na->arenas[i], false);
+    gb_arena_free(&na->arenas[i]);
+  }
+  na->node_count = 0;
+}
+
+gb_inline gb_arena_t *gb_numa_arena_local(gb_numa_arena_t *na) {
+  if (--gb__numa_node_countdown < 0) {
+    gb__numa_node = gb_affinity_current_node();
+    gb__numa_node_countdown = GB_NUMA_NODE_REFRESH;
+  }
+  return &na->arenas[gb__numa_node < na->node_count ? gb__numa_node : 0];
+}
+
+gb_inline gb_allocator_t gb_numa_arena_allocator(gb_numa_arena_t *na) {
+  gb_allocator_t allocator;
+  allocator.proc = gb_numa_arena_allocator_proc;
+  allocator.data = na;
+  return allocator;
 }
 
+GB_ALLOCATOR_PROC(gb_numa_arena_allocator_proc) {
+  gb_numa_arena_t *na = cast(gb_numa_arena_t *) allocator_data;
+  void *ptr = NULL;
+  ssize_t i;
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb_arena_allocator_proc(gb_numa_arena_local(na), type, size, alignment, old_memory, old_size, flags);
+      break;
+
+    case gbAllocation_Free:
+      break;
+
+    case gbAllocation_FreeAll:
+      for (i = 0; i < na->node_count; i++)
+        gb_arena_allocator_proc(&na->arenas[i], type, size, alignment, old_memory, old_size, flags);
+      break;
+
+    case gbAllocation_Resize:
+      ptr = gb_default_resize_align_flags(gb_numa_arena_allocator(na), old_memory, old_size, size, alignment, flags);
+      break;
+  }
 
+  return ptr;
+}
 
 
 //
 // Pool Allocator
 //
 
+// NOTE: Address of a thread local, unique among live threads and cheaper than looking an id up
+gb_global gb_thread_local uint8_t gb__alloc_thread_tag;
+#define GB__ALLOC_THREAD (cast(void *) &gb__alloc_thread_tag)
+
+// NOTE: Any thread can push, only the owner takes the whole list back so there is no ABA to guard against
+gb_internal void gb__remote_free_push(gbAtomicPtr *queue, void *block) {
+  void *head = queue->value, *prev;
+  for (;;) {
+    *cast(void **) block = head;
+    prev = gb_atomic_ptr_compare_exchange(queue, head, block);
+    if (prev == head)
+      break;
+    head = prev;
+  }
+}
+
+gb_no_inline gb_internal void gb__pool_drain(gb_pool_t *pool) {
+  void *list = gb_atomic_ptr_exchanged(&pool->remote_free, NULL), *block;
+  ssize_t count = 0;
+  for (block = list; block; block = *cast(void **) block)
+    count++;
+  pool->free_list = list;
+  pool->total_size -= count * pool->block_size;
+}
 
 gb_inline void gb_pool_init(gb_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size) {
   gb_pool_init_align(pool, backing, num_blocks, block_size, GB_DEFAULT_MEMORY_ALIGNMENT);
 }
 
 void gb_pool_init_align(gb_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size, ssize_t block_align) {
-  ssize_t actual_block_size, pool_size, block_index;
-  void *data, *curr;
+  ssize_t actual_block_size;
+  void *data;
+
+  GB_ASSERT(gb_is_power_of_two(block_align));
+
+  actual_block_size = (gb_max(block_size, gb_size_of(uintptr_t)) + block_align - 1) & ~(block_align - 1);
+  data = gb_alloc_align(backing, num_blocks * actual_block_size, block_align);
+
+  gb_pool_init_from_memory(pool, data, num_blocks * actual_block_size, block_size, block_align);
+  pool->backing = backing;
+}
+
+void gb_pool_init_from_vm(gb_pool_t *pool, ssize_t num_blocks, ssize_t block_size, ssize_t block_align, uint32_t vm_flags, int32_t numa_node) {
+  ssize_t actual_block_size;
+  gb_virtual_memory_t vm;
+
+  GB_ASSERT(gb_is_power_of_two(block_align));
+  GB_ASSERT(block_align <= gb_virtual_memory_page_size(NULL));
+
+  actual_block_size = (gb_max(block_size, gb_size_of(uintptr_t)) + block_align - 1) & ~(block_align - 1);
+  vm = gb_vm_alloc_ex(NULL, num_blocks * actual_block_size, vm_flags, numa_node);
+  GB_ASSERT_MSG(vm.data != NULL, "Unable to map the pool");
+
+  gb_pool_init_from_memory(pool, vm.data, num_blocks * actual_block_size, block_size, block_align);
+  pool->vm = vm;
+}
+
+void gb_pool_init_from_memory(gb_pool_t *pool, void *start, ssize_t size, ssize_t block_size, ssize_t block_align) {
+  ssize_t actual_block_size, num_blocks, block_index;
+  void *curr;
   uintptr_t *end;
 
+  GB_ASSERT(gb_is_power_of_two(block_align));
+  GB_ASSERT((cast(uintptr_t) start & (block_align - 1)) == 0);
+
   gb_zero_item(pool);
 
-  pool->backing = backing;
   pool->block_size = block_size;
   pool->block_align = block_align;
 
-  actual_block_size = block_size + block_align;
-  pool_size = num_blocks * actual_block_size;
-
-  data = gb_alloc_align(backing, pool_size, block_align);
+  // NOTE: Blocks are packed back to back, a block only needs to hold the free list link
+  actual_block_size = (gb_max(block_size, gb_size_of(uintptr_t)) + block_align - 1) & ~(block_align - 1);
+  num_blocks = size / actual_block_size;
+  GB_ASSERT(num_blocks > 0);
 
   // NOTE(bill): Init intrusive freelist
-  curr = data;
+  curr = start;
   for (block_index = 0; block_index < num_blocks - 1; block_index++) {
     uintptr_t *next = cast(uintptr_t *) curr;
     *next = cast(uintptr_t) curr + actual_block_size;
@@ -427,12 +991,14 @@ void gb_pool_init_align(gb_pool_t *pool, gb_allocator_t backing, ssize_t num_blo
   end = cast(uintptr_t *) curr;
   *end = cast(uintptr_t)NULL;
 
-  pool->physical_start = data;
-  pool->free_list = data;
+  pool->physical_start = start;
+  pool->free_list = start;
 }
 
 gb_inline void gb_pool_free(gb_pool_t *pool) {
-  if (pool->backing.proc) {
+  if (pool->vm.data) {
+    gb_vm_free(pool->vm);
+  } else if (pool->backing.proc) {
     gb_free(pool->backing, pool->physical_start);
   }
 }
@@ -455,6 +1021,10 @@ GB_ALLOCATOR_PROC(gb_pool_allocator_proc) {
       uintptr_t next_free;
       GB_ASSERT(size == pool->block_size);
       GB_ASSERT(alignment == pool->block_align);
+      if (pool->owner == NULL)
+        pool->owner = GB__ALLOC_THREAD;
+      if (pool->free_list == NULL)
+        gb__pool_drain(pool);
       GB_ASSERT(pool->free_list != NULL);
 
       next_free = *cast(uintptr_t *) pool->free_list;
@@ -469,6 +1039,10 @@ GB_ALLOCATOR_PROC(gb_pool_allocator_proc) {
     case gbAllocation_Free: {
       uintptr_t *next;
       if (old_memory == NULL) return NULL;
+      if (pool->owner != GB__ALLOC_THREAD) {
+        gb__remote_free_push(&pool->remote_free, old_memory);
+        break;
+      }
 
       next = cast(uintptr_t *) old_memory;
       *next = cast(uintptr_t) pool->free_list;
@@ -490,175 +1064,822 @@ GB_ALLOCATOR_PROC(gb_pool_allocator_proc) {
   return ptr;
 }
 
-gb_inline gb_allocation_header_t *gb_allocation_header(void *data) {
-  ssize_t *p = cast(ssize_t *) data;
-  while (p[-1] == cast(ssize_t) (-1))
-    p--;
-  return cast(gb_allocation_header_t *) p - 1;
+//
+// Concurrent Pool Allocator
+//
+
+#define GB__POOL_INDEX_MASK ((cast(uintptr_t) 1 << GB_POOL_TAG_SHIFT) - 1)
+
+gb_internal gb_inline void *gb__concurrent_pool_block(gb_concurrent_pool_t *pool, uintptr_t index) {
+  return gb_pointer_add(pool->physical_start, cast(ssize_t) (index - 1) * pool->actual_block_size);
 }
 
-gb_inline void gb_allocation_header_fill(gb_allocation_header_t *header, void *data, ssize_t size) {
-  ssize_t *ptr;
-  header->size = size;
-  ptr = cast(ssize_t *) (header + 1);
-  while (cast(void *) ptr < data)
-    *ptr++ = cast(ssize_t) (-1);
+gb_internal gb_inline uintptr_t gb__concurrent_pool_index(gb_concurrent_pool_t *pool, void *block) {
+  return cast(uintptr_t) (gb_pointer_diff(pool->physical_start, block) / pool->actual_block_size) + 1;
 }
 
+// NOTE: Pops up to `count` blocks in a single CAS
+gb_internal ssize_t gb__concurrent_pool_pop(gb_concurrent_pool_t *pool, void **blocks, ssize_t count) {
+  for (;;) {
+    uintptr_t head = cast(uintptr_t) gb_atomic_ptr_load(&pool->free_list);
+    uintptr_t index = head & GB__POOL_INDEX_MASK;
+    uintptr_t tag = head >> GB_POOL_TAG_SHIFT;
+    ssize_t n = 0;
+
+    while (index != 0 && n < count) {
+      void *block = gb__concurrent_pool_block(pool, index);
+      blocks[n++] = block;
+      // NOTE: May read a block which was just handed out, the CAS below fails in that case but the
+      // garbage link must not be followed outside of the pool
+      index = *cast(uintptr_t volatile *) block & GB__POOL_INDEX_MASK;
+      if (index > cast(uintptr_t) pool->num_blocks)
+        break;
+    }
+    if (n == 0)
+      return 0;
+    if (index > cast(uintptr_t) pool->num_blocks)
+      continue;
+
+    if (cast(uintptr_t) gb_atomic_ptr_compare_exchange(&pool->free_list, cast(void *) head,
+                                                       cast(void *) (((tag + 1) << GB_POOL_TAG_SHIFT) | index)) == head)
+      return n;
+  }
+}
 
+// NOTE: Pushes `count` blocks in a single CAS
+gb_internal void gb__concurrent_pool_push(gb_concurrent_pool_t *pool, void **blocks, ssize_t count) {
+  ssize_t i;
+  uintptr_t first = gb__concurrent_pool_index(pool, blocks[0]);
+
+  for (i = 0; i < count - 1; i++)
+    *cast(uintptr_t *) blocks[i] = gb__concurrent_pool_index(pool, blocks[i + 1]);
+
+  for (;;) {
+    uintptr_t head = cast(uintptr_t) gb_atomic_ptr_load(&pool->free_list);
+    uintptr_t tag = head >> GB_POOL_TAG_SHIFT;
+    *cast(uintptr_t volatile *) blocks[count - 1] = head & GB__POOL_INDEX_MASK;
+    if (cast(uintptr_t) gb_atomic_ptr_compare_exchange(&pool->free_list, cast(void *) head,
+                                                       cast(void *) (((tag + 1) << GB_POOL_TAG_SHIFT) | first)) == head)
+      return;
+  }
+}
 
-//
-// Free List Allocator
-//
+// NOTE: Links every block back into the shared list and empties the magazines, only valid while no other
+// thread uses the pool
+gb_internal void gb__concurrent_pool_reset(gb_concurrent_pool_t *pool) {
+  uintptr_t tag = cast(uintptr_t) gb_atomic_ptr_load(&pool->free_list) >> GB_POOL_TAG_SHIFT;
+  ssize_t block_index, slot;
 
-gb_inline void gb_free_list_init(gb_free_list_t *fl, void *start, ssize_t size) {
-  GB_ASSERT(size > gb_size_of(gb_free_list_block_t));
+  // NOTE: Init intrusive freelist of indices
+  for (block_index = 1; block_index <= pool->num_blocks; block_index++) {
+    uintptr_t *next = cast(uintptr_t *) gb__concurrent_pool_block(pool, block_index);
+    *next = block_index < pool->num_blocks ? block_index + 1 : 0;
+  }
+  for (slot = 0; slot < GB_THREAD_SLOT_COUNT; slot++)
+    pool->magazines[slot].count = 0;
+  gb_atomic_ptr_store(&pool->free_list, cast(void *) (((tag + 1) << GB_POOL_TAG_SHIFT) | (pool->num_blocks > 0 ? 1 : 0)));
+}
 
-  fl->physical_start = start;
-  fl->total_size = size;
-  fl->curr_block = cast(gb_free_list_block_t *) start;
-  fl->curr_block->size = size;
-  fl->curr_block->next = NULL;
+gb_inline void gb_concurrent_pool_init(gb_concurrent_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size) {
+  gb_concurrent_pool_init_align(pool, backing, num_blocks, block_size, GB_DEFAULT_MEMORY_ALIGNMENT);
 }
 
-gb_inline void gb_free_list_init_from_allocator(gb_free_list_t *fl, gb_allocator_t backing, ssize_t size) {
-  void *start = gb_alloc(backing, size);
-  gb_free_list_init(fl, start, size);
+void gb_concurrent_pool_init_align(gb_concurrent_pool_t *pool, gb_allocator_t backing, ssize_t num_blocks, ssize_t block_size, ssize_t block_align) {
+  GB_ASSERT(gb_is_power_of_two(block_align));
+  GB_ASSERT(cast(uintptr_t) num_blocks < GB__POOL_INDEX_MASK);
+
+  gb_zero_item(pool);
+
+  pool->backing = backing;
+  pool->block_size = block_size;
+  pool->block_align = block_align;
+  pool->actual_block_size = (gb_max(block_size, gb_size_of(uintptr_t)) + block_align - 1) & ~(block_align - 1);
+  pool->num_blocks = num_blocks;
+
+  pool->physical_start = gb_alloc_align(backing, num_blocks * pool->actual_block_size, block_align);
+  pool->magazines = gb_alloc_array(backing, gb_pool_magazine_t, GB_THREAD_SLOT_COUNT);
+  gb__concurrent_pool_reset(pool);
 }
 
-gb_inline gb_allocator_t gb_free_list_allocator(gb_free_list_t *fl) {
-  gb_allocator_t a;
-  a.proc = gb_free_list_allocator_proc;
-  a.data = fl;
-  return a;
+gb_inline void gb_concurrent_pool_free(gb_concurrent_pool_t *pool) {
+  if (pool->backing.proc) {
+    gb_free(pool->backing, pool->magazines);
+    gb_free(pool->backing, pool->physical_start);
+  }
 }
 
-GB_ALLOCATOR_PROC(gb_free_list_allocator_proc) {
-  gb_free_list_t *fl = cast(gb_free_list_t *) allocator_data;
+gb_inline gb_allocator_t gb_concurrent_pool_allocator(gb_concurrent_pool_t *pool) {
+  gb_allocator_t allocator;
+  allocator.proc = gb_concurrent_pool_allocator_proc;
+  allocator.data = pool;
+  return allocator;
+}
+
+GB_ALLOCATOR_PROC(gb_concurrent_pool_allocator_proc) {
+  gb_concurrent_pool_t *pool = cast(gb_concurrent_pool_t *) allocator_data;
+  ssize_t slot = gb_thread_slot();
   void *ptr = NULL;
 
-  GB_ASSERT_NOT_NULL(fl);
+  gb_unused(old_size);
 
   switch (type) {
     case gbAllocation_Alloc: {
-      gb_free_list_block_t *prev_block = NULL;
-      gb_free_list_block_t *curr_block = fl->curr_block;
+      GB_ASSERT(size <= pool->block_size);
+      GB_ASSERT(alignment <= pool->block_align);
 
-      while (curr_block) {
-        ssize_t total_size;
-        gb_allocation_header_t *header;
+      if (slot < 0) {
+        gb__concurrent_pool_pop(pool, &ptr, 1);
+      } else {
+        gb_pool_magazine_t *m = &pool->magazines[slot];
+        if (m->count == 0)
+          m->count = gb__concurrent_pool_pop(pool, m->blocks, GB_POOL_MAGAZINE_SIZE / 2);
+        if (m->count > 0)
+          ptr = m->blocks[--m->count];
+      }
+
+      if (ptr && (flags & gbAllocatorFlag_ClearToZero))
+        gb_zero_size(ptr, size);
+    }
+      break;
 
-        total_size = size + alignment + gb_size_of(gb_allocation_header_t);
+    case gbAllocation_Free: {
+      if (old_memory == NULL) return NULL;
 
-        if (curr_block->size < total_size) {
-          prev_block = curr_block;
-          curr_block = curr_block->next;
-          continue;
+      if (slot < 0) {
+        gb__concurrent_pool_push(pool, &old_memory, 1);
+      } else {
+        gb_pool_magazine_t *m = &pool->magazines[slot];
+        if (m->count == GB_POOL_MAGAZINE_SIZE) {
+          m->count -= GB_POOL_MAGAZINE_SIZE / 2;
+          gb__concurrent_pool_push(pool, &m->blocks[m->count], GB_POOL_MAGAZINE_SIZE / 2);
         }
+        m->blocks[m->count++] = old_memory;
+      }
+    }
+      break;
 
-        if (curr_block->size - total_size <= gb_size_of(gb_allocation_header_t)) {
-          total_size = curr_block->size;
+    case gbAllocation_FreeAll:
+      gb__concurrent_pool_reset(pool);
+      break;
 
-          if (prev_block)
-            prev_block->next = curr_block->next;
-          else
-            fl->curr_block = curr_block->next;
-        } else {
-          // NOTE(bill): Create a new block for the remaining memory
-          gb_free_list_block_t *next_block;
-          next_block = cast(gb_free_list_block_t *) gb_pointer_add(curr_block, total_size);
+    case gbAllocation_Resize:
+      // NOTE: Cannot resize
+      GB_PANIC("You cannot resize something allocated by with a pool.");
+      break;
+  }
 
-          GB_ASSERT(cast(
-                      void *)next_block < gb_pointer_add(fl->physical_start, fl->total_size));
+  return ptr;
+}
 
-          next_block->size = curr_block->size - total_size;
-          next_block->next = curr_block->next;
+//
+// Slab Allocator
+//
 
-          if (prev_block)
-            prev_block->next = next_block;
-          else
-            fl->curr_block = next_block;
-        }
+// NOTE: Room for the page header, also the strongest alignment served from a page
+#define GB__SLAB_HEADER_SIZE 256
 
+GB_STATIC_ASSERT(gb_size_of(gb_slab_page_t) <= GB__SLAB_HEADER_SIZE);
 
-        // TODO(bill): Set Header Info
-        header = cast(gb_allocation_header_t *) curr_block;
-        ptr = gb_align_forward(header + 1, alignment);
-        gb_allocation_header_fill(header, ptr, size);
+gb_internal gb_inline gb_slab_page_t *gb__slab_page_of(void *ptr) {
+  return cast(gb_slab_page_t *) (cast(uintptr_t) ptr & ~cast(uintptr_t) (GB_SLAB_PAGE_SIZE - 1));
+}
 
-        fl->total_allocated += total_size;
-        fl->allocation_count++;
+gb_internal gb_inline void gb__slab_link(gb_slab_page_t **list, gb_slab_page_t *page) {
+  page->prev = NULL;
+  page->next = *list;
+  if (*list) (*list)->prev = page;
+  *list = page;
+}
 
-        if (flags & gbAllocatorFlag_ClearToZero)
-          gb_zero_size(ptr, size);
-        return ptr;
-      }
-      // NOTE(bill): if ptr == NULL, ran out of free list memory! FUCK!
+gb_internal gb_inline void gb__slab_unlink(gb_slab_page_t **list, gb_slab_page_t *page) {
+  if (page->prev) page->prev->next = page->next;
+  else *list = page->next;
+  if (page->next) page->next->prev = page->prev;
+  page->next = page->prev = NULL;
+}
+
+gb_internal gb_inline ssize_t gb__slab_large_home(gb_slab_t *slab, void const *ptr) {
+  return cast(ssize_t) (((cast(uint64_t) cast(uintptr_t) ptr >> 4) * 0x9e3779b97f4a7c15ull) >> 32) & (slab->large_capacity - 1);
+}
+
+// NOTE: Slot of a large block, -1 when ptr lives in a page
+gb_internal gb_inline ssize_t gb__slab_large_find(gb_slab_t *slab, void const *ptr) {
+  ssize_t i;
+  if (slab->large_count == 0)
+    return -1;
+  for (i = gb__slab_large_home(slab, ptr); slab->large[i].ptr != ptr; i = (i + 1) & (slab->large_capacity - 1))
+    if (!slab->large[i].ptr)
+      return -1;
+  return i;
+}
+
+gb_internal void gb__slab_large_insert(gb_slab_t *slab, void *ptr, ssize_t size);
+
+gb_internal byte32_t gb__slab_large_grow(gb_slab_t *slab) {
+  gb_slab_large_t *old_large = slab->large;
+  ssize_t i, old_capacity = slab->large_capacity;
+  gb_slab_large_t *large = gb_alloc_array(slab->backing, gb_slab_large_t, old_capacity ? 2 * old_capacity : 16);
+  if (!large) return false;
+  slab->large = large;
+  slab->large_capacity = old_capacity ? 2 * old_capacity : 16;
+  slab->large_count = 0;
+  for (i = 0; i < old_capacity; i++)
+    if (old_large[i].ptr)
+      gb__slab_large_insert(slab, old_large[i].ptr, old_large[i].size);
+  if (old_large)
+    gb_free(slab->backing, old_large);
+  return true;
+}
+
+// NOTE: Room is made by the caller (gb__slab_large_reserve) so a failure is reported before the block is taken
+gb_internal void gb__slab_large_insert(gb_slab_t *slab, void *ptr, ssize_t size) {
+  ssize_t i = gb__slab_large_home(slab, ptr);
+  while (slab->large[i].ptr)
+    i = (i + 1) & (slab->large_capacity - 1);
+  slab->large[i].ptr = ptr;
+  slab->large[i].size = size;
+  slab->large_count++;
+}
+
+gb_internal gb_inline byte32_t gb__slab_large_reserve(gb_slab_t *slab) {
+  return 2 * (slab->large_count + 1) <= slab->large_capacity || gb__slab_large_grow(slab);
+}
+
+// NOTE: Linear probing with backward shift deletion, no tombstones
+gb_internal void gb__slab_large_remove(gb_slab_t *slab, ssize_t i) {
+  ssize_t mask = slab->large_capacity - 1, j;
+  for (j = (i + 1) & mask; slab->large[j].ptr; j = (j + 1) & mask) {
+    ssize_t home = gb__slab_large_home(slab, slab->large[j].ptr);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      slab->large[i] = slab->large[j];
+      i = j;
+    }
+  }
+  slab->large[i].ptr = NULL;
+  slab->large_count--;
+}
+
+#define GB__SLAB_CHUNK_SIZE (GB_SLAB_CHUNK_PAGES * GB_SLAB_PAGE_SIZE)
+
+gb_internal gb_slab_page_t *gb__slab_page_acquire(gb_slab_t *slab) {
+  gb_slab_page_t *page;
+
+  if (!slab->empty) {
+    gb_slab_page_t *chunk;
+    ssize_t i;
+    // NOTE: Left uninitialized, only the page headers are written and blocks are cleared on request
+    chunk = cast(gb_slab_page_t *) gb_alloc_align_flags(slab->backing, GB__SLAB_CHUNK_SIZE, GB_SLAB_PAGE_SIZE, 0);
+    if (!chunk) return NULL;
+    GB_ASSERT(gb__slab_page_of(chunk) == chunk);
+    chunk->chunk_used = 0;
+    chunk->chunk_next = slab->chunks;
+    slab->chunks = chunk;
+    for (i = GB_SLAB_CHUNK_PAGES - 1; i >= 0; i--) {
+      page = cast(gb_slab_page_t *) gb_pointer_add(chunk, i * GB_SLAB_PAGE_SIZE);
+      page->chunk = chunk;
+      gb__slab_link(&slab->empty, page);
+    }
+  }
+
+  page = slab->empty;
+  gb__slab_unlink(&slab->empty, page);
+  page->chunk->chunk_used++;
+  slab->page_count++;
+  return page;
+}
+
+gb_internal void gb__slab_page_release(gb_slab_t *slab, gb_slab_page_t *page) {
+  gb_slab_page_t *chunk = page->chunk;
+
+  gb__slab_link(&slab->empty, page);
+  slab->page_count--;
+  if (--chunk->chunk_used == 0) {
+    gb_slab_page_t **link = &slab->chunks;
+    ssize_t i;
+    for (i = 0; i < GB_SLAB_CHUNK_PAGES; i++)
+      gb__slab_unlink(&slab->empty, cast(gb_slab_page_t *) gb_pointer_add(chunk, i * GB_SLAB_PAGE_SIZE));
+    while (*link != chunk)
+      link = &(*link)->chunk_next;
+    *link = chunk->chunk_next;
+    gb_free(slab->backing, chunk);
+  }
+}
+
+gb_inline void gb_slab_init(gb_slab_t *slab, gb_allocator_t backing) {
+  gb_zero_item(slab);
+  slab->backing = backing;
+}
+
+void gb_slab_free(gb_slab_t *slab) {
+  ssize_t i;
+  for (i = 0; i < GB_SLAB_CLASS_COUNT; i++)
+    slab->partial[i] = NULL;
+  while (slab->chunks) {
+    gb_slab_page_t *next = slab->chunks->chunk_next;
+    gb_free(slab->backing, slab->chunks);
+    slab->chunks = next;
+  }
+  for (i = 0; i < slab->large_capacity; i++)
+    if (slab->large[i].ptr)
+      gb_free(slab->backing, slab->large[i].ptr);
+  if (slab->large)
+    gb_free(slab->backing, slab->large);
+  slab->large = NULL;
+  slab->large_count = slab->large_capacity = 0;
+  slab->full = slab->empty = NULL;
+  slab->page_count = 0;
+  slab->total_size = 0;
+  slab->remote_free.value = NULL; // NOTE: Blocks still queued lived in the released pages
+}
+
+ssize_t gb_slab_size_class(ssize_t size) {
+  ssize_t b;
+  if (size <= 128)
+    return size <= 16 ? 0 : (size - 1) / 16;
+  GB_ASSERT(size <= GB_SLAB_MAX_SIZE);
+  b = gb_log2(cast(uint64_t) (size - 1));
+  return 8 + (b - 7) * 8 + (((size - 1) >> (b - 3)) - 8);
+}
+
+ssize_t gb_slab_class_size(ssize_t size_class) {
+  ssize_t k, b;
+  GB_ASSERT(size_class >= 0 && size_class < GB_SLAB_CLASS_COUNT);
+  if (size_class < 8)
+    return (size_class + 1) * 16;
+  k = size_class - 8;
+  b = 7 + k / 8;
+  return (cast(ssize_t) 1 << b) + ((k % 8) + 1) * (cast(ssize_t) 1 << (b - 3));
+}
+
+gb_inline gb_allocator_t gb_slab_allocator(gb_slab_t *slab) {
+  gb_allocator_t allocator;
+  allocator.proc = gb_slab_allocator_proc;
+  allocator.data = slab;
+  return allocator;
+}
+
+// NOTE: Smallest class that holds size and keeps every block aligned, -1 when it must go to the backing
+gb_internal ssize_t gb__slab_class_for(ssize_t size, ssize_t alignment) {
+  ssize_t size_class;
+  if (size > GB_SLAB_MAX_SIZE || alignment > GB__SLAB_HEADER_SIZE)
+    return -1;
+  for (size_class = gb_slab_size_class(size); size_class < GB_SLAB_CLASS_COUNT; size_class++)
+    if ((gb_slab_class_size(size_class) & (alignment - 1)) == 0)
+      return size_class;
+  return -1;
+}
+
+gb_internal void gb__slab_free(gb_slab_t *slab, void *ptr);
+
+gb_no_inline gb_internal void gb__slab_drain(gb_slab_t *slab) {
+  void *block = gb_atomic_ptr_exchanged(&slab->remote_free, NULL);
+  while (block) {
+    void *next = *cast(void **) block;
+    gb__slab_free(slab, block);
+    block = next;
+  }
+}
+
+gb_internal void *gb__slab_alloc(gb_slab_t *slab, ssize_t size, ssize_t alignment, uint64_t flags) {
+  gb_slab_page_t *page;
+  ssize_t size_class = gb__slab_class_for(size, alignment);
+  void *ptr;
+
+  if (slab->owner == NULL)
+    slab->owner = GB__ALLOC_THREAD;
+
+  if (size_class < 0) {
+    if (slab->remote_free.value)
+      gb__slab_drain(slab);
+    if (!gb__slab_large_reserve(slab))
       return NULL;
+    // NOTE: Room for the remote-free link however small the block
+    ptr = gb_alloc_align_flags(slab->backing, gb_max(size, gb_size_of(void *)), alignment, flags);
+    if (!ptr) return NULL;
+    gb__slab_large_insert(slab, ptr, size);
+    slab->total_size += size;
+    return ptr;
+  }
+
+  page = slab->partial[size_class];
+  if (!page && slab->remote_free.value) {
+    gb__slab_drain(slab);
+    page = slab->partial[size_class];
+  }
+  if (!page) {
+    page = gb__slab_page_acquire(slab);
+    if (!page) return NULL;
+    gb_pool_init_from_memory(&page->pool, gb_pointer_add(page, GB__SLAB_HEADER_SIZE),
+                             GB_SLAB_PAGE_SIZE - GB__SLAB_HEADER_SIZE,
+                             gb_slab_class_size(size_class), GB_DEFAULT_MEMORY_ALIGNMENT);
+    page->size_class = size_class;
+    page->size = page->pool.block_size;
+    page->used = 0;
+    page->capacity = (GB_SLAB_PAGE_SIZE - GB__SLAB_HEADER_SIZE) / page->size;
+    gb__slab_link(&slab->partial[size_class], page);
+  }
+
+  ptr = gb_pool_allocator_proc(&page->pool, gbAllocation_Alloc, page->size, page->pool.block_align, NULL, 0, flags);
+  slab->total_size += page->size;
+  if (++page->used == page->capacity) {
+    gb__slab_unlink(&slab->partial[size_class], page);
+    gb__slab_link(&slab->full, page);
+  }
+  return ptr;
+}
+
+gb_internal void gb__slab_free(gb_slab_t *slab, void *ptr) {
+  gb_slab_page_t *page;
+  gb_slab_page_t **partial;
+  ssize_t large;
+
+  if (slab->owner != GB__ALLOC_THREAD) {
+    gb__remote_free_push(&slab->remote_free, ptr);
+    return;
+  }
+
+  // NOTE: Large blocks are not page aligned, masking their address is only valid for page blocks
+  large = gb__slab_large_find(slab, ptr);
+  if (large >= 0) {
+    slab->total_size -= slab->large[large].size;
+    gb__slab_large_remove(slab, large);
+    gb_free(slab->backing, ptr);
+    return;
+  }
+
+  page = gb__slab_page_of(ptr);
+  slab->total_size -= page->size;
+
+  gb_pool_allocator_proc(&page->pool, gbAllocation_Free, 0, 0, ptr, page->size, 0);
+  partial = &slab->partial[page->size_class];
+  if (page->used-- == page->capacity) {
+    gb__slab_unlink(&slab->full, page);
+    gb__slab_link(partial, page);
+  }
+
+  // NOTE: Keep the last partial page of a class around so a single block does not thrash pages
+  if (page->used == 0 && (*partial != page || page->next != NULL)) {
+    gb__slab_unlink(partial, page);
+    gb__slab_page_release(slab, page);
+  }
+}
+
+GB_ALLOCATOR_PROC(gb_slab_allocator_proc) {
+  gb_slab_t *slab = cast(gb_slab_t *) allocator_data;
+  void *ptr = NULL;
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb__slab_alloc(slab, size, alignment, flags);
+      break;
+
+    case gbAllocation_Free:
+      if (old_memory) gb__slab_free(slab, old_memory);
+      break;
+
+    case gbAllocation_FreeAll:
+      gb_slab_free(slab);
+      break;
+
+    case gbAllocation_Resize: {
+      ssize_t large, old_block_size;
+      if (!old_memory) return gb__slab_alloc(slab, size, alignment, flags);
+      if (size == 0) {
+        gb__slab_free(slab, old_memory);
+        return NULL;
+      }
+
+      large = gb__slab_large_find(slab, old_memory);
+      if (large >= 0) {
+        // NOTE: Large to large goes through the backing, which may grow or shrink the block in place
+        old_block_size = slab->large[large].size;
+        if (gb__slab_class_for(size, alignment) < 0) {
+          ptr = gb_resize_align_flags(slab->backing, old_memory, gb_max(old_block_size, gb_size_of(void *)),
+                                      gb_max(size, gb_size_of(void *)), alignment, flags);
+          if (!ptr) return NULL;
+          gb__slab_large_remove(slab, large);
+          gb__slab_large_insert(slab, ptr, size); // NOTE: Room left by the removal
+          slab->total_size += size - old_block_size;
+          return ptr;
+        }
+      } else {
+        // NOTE: Stay in place while the size maps to the same class
+        gb_slab_page_t *page = gb__slab_page_of(old_memory);
+        if (page->size_class == gb__slab_class_for(size, alignment)) {
+          if ((flags & gbAllocatorFlag_ClearToZero) && size > old_size)
+            gb_zero_size(gb_pointer_add(old_memory, old_size), size - old_size);
+          return old_memory;
+        }
+        old_block_size = page->size;
+      }
+
+      ptr = gb__slab_alloc(slab, size, alignment, flags);
+      if (!ptr) return NULL;
+      gb_memcopy(ptr, old_memory, gb_min(size, gb_min(old_size, old_block_size)));
+      gb__slab_free(slab, old_memory);
     }
       break;
+  }
 
-    case gbAllocation_Free: {
-      gb_allocation_header_t *header = gb_allocation_header(old_memory);
-      ssize_t block_size = header->size;
-      uintptr_t block_start, block_end;
-      gb_free_list_block_t *prev_block = NULL;
-      gb_free_list_block_t *curr_block = fl->curr_block;
+  return ptr;
+}
+
+gb_inline gb_allocation_header_t *gb_allocation_header(void *data) {
+  ssize_t *p = cast(ssize_t *) data;
+  while (p[-1] == cast(ssize_t) (-1))
+    p--;
+  return cast(gb_allocation_header_t *) p - 1;
+}
+
+gb_inline void gb_allocation_header_fill(gb_allocation_header_t *header, void *data, ssize_t size) {
+  ssize_t *ptr;
+  header->size = size;
+  ptr = cast(ssize_t *) (header + 1);
+  while (cast(void *) ptr < data)
+    *ptr++ = cast(ssize_t) (-1);
+}
+
+
+
+//
+// Free List Allocator
+//
+
+#define GB__FREE_LIST_WORD      gb_size_of(ssize_t)
+#define GB__FREE_LIST_GRANULE   (2 * GB__FREE_LIST_WORD)
+#define GB__FREE_LIST_MIN_BLOCK (gb_size_of(gb_free_list_block_t) + GB__FREE_LIST_WORD)
+#define GB__FREE_LIST_USED      1
+#define GB__FREE_LIST_PREV_USED 2
+#define GB__FREE_LIST_FLAGS     (GB__FREE_LIST_USED | GB__FREE_LIST_PREV_USED)
+
+// NOTE: Blocks start one word before a granule boundary so payloads following the size word are aligned
+gb_internal gb_inline ssize_t gb__fl_size(gb_free_list_block_t *block) {
+  return block->size & ~cast(ssize_t) GB__FREE_LIST_FLAGS;
+}
 
-      block_start = cast(uintptr_t) header;
-      block_end = cast(uintptr_t) block_start + block_size;
+gb_internal gb_inline gb_free_list_block_t *gb__fl_next(gb_free_list_block_t *block) {
+  return cast(gb_free_list_block_t *) gb_pointer_add(block, gb__fl_size(block));
+}
+
+gb_internal gb_inline ssize_t *gb__fl_footer(gb_free_list_block_t *block) {
+  return cast(ssize_t *) gb_pointer_add(block, gb__fl_size(block) - GB__FREE_LIST_WORD);
+}
+
+gb_internal gb_inline ssize_t gb__free_list_bin(ssize_t size) {
+  ssize_t b;
+  if (size < 256)
+    return size / 16;
+  b = gb_log2(cast(uint64_t) size);
+  return gb_min(16 + (b - 8) * 4 + ((size >> (b - 2)) & 3), GB_FREE_LIST_BIN_COUNT - 1);
+}
+
+gb_internal gb_inline void gb__free_list_insert(gb_free_list_t *fl, gb_free_list_block_t *block, ssize_t size) {
+  ssize_t bin = gb__free_list_bin(size);
 
-      while (curr_block) {
-        if (cast(uintptr_t) curr_block >= block_end)
+  block->size = size | GB__FREE_LIST_PREV_USED;
+  *gb__fl_footer(block) = size;
+  gb__fl_next(block)->size &= ~cast(ssize_t) GB__FREE_LIST_PREV_USED;
+
+  block->prev = NULL;
+  block->next = fl->bins[bin];
+  if (block->next) block->next->prev = block;
+  fl->bins[bin] = block;
+  fl->bin_mask |= cast(uint64_t) 1 << bin;
+}
+
+gb_internal gb_inline void gb__free_list_remove(gb_free_list_t *fl, gb_free_list_block_t *block) {
+  ssize_t bin = gb__free_list_bin(gb__fl_size(block));
+  if (block->prev) block->prev->next = block->next;
+  else fl->bins[bin] = block->next;
+  if (block->next) block->next->prev = block->prev;
+  if (fl->bins[bin] == NULL)
+    fl->bin_mask &= ~(cast(uint64_t) 1 << bin);
+}
+
+// NOTE: Best fit within the first bin holding a block of at least `size` bytes
+gb_internal gb_free_list_block_t *gb__free_list_find(gb_free_list_t *fl, ssize_t size) {
+  ssize_t bin = gb__free_list_bin(size);
+  uint64_t mask = fl->bin_mask & (~cast(uint64_t) 0 << bin);
+
+  while (mask) {
+    gb_free_list_block_t *block, *best = NULL;
+    bin = gb_log2(mask & (~mask + 1));
+    for (block = fl->bins[bin]; block; block = block->next) {
+      ssize_t block_size = gb__fl_size(block);
+      if (block_size >= size && (best == NULL || block_size < gb__fl_size(best))) {
+        best = block;
+        if (block_size == size)
           break;
-        prev_block = curr_block;
-        curr_block = curr_block->next;
       }
+    }
+    if (best)
+      return best;
+    mask &= mask - 1;
+  }
+  return NULL;
+}
 
-      if (prev_block == NULL) {
-        prev_block = cast(gb_free_list_block_t *) block_start;
-        prev_block->size = block_size;
-        prev_block->next = fl->curr_block;
+// NOTE: Marks the first `size` bytes of `block` as used and gives the tail back when it is big enough
+gb_internal void gb__free_list_use(gb_free_list_t *fl, gb_free_list_block_t *block, ssize_t size) {
+  ssize_t block_size = gb__fl_size(block);
+  ssize_t prev_used = block->size & GB__FREE_LIST_PREV_USED;
 
-        fl->curr_block = prev_block;
-      } else if ((cast(uintptr_t) prev_block + prev_block->size) == block_start) {
-        prev_block->size += block_size;
-      } else {
-        gb_free_list_block_t *tmp = cast(gb_free_list_block_t *) block_start;
-        tmp->size = block_size;
-        tmp->next = prev_block->next;
-        prev_block->next = tmp;
+  if (block_size - size >= GB__FREE_LIST_MIN_BLOCK) {
+    block->size = size | prev_used | GB__FREE_LIST_USED;
+    gb__free_list_insert(fl, gb__fl_next(block), block_size - size);
+  } else {
+    block->size = block_size | prev_used | GB__FREE_LIST_USED;
+    gb__fl_next(block)->size |= GB__FREE_LIST_PREV_USED;
+  }
+}
 
-        prev_block = tmp;
-      }
+// NOTE: Returns the block to its bin after merging it with its free neighbours
+gb_internal void gb__free_list_release(gb_free_list_t *fl, gb_free_list_block_t *block) {
+  ssize_t size = gb__fl_size(block);
+  gb_free_list_block_t *next = gb__fl_next(block);
 
-      if (curr_block && (cast(uintptr_t) curr_block == block_end)) {
-        prev_block->size += curr_block->size;
-        prev_block->next = curr_block->next;
-      }
+  if (!(next->size & GB__FREE_LIST_USED)) {
+    gb__free_list_remove(fl, next);
+    size += gb__fl_size(next);
+  }
+  if (!(block->size & GB__FREE_LIST_PREV_USED)) {
+    ssize_t prev_size = *cast(ssize_t *) gb_pointer_sub(block, GB__FREE_LIST_WORD);
+    block = cast(gb_free_list_block_t *) gb_pointer_sub(block, prev_size);
+    gb__free_list_remove(fl, block);
+    size += prev_size;
+  }
+  gb__free_list_insert(fl, block, size);
+}
+
+gb_internal gb_inline ssize_t gb__free_list_block_size(ssize_t size) {
+  size = (size + GB__FREE_LIST_WORD + GB__FREE_LIST_GRANULE - 1) & ~(GB__FREE_LIST_GRANULE - 1);
+  return gb_max(size, GB__FREE_LIST_MIN_BLOCK);
+}
+
+void gb_free_list_init(gb_free_list_t *fl, void *start, ssize_t size) {
+  gb_free_list_block_t *block, *end;
+  uintptr_t first, last;
 
-      fl->allocation_count--;
-      fl->total_allocated -= block_size;
+  first = ((cast(uintptr_t) start + GB__FREE_LIST_WORD + GB__FREE_LIST_GRANULE - 1) & ~cast(uintptr_t) (GB__FREE_LIST_GRANULE - 1)) - GB__FREE_LIST_WORD;
+  last = ((cast(uintptr_t) start + size) & ~cast(uintptr_t) (GB__FREE_LIST_GRANULE - 1)) - GB__FREE_LIST_WORD;
+  GB_ASSERT(last > first && cast(ssize_t) (last - first) >= GB__FREE_LIST_MIN_BLOCK);
+
+  gb_zero_item(fl);
+  fl->physical_start = start;
+  fl->total_size = size;
+
+  // NOTE: The first block never has a previous one to merge with, the end marker is a used empty block
+  block = cast(gb_free_list_block_t *) first;
+  end = cast(gb_free_list_block_t *) last;
+  end->size = GB__FREE_LIST_USED;
+  gb__free_list_insert(fl, block, cast(ssize_t) (last - first));
+}
+
+gb_inline void gb_free_list_init_from_allocator(gb_free_list_t *fl, gb_allocator_t backing, ssize_t size) {
+  void *start = gb_alloc(backing, size);
+  gb_free_list_init(fl, start, size);
+}
+
+gb_inline gb_allocator_t gb_free_list_allocator(gb_free_list_t *fl) {
+  gb_allocator_t a;
+  a.proc = gb_free_list_allocator_proc;
+  a.data = fl;
+  return a;
+}
+
+gb_internal void *gb__free_list_alloc(gb_free_list_t *fl, ssize_t size, ssize_t alignment, uint64_t flags) {
+  ssize_t block_size = gb__free_list_block_size(size);
+  gb_free_list_block_t *block;
+  void *ptr;
+
+  if (alignment <= GB__FREE_LIST_GRANULE) {
+    block = gb__free_list_find(fl, block_size);
+    if (!block) return NULL;
+    gb__free_list_remove(fl, block);
+  } else {
+    ssize_t lead;
+    GB_ASSERT(gb_is_power_of_two(alignment));
+    block = gb__free_list_find(fl, block_size + alignment + GB__FREE_LIST_MIN_BLOCK);
+    if (!block) return NULL;
+    gb__free_list_remove(fl, block);
+
+    // NOTE: Split the lead off as its own free block, it must be big enough to stand alone
+    ptr = gb_align_forward(gb_pointer_add(block, GB__FREE_LIST_WORD), alignment);
+    lead = gb_pointer_diff(block, ptr) - GB__FREE_LIST_WORD;
+    if (lead > 0 && lead < GB__FREE_LIST_MIN_BLOCK) {
+      ptr = gb_align_forward(gb_pointer_add(block, GB__FREE_LIST_WORD + GB__FREE_LIST_MIN_BLOCK), alignment);
+      lead = gb_pointer_diff(block, ptr) - GB__FREE_LIST_WORD;
+    }
+    if (lead > 0) {
+      gb_free_list_block_t *rest = cast(gb_free_list_block_t *) gb_pointer_add(block, lead);
+      rest->size = gb__fl_size(block) - lead;
+      block->size = lead | (block->size & GB__FREE_LIST_PREV_USED);
+      gb__free_list_insert(fl, block, lead);
+      block = rest;
     }
+  }
+
+  gb__free_list_use(fl, block, block_size);
+  ptr = gb_pointer_add(block, GB__FREE_LIST_WORD);
+
+  fl->total_allocated += gb__fl_size(block);
+  fl->allocation_count++;
+
+  if (flags & gbAllocatorFlag_ClearToZero)
+    gb_zero_size(ptr, size);
+  return ptr;
+}
+
+gb_internal void gb__free_list_free(gb_free_list_t *fl, void *ptr) {
+  gb_free_list_block_t *block = cast(gb_free_list_block_t *) gb_pointer_sub(ptr, GB__FREE_LIST_WORD);
+  GB_ASSERT_MSG(block->size & GB__FREE_LIST_USED, "Double free");
+
+  fl->total_allocated -= gb__fl_size(block);
+  fl->allocation_count--;
+  gb__free_list_release(fl, block);
+}
+
+GB_ALLOCATOR_PROC(gb_free_list_allocator_proc) {
+  gb_free_list_t *fl = cast(gb_free_list_t *) allocator_data;
+  void *ptr = NULL;
+
+  GB_ASSERT_NOT_NULL(fl);
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb__free_list_alloc(fl, size, alignment, flags);
+      break;
+
+    case gbAllocation_Free:
+      if (old_memory) gb__free_list_free(fl, old_memory);
       break;
 
     case gbAllocation_FreeAll:
       gb_free_list_init(fl, fl->physical_start, fl->total_size);
       break;
 
-    case gbAllocation_Resize:
-      ptr = gb_default_resize_align(gb_free_list_allocator(fl), old_memory, old_size, size, alignment);
+    case gbAllocation_Resize: {
+      gb_free_list_block_t *block, *next;
+      ssize_t block_size, curr_size;
+      byte32_t in_place;
+
+      if (!old_memory) return gb__free_list_alloc(fl, size, alignment, flags);
+      if (size == 0) {
+        gb__free_list_free(fl, old_memory);
+        return NULL;
+      }
+
+      block = cast(gb_free_list_block_t *) gb_pointer_sub(old_memory, GB__FREE_LIST_WORD);
+      block_size = gb__free_list_block_size(size);
+      curr_size = gb__fl_size(block);
+      next = gb__fl_next(block);
+
+      in_place = (cast(uintptr_t) old_memory & (alignment - 1)) == 0;
+
+      // NOTE: Grow into the next block when it is free, shrinking gives the tail back
+      if (in_place && block_size > curr_size && !(next->size & GB__FREE_LIST_USED) &&
+          curr_size + gb__fl_size(next) >= block_size) {
+        gb__free_list_remove(fl, next);
+        block->size += gb__fl_size(next);
+        gb__fl_next(block)->size |= GB__FREE_LIST_PREV_USED;
+      }
+      if (in_place && block_size <= gb__fl_size(block)) {
+        ssize_t tail = gb__fl_size(block) - block_size;
+        fl->total_allocated -= curr_size;
+        if (tail >= GB__FREE_LIST_MIN_BLOCK) {
+          gb_free_list_block_t *rest = cast(gb_free_list_block_t *) gb_pointer_add(block, block_size);
+          block->size -= tail;
+          rest->size = tail | GB__FREE_LIST_PREV_USED | GB__FREE_LIST_USED;
+          gb__free_list_release(fl, rest);
+        }
+        fl->total_allocated += gb__fl_size(block);
+        if ((flags & gbAllocatorFlag_ClearToZero) && size > old_size)
+          gb_zero_size(gb_pointer_add(old_memory, old_size), size - old_size);
+        return old_memory;
+      }
+
+      ptr = gb__free_list_alloc(fl, size, alignment, flags);
+      if (!ptr) return NULL;
+      gb_memcopy(ptr, old_memory, gb_min(size, old_size));
+      gb__free_list_free(fl, old_memory);
+    }
       break;
   }
 
   return ptr;
 }
 
+//
+// Scratch Allocator
+//
+
 void gb_scratch_memory_init(gb_scratch_memory_t *s, void *start, ssize_t size) {
   s->physical_start = start;
   s->total_size = size;
   s->alloc_point = start;
   s->free_point = start;
+  s->frame_count = 0;
+  s->frame_point = start;
 }
 
 byte32_t gb_scratch_memory_is_in_use(gb_scratch_memory_t *s, void *ptr) {
@@ -675,40 +1896,55 @@ gb_allocator_t gb_scratch_allocator(gb_scratch_memory_t *s) {
   return a;
 }
 
+// NOTE: The alloc point always leaves room for a header before the end so a wrap can be recorded there,
+// and a block never ends on the free point as an equal alloc point means the ring is empty
+gb_internal void *gb__scratch_alloc(gb_scratch_memory_t *s, ssize_t size, ssize_t alignment) {
+  void *end = gb_pointer_add(s->physical_start, s->total_size);
+  gb_allocation_header_t *header;
+  void *data, *pt;
+  byte32_t wrapped = false;
+
+  if (s->free_point == s->alloc_point && s->frame_count == 0)
+    s->alloc_point = s->free_point = s->physical_start;
+
+  header = cast(gb_allocation_header_t *) s->alloc_point;
+  data = gb_align_forward(header + 1, alignment);
+  pt = gb_align_forward(gb_pointer_add(data, size), gb_size_of(ssize_t));
+
+  // NOTE(bill): Wrap around
+  if (gb_pointer_diff(pt, end) < gb_size_of(gb_allocation_header_t)) {
+    header = cast(gb_allocation_header_t *) s->physical_start;
+    data = gb_align_forward(header + 1, alignment);
+    pt = gb_align_forward(gb_pointer_add(data, size), gb_size_of(ssize_t));
+    if (gb_pointer_diff(pt, end) < gb_size_of(gb_allocation_header_t))
+      return NULL;
+    wrapped = true;
+  }
+
+  if (wrapped ? (s->alloc_point < s->free_point || pt >= s->free_point)
+              : (s->alloc_point < s->free_point && pt >= s->free_point))
+    return NULL;
+
+  if (wrapped) {
+    gb_allocation_header_t *pad = cast(gb_allocation_header_t *) s->alloc_point;
+    pad->size = gb_pointer_diff(pad, end) | GB_ISIZE_HIGH_BIT;
+  }
+  gb_allocation_header_fill(header, data, gb_pointer_diff(header, pt));
+  s->alloc_point = pt;
+  return data;
+}
+
 GB_ALLOCATOR_PROC(gb_scratch_allocator_proc) {
   gb_scratch_memory_t *s = cast(gb_scratch_memory_t *) allocator_data;
   void *ptr = NULL;
   GB_ASSERT_NOT_NULL(s);
 
   switch (type) {
-    case gbAllocation_Alloc: {
-      void *pt = s->alloc_point;
-      gb_allocation_header_t *header = cast(gb_allocation_header_t *) pt;
-      void *data = gb_align_forward(header + 1, alignment);
-      void *end = gb_pointer_add(s->physical_start, s->total_size);
-
+    case gbAllocation_Alloc:
       GB_ASSERT(alignment % 4 == 0);
-      size = ((size + 3) / 4) * 4;
-      pt = gb_pointer_add(pt, size);
-
-      // NOTE(bill): Wrap around
-      if (pt > end) {
-        header->size = gb_pointer_diff(header, end) | GB_ISIZE_HIGH_BIT;
-        pt = s->physical_start;
-        header = cast(gb_allocation_header_t *) pt;
-        data = gb_align_forward(header + 1, alignment);
-        pt = gb_pointer_add(pt, size);
-      }
-
-      if (!gb_scratch_memory_is_in_use(s, pt)) {
-        gb_allocation_header_fill(header, pt, gb_pointer_diff(header, pt));
-        s->alloc_point = cast(uint8_t *) pt;
-        ptr = data;
-      }
-
-      if (flags & gbAllocatorFlag_ClearToZero)
+      ptr = gb__scratch_alloc(s, size, alignment);
+      if (ptr && (flags & gbAllocatorFlag_ClearToZero))
         gb_zero_size(ptr, size);
-    }
       break;
 
     case gbAllocation_Free: {
@@ -727,7 +1963,7 @@ GB_ALLOCATOR_PROC(gb_scratch_allocator_proc) {
             if ((header->size & GB_ISIZE_HIGH_BIT) == 0)
               break;
 
-            s->free_point = gb_pointer_add(s->free_point, h->size & (~GB_ISIZE_HIGH_BIT));
+            s->free_point = gb_pointer_add(s->free_point, header->size & (~GB_ISIZE_HIGH_BIT));
             if (s->free_point == end)
               s->free_point = s->physical_start;
           }
@@ -739,10 +1975,564 @@ GB_ALLOCATOR_PROC(gb_scratch_allocator_proc) {
     case gbAllocation_FreeAll:
       s->alloc_point = s->physical_start;
       s->free_point = s->physical_start;
+      s->frame_point = s->physical_start;
+      break;
+
+    case gbAllocation_Resize:
+      ptr = gb_default_resize_align_flags(gb_scratch_allocator(s), old_memory, old_size, size, alignment, flags);
+      break;
+  }
+
+  return ptr;
+}
+
+gb_scratch_frame_t gb_scratch_frame_begin(gb_scratch_memory_t *s) {
+  gb_scratch_frame_t frame;
+  frame.scratch = s;
+  frame.alloc_point = s->alloc_point;
+  if (s->frame_count++ == 0)
+    s->frame_point = s->alloc_point;
+  return frame;
+}
+
+void gb_scratch_frame_end(gb_scratch_frame_t frame) {
+  gb_scratch_memory_t *s = frame.scratch;
+  void *from = frame.alloc_point, *to = s->alloc_point, *f = s->free_point;
+  GB_ASSERT(s->frame_count > 0);
+
+  // NOTE: Everything allocated since the frame began is dropped, if the free point reached that range all
+  // the older blocks were freed already and the ring is now empty from there
+  if (from <= to ? (f >= from && f <= to) : (f >= from || f <= to))
+    s->free_point = from;
+  s->alloc_point = from;
+  s->frame_count--;
+}
+
+
+//
+// Thread Scratch
+//
+
+gb_global gb_thread_local gb_scratch_memory_t gb__thread_scratch;
+
+#if !defined(GB_SYSTEM_WINDOWS)
+gb_global pthread_once_t gb__thread_scratch_key_once = PTHREAD_ONCE_INIT;
+gb_global pthread_key_t gb__thread_scratch_key;
+
+gb_internal void gb__thread_scratch_exit(void *data) {
+  gb_scratch_memory_t *s = cast(gb_scratch_memory_t *) data;
+  gb_vm_free(gb_virtual_memory(s->physical_start, s->total_size));
+  gb_zero_item(s);
+}
+
+gb_internal void gb__thread_scratch_key_init(void) {
+  pthread_key_create(&gb__thread_scratch_key, gb__thread_scratch_exit);
+}
+#endif
+
+gb_no_inline gb_internal gb_scratch_memory_t *gb__thread_scratch_init(gb_scratch_memory_t *s) {
+  gb_virtual_memory_t vm = gb_vm_alloc(NULL, GB_THREAD_SCRATCH_SIZE);
+  GB_ASSERT_MSG(vm.data != NULL, "Unable to map the thread scratch ring");
+  gb_scratch_memory_init(s, vm.data, vm.size);
+#if !defined(GB_SYSTEM_WINDOWS)
+  pthread_once(&gb__thread_scratch_key_once, gb__thread_scratch_key_init);
+  pthread_setspecific(gb__thread_scratch_key, s);
+#endif
+  // NOTE: Not released on Windows, see the Thread Scratch notes in gb/alloc.h
+  return s;
+}
+
+gb_inline gb_scratch_memory_t *gb_thread_scratch(void) {
+  gb_scratch_memory_t *s = &gb__thread_scratch;
+  if (s->physical_start == NULL)
+    s = gb__thread_scratch_init(s);
+  return s;
+}
+
+gb_inline gb_scratch_frame_t gb_thread_scratch_begin(void) {
+  return gb_scratch_frame_begin(gb_thread_scratch());
+}
+
+gb_inline gb_allocator_t gb_thread_scratch_allocator(void) {
+  gb_allocator_t a;
+  a.proc = gb_thread_scratch_allocator_proc;
+  a.data = gb_thread_scratch();
+  return a;
+}
+
+GB_ALLOCATOR_PROC(gb_thread_scratch_allocator_proc) {
+  gb_scratch_memory_t *s = cast(gb_scratch_memory_t *) allocator_data;
+  void *ptr = NULL;
+  GB_ASSERT_NOT_NULL(s);
+
+  switch (type) {
+    case gbAllocation_Alloc: {
+      void *end = gb_pointer_add(s->physical_start, s->total_size);
+      GB_ASSERT(alignment % 4 == 0);
+
+      // NOTE: Drop the oldest blocks until the request fits, never past the outermost open frame
+      while ((ptr = gb__scratch_alloc(s, size, alignment)) == NULL &&
+             s->free_point != (s->frame_count > 0 ? s->frame_point : s->alloc_point)) {
+        gb_allocation_header_t *header = cast(gb_allocation_header_t *) s->free_point;
+        s->free_point = gb_pointer_add(s->free_point, header->size & (~GB_ISIZE_HIGH_BIT));
+        if (s->free_point == end)
+          s->free_point = s->physical_start;
+      }
+      GB_ASSERT_MSG(ptr != NULL, "Thread scratch exhausted, %td bytes requested", size);
+      if (flags & gbAllocatorFlag_ClearToZero)
+        gb_zero_size(ptr, size);
+    }
+      break;
+
+    case gbAllocation_Free:
+      break;
+
+    case gbAllocation_FreeAll:
+      GB_ASSERT(s->frame_count == 0);
+      s->alloc_point = s->physical_start;
+      s->free_point = s->physical_start;
+      break;
+
+    case gbAllocation_Resize: {
+      gb_allocator_t a;
+      a.proc = gb_thread_scratch_allocator_proc;
+      a.data = s;
+      ptr = gb_default_resize_align_flags(a, old_memory, old_size, size, alignment, flags);
+    }
+      break;
+  }
+
+  return ptr;
+}
+
+//
+// Fixed Heap Allocator
+//
+
+#define GB__FIXED_HEAP_FL_SHIFT (GB_FIXED_HEAP_SL_LOG2 + (GB__FREE_LIST_GRANULE == 16 ? 4 : 3))
+#define GB__FIXED_HEAP_SMALL    (cast(ssize_t) 1 << GB__FIXED_HEAP_FL_SHIFT)
+#define GB__FIXED_HEAP_MAX      ((cast(ssize_t) 1 << (GB_FIXED_HEAP_FL_COUNT + GB__FIXED_HEAP_FL_SHIFT - 1)) - 1)
+
+GB_STATIC_ASSERT(GB__FIXED_HEAP_SMALL / GB_FIXED_HEAP_SL_COUNT == GB__FREE_LIST_GRANULE);
+
+gb_internal gb_inline ssize_t gb__fixed_heap_ffs(uint32_t mask) {
+  return gb_log2(mask & (~mask + 1));
+}
+
+gb_internal gb_inline void gb__fixed_heap_mapping(ssize_t size, ssize_t *fl, ssize_t *sl) {
+  if (size < GB__FIXED_HEAP_SMALL) {
+    *fl = 0;
+    *sl = size / GB__FREE_LIST_GRANULE;
+  } else {
+    ssize_t b = gb_log2(cast(uint64_t) size);
+    *fl = b - GB__FIXED_HEAP_FL_SHIFT + 1;
+    *sl = (size >> (b - GB_FIXED_HEAP_SL_LOG2)) ^ GB_FIXED_HEAP_SL_COUNT;
+  }
+}
+
+gb_internal gb_inline void gb__fixed_heap_insert(gb_fixed_heap_t *heap, gb_free_list_block_t *block, ssize_t size) {
+  ssize_t fl, sl;
+  gb__fixed_heap_mapping(size, &fl, &sl);
+
+  block->size = size | GB__FREE_LIST_PREV_USED;
+  *gb__fl_footer(block) = size;
+  gb__fl_next(block)->size &= ~cast(ssize_t) GB__FREE_LIST_PREV_USED;
+
+  block->prev = NULL;
+  block->next = heap->blocks[fl][sl];
+  if (block->next) block->next->prev = block;
+  heap->blocks[fl][sl] = block;
+  heap->fl_bitmap |= cast(uint32_t) 1 << fl;
+  heap->sl_bitmap[fl] |= cast(uint32_t) 1 << sl;
+
+  heap->total_free += size;
+  heap->free_block_count++;
+}
+
+gb_internal gb_inline void gb__fixed_heap_remove(gb_fixed_heap_t *heap, gb_free_list_block_t *block) {
+  ssize_t fl, sl, size = gb__fl_size(block);
+  gb__fixed_heap_mapping(size, &fl, &sl);
+
+  if (block->prev) block->prev->next = block->next;
+  else heap->blocks[fl][sl] = block->next;
+  if (block->next) block->next->prev = block->prev;
+  if (heap->blocks[fl][sl] == NULL) {
+    heap->sl_bitmap[fl] &= ~(cast(uint32_t) 1 << sl);
+    if (heap->sl_bitmap[fl] == 0)
+      heap->fl_bitmap &= ~(cast(uint32_t) 1 << fl);
+  }
+
+  heap->total_free -= size;
+  heap->free_block_count--;
+}
+
+// NOTE: Rounds the request up to the next list so whatever block heads it is big enough
+gb_internal gb_free_list_block_t *gb__fixed_heap_find(gb_fixed_heap_t *heap, ssize_t size) {
+  ssize_t fl, sl;
+  uint32_t sl_map, fl_map;
+
+  if (size > GB__FIXED_HEAP_MAX)
+    return NULL;
+  if (size >= GB__FIXED_HEAP_SMALL)
+    size += (cast(ssize_t) 1 << (gb_log2(cast(uint64_t) size) - GB_FIXED_HEAP_SL_LOG2)) - 1;
+  gb__fixed_heap_mapping(size, &fl, &sl);
+  if (fl >= GB_FIXED_HEAP_FL_COUNT)
+    return NULL;
+
+  sl_map = heap->sl_bitmap[fl] & (~cast(uint32_t) 0 << sl);
+  if (!sl_map) {
+    fl_map = fl + 1 < GB_FIXED_HEAP_FL_COUNT ? heap->fl_bitmap & (~cast(uint32_t) 0 << (fl + 1)) : 0;
+    if (!fl_map)
+      return NULL;
+    fl = gb__fixed_heap_ffs(fl_map);
+    sl_map = heap->sl_bitmap[fl];
+  }
+  sl = gb__fixed_heap_ffs(sl_map);
+  return heap->blocks[fl][sl];
+}
+
+gb_internal void gb__fixed_heap_use(gb_fixed_heap_t *heap, gb_free_list_block_t *block, ssize_t size) {
+  ssize_t block_size = gb__fl_size(block);
+  ssize_t prev_used = block->size & GB__FREE_LIST_PREV_USED;
+
+  if (block_size - size >= GB__FREE_LIST_MIN_BLOCK) {
+    block->size = size | prev_used | GB__FREE_LIST_USED;
+    gb__fixed_heap_insert(heap, gb__fl_next(block), block_size - size);
+  } else {
+    block->size = block_size | prev_used | GB__FREE_LIST_USED;
+    gb__fl_next(block)->size |= GB__FREE_LIST_PREV_USED;
+  }
+}
+
+gb_internal void gb__fixed_heap_release(gb_fixed_heap_t *heap, gb_free_list_block_t *block) {
+  ssize_t size = gb__fl_size(block);
+  gb_free_list_block_t *next = gb__fl_next(block);
+
+  if (!(next->size & GB__FREE_LIST_USED)) {
+    gb__fixed_heap_remove(heap, next);
+    size += gb__fl_size(next);
+  }
+  if (!(block->size & GB__FREE_LIST_PREV_USED)) {
+    ssize_t prev_size = *cast(ssize_t *) gb_pointer_sub(block, GB__FREE_LIST_WORD);
+    block = cast(gb_free_list_block_t *) gb_pointer_sub(block, prev_size);
+    gb__fixed_heap_remove(heap, block);
+    size += prev_size;
+  }
+  gb__fixed_heap_insert(heap, block, size);
+}
+
+// NOTE: Empties the heap, the region and its mapping are kept
+gb_internal void gb__fixed_heap_reset(gb_fixed_heap_t *heap) {
+  uintptr_t start = cast(uintptr_t) heap->physical_start, first, last;
+
+  first = ((start + GB__FREE_LIST_WORD + GB__FREE_LIST_GRANULE - 1) & ~cast(uintptr_t) (GB__FREE_LIST_GRANULE - 1)) - GB__FREE_LIST_WORD;
+  last = ((start + heap->total_size) & ~cast(uintptr_t) (GB__FREE_LIST_GRANULE - 1)) - GB__FREE_LIST_WORD;
+  GB_ASSERT(last > first && cast(ssize_t) (last - first) >= GB__FREE_LIST_MIN_BLOCK);
+  GB_ASSERT_MSG(cast(ssize_t) (last - first) <= GB__FIXED_HEAP_MAX, "Fixed heap region is too large");
+
+  heap->fl_bitmap = 0;
+  gb_zero_array(heap->sl_bitmap, GB_FIXED_HEAP_FL_COUNT);
+  gb_zero_array(heap->blocks, GB_FIXED_HEAP_FL_COUNT);
+  heap->total_allocated = heap->allocation_count = 0;
+  heap->total_free = heap->free_block_count = 0;
+
+  (cast(gb_free_list_block_t *) last)->size = GB__FREE_LIST_USED;
+  gb__fixed_heap_insert(heap, cast(gb_free_list_block_t *) first, cast(ssize_t) (last - first));
+}
+
+void gb_fixed_heap_init(gb_fixed_heap_t *heap, void *start, ssize_t size) {
+  gb_zero_item(heap);
+  heap->physical_start = start;
+  heap->total_size = size;
+  gb__fixed_heap_reset(heap);
+}
+
+void gb_fixed_heap_init_virtual(gb_fixed_heap_t *heap, ssize_t size) {
+  gb_virtual_memory_t vm = gb_vm_alloc(NULL, size);
+  GB_ASSERT_MSG(vm.data != NULL, "Unable to map the fixed heap");
+  gb_fixed_heap_init(heap, vm.data, vm.size);
+  heap->vm = vm;
+}
+
+void gb_fixed_heap_free(gb_fixed_heap_t *heap) {
+  if (heap->vm.data)
+    gb_vm_free(heap->vm);
+  gb_zero_item(heap);
+}
+
+gb_fixed_heap_stats_t gb_fixed_heap_stats(gb_fixed_heap_t *heap) {
+  gb_fixed_heap_stats_t stats = {0};
+  stats.total_size = heap->total_size;
+  stats.total_allocated = heap->total_allocated;
+  stats.allocation_count = heap->allocation_count;
+  stats.total_free = heap->total_free;
+  stats.free_block_count = heap->free_block_count;
+
+  // NOTE: The largest block sits in the highest non empty list
+  if (heap->fl_bitmap) {
+    ssize_t fl = gb_log2(heap->fl_bitmap);
+    gb_free_list_block_t *block = heap->blocks[fl][gb_log2(heap->sl_bitmap[fl])];
+    for (; block; block = block->next)
+      stats.largest_free_block = gb_max(stats.largest_free_block, gb__fl_size(block));
+    stats.fragmentation = 1.0f - cast(float32_t) stats.largest_free_block / cast(float32_t) stats.total_free;
+  }
+  return stats;
+}
+
+gb_inline gb_allocator_t gb_fixed_heap_allocator(gb_fixed_heap_t *heap) {
+  gb_allocator_t a;
+  a.proc = gb_fixed_heap_allocator_proc;
+  a.data = heap;
+  return a;
+}
+
+gb_internal void *gb__fixed_heap_alloc(gb_fixed_heap_t *heap, ssize_t size, ssize_t alignment, uint64_t flags) {
+  ssize_t block_size = gb__free_list_block_size(size);
+  gb_free_list_block_t *block;
+  void *ptr;
+
+  if (alignment <= GB__FREE_LIST_GRANULE) {
+    block = gb__fixed_heap_find(heap, block_size);
+    if (!block) return NULL;
+    gb__fixed_heap_remove(heap, block);
+  } else {
+    ssize_t lead;
+    GB_ASSERT(gb_is_power_of_two(alignment));
+    block = gb__fixed_heap_find(heap, block_size + alignment + GB__FREE_LIST_MIN_BLOCK);
+    if (!block) return NULL;
+    gb__fixed_heap_remove(heap, block);
+
+    ptr = gb_align_forward(gb_pointer_add(block, GB__FREE_LIST_WORD), alignment);
+    lead = gb_pointer_diff(block, ptr) - GB__FREE_LIST_WORD;
+    if (lead > 0 && lead < GB__FREE_LIST_MIN_BLOCK) {
+      ptr = gb_align_forward(gb_pointer_add(block, GB__FREE_LIST_WORD + GB__FREE_LIST_MIN_BLOCK), alignment);
+      lead = gb_pointer_diff(block, ptr) - GB__FREE_LIST_WORD;
+    }
+    if (lead > 0) {
+      gb_free_list_block_t *rest = cast(gb_free_list_block_t *) gb_pointer_add(block, lead);
+      rest->size = gb__fl_size(block) - lead;
+      block->size = lead | (block->size & GB__FREE_LIST_PREV_USED);
+      gb__fixed_heap_insert(heap, block, lead);
+      block = rest;
+    }
+  }
+
+  gb__fixed_heap_use(heap, block, block_size);
+  ptr = gb_pointer_add(block, GB__FREE_LIST_WORD);
+
+  heap->total_allocated += gb__fl_size(block);
+  heap->allocation_count++;
+
+  if (flags & gbAllocatorFlag_ClearToZero)
+    gb_zero_size(ptr, size);
+  return ptr;
+}
+
+gb_internal void gb__fixed_heap_free(gb_fixed_heap_t *heap, void *ptr) {
+  gb_free_list_block_t *block = cast(gb_free_list_block_t *) gb_pointer_sub(ptr, GB__FREE_LIST_WORD);
+  GB_ASSERT_MSG(block->size & GB__FREE_LIST_USED, "Double free");
+
+  heap->total_allocated -= gb__fl_size(block);
+  heap->allocation_count--;
+  gb__fixed_heap_release(heap, block);
+}
+
+GB_ALLOCATOR_PROC(gb_fixed_heap_allocator_proc) {
+  gb_fixed_heap_t *heap = cast(gb_fixed_heap_t *) allocator_data;
+  void *ptr = NULL;
+
+  GB_ASSERT_NOT_NULL(heap);
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb__fixed_heap_alloc(heap, size, alignment, flags);
+      break;
+
+    case gbAllocation_Free:
+      if (old_memory) gb__fixed_heap_free(heap, old_memory);
+      break;
+
+    case gbAllocation_FreeAll:
+      gb__fixed_heap_reset(heap);
+      break;
+
+    case gbAllocation_Resize: {
+      gb_free_list_block_t *block, *next;
+      ssize_t block_size, curr_size;
+      byte32_t in_place;
+
+      if (!old_memory) return gb__fixed_heap_alloc(heap, size, alignment, flags);
+      if (size == 0) {
+        gb__fixed_heap_free(heap, old_memory);
+        return NULL;
+      }
+
+      block = cast(gb_free_list_block_t *) gb_pointer_sub(old_memory, GB__FREE_LIST_WORD);
+      block_size = gb__free_list_block_size(size);
+      curr_size = gb__fl_size(block);
+      next = gb__fl_next(block);
+
+      in_place = (cast(uintptr_t) old_memory & (alignment - 1)) == 0;
+
+      // NOTE: Grow into the next block when it is free, shrinking gives the tail back
+      if (in_place && block_size > curr_size && !(next->size & GB__FREE_LIST_USED) &&
+          curr_size + gb__fl_size(next) >= block_size) {
+        gb__fixed_heap_remove(heap, next);
+        block->size += gb__fl_size(next);
+        gb__fl_next(block)->size |= GB__FREE_LIST_PREV_USED;
+      }
+      if (in_place && block_size <= gb__fl_size(block)) {
+        ssize_t tail = gb__fl_size(block) - block_size;
+        heap->total_allocated -= curr_size;
+        if (tail >= GB__FREE_LIST_MIN_BLOCK) {
+          gb_free_list_block_t *rest = cast(gb_free_list_block_t *) gb_pointer_add(block, block_size);
+          block->size -= tail;
+          rest->size = tail | GB__FREE_LIST_PREV_USED | GB__FREE_LIST_USED;
+          gb__fixed_heap_release(heap, rest);
+        }
+        heap->total_allocated += gb__fl_size(block);
+        if ((flags & gbAllocatorFlag_ClearToZero) && size > old_size)
+          gb_zero_size(gb_pointer_add(old_memory, old_size), size - old_size);
+        return old_memory;
+      }
+
+      ptr = gb__fixed_heap_alloc(heap, size, alignment, flags);
+      if (!ptr) return NULL;
+      gb_memcopy(ptr, old_memory, gb_min(size, old_size));
+      gb__fixed_heap_free(heap, old_memory);
+    }
+      break;
+  }
+
+  return ptr;
+}
+
+//
+// Stack Allocator
+//
+
+typedef struct gb__stack_header {
+  ssize_t prev_allocated;
+  ssize_t prev_top;
+} gb__stack_header_t;
+
+gb_inline void gb_stack_init_from_memory(gb_stack_t *stack, void *start, ssize_t size) {
+  gb_zero_item(stack);
+  stack->physical_start = start;
+  stack->total_size = size;
+  stack->top = -1;
+}
+
+gb_inline void gb_stack_init_from_allocator(gb_stack_t *stack, gb_allocator_t backing, ssize_t size) {
+  gb_stack_init_from_memory(stack, gb_alloc(backing, size), size);
+  stack->backing = backing;
+}
+
+gb_inline void gb_stack_free(gb_stack_t *stack) {
+  if (stack->backing.proc) {
+    gb_free(stack->backing, stack->physical_start);
+    stack->physical_start = NULL;
+  }
+}
+
+gb_inline gb_stack_marker_t gb_stack_push_marker(gb_stack_t *stack) {
+  gb_stack_marker_t marker;
+  marker.stack = stack;
+  marker.total_allocated = stack->total_allocated;
+  marker.top = stack->top;
+  stack->marker_count++;
+  return marker;
+}
+
+gb_inline void gb_stack_pop_marker(gb_stack_marker_t marker) {
+  GB_ASSERT(marker.stack->total_allocated >= marker.total_allocated);
+  GB_ASSERT(marker.stack->marker_count > 0);
+  marker.stack->total_allocated = marker.total_allocated;
+  marker.stack->top = marker.top;
+  marker.stack->marker_count--;
+}
+
+gb_inline gb_allocator_t gb_stack_allocator(gb_stack_t *stack) {
+  gb_allocator_t allocator;
+  allocator.proc = gb_stack_allocator_proc;
+  allocator.data = stack;
+  return allocator;
+}
+
+gb_internal void *gb__stack_alloc(gb_stack_t *stack, ssize_t size, ssize_t alignment, uint64_t flags) {
+  gb__stack_header_t *header;
+  void *start = gb_pointer_add(stack->physical_start, stack->total_allocated + gb_size_of(gb__stack_header_t));
+  void *ptr = gb_align_forward(start, gb_max(alignment, gb_size_of(ssize_t)));
+  ssize_t offset = gb_pointer_diff(stack->physical_start, ptr);
+
+  if (offset + size > stack->total_size)
+    return NULL;
+
+  header = cast(gb__stack_header_t *) ptr - 1;
+  header->prev_allocated = stack->total_allocated;
+  header->prev_top = stack->top;
+  stack->total_allocated = offset + size;
+  stack->top = offset;
+
+  if (flags & gbAllocatorFlag_ClearToZero)
+    gb_zero_size(ptr, size);
+  return ptr;
+}
+
+gb_internal gb_inline byte32_t gb__stack_is_top(gb_stack_t *stack, void *ptr) {
+  return stack->top >= 0 && ptr == gb_pointer_add(stack->physical_start, stack->top);
+}
+
+GB_ALLOCATOR_PROC(gb_stack_allocator_proc) {
+  gb_stack_t *stack = cast(gb_stack_t *) allocator_data;
+  void *ptr = NULL;
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb__stack_alloc(stack, size, alignment, flags);
+      break;
+
+    case gbAllocation_Free: {
+      gb__stack_header_t *header;
+      if (old_memory == NULL) return NULL;
+      GB_ASSERT_MSG(gb__stack_is_top(stack, old_memory), "Stack allocations must be freed in LIFO order");
+
+      header = cast(gb__stack_header_t *) old_memory - 1;
+      stack->total_allocated = header->prev_allocated;
+      stack->top = header->prev_top;
+    }
+      break;
+
+    case gbAllocation_FreeAll:
+      GB_ASSERT(stack->marker_count == 0);
+      stack->total_allocated = 0;
+      stack->top = -1;
       break;
 
     case gbAllocation_Resize:
-      ptr = gb_default_resize_align(gb_scratch_allocator(s), old_memory, old_size, size, alignment);
+      if (old_memory == NULL)
+        return gb__stack_alloc(stack, size, alignment, flags);
+
+      // NOTE: The top moves in place, anything below it is copied and stays behind
+      if (gb__stack_is_top(stack, old_memory) && (cast(uintptr_t) old_memory & (alignment - 1)) == 0) {
+        if (size == 0) {
+          gb__stack_header_t *header = cast(gb__stack_header_t *) old_memory - 1;
+          stack->total_allocated = header->prev_allocated;
+          stack->top = header->prev_top;
+          return NULL;
+        }
+        if (stack->top + size > stack->total_size)
+          return NULL;
+        stack->total_allocated = stack->top + size;
+        if ((flags & gbAllocatorFlag_ClearToZero) && size > old_size)
+          gb_zero_size(gb_pointer_add(old_memory, old_size), size - old_size);
+        return old_memory;
+      }
+
+      if (size == 0)
+        return NULL;
+      ptr = gb__stack_alloc(stack, size, alignment, flags);
+      if (ptr) gb_memcopy(ptr, old_memory, gb_min(size, old_size));
       break;
   }
 
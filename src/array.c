@@ -26,8 +26,9 @@
  */
 
 #include "gb/array.h"
+#include "gb/track.h"
 
-gb_no_inline void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t element_size) {
+gb_no_inline void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t element_size, char const *file, int32_t line) {
   gbArrayHeader *h = GB_ARRAY_HEADER(array);
 
   GB_ASSERT(element_size > 0);
@@ -40,19 +41,54 @@ gb_no_inline void *gb__array_set_capacity(void *array, ssize_t capacity, ssize_t
       ssize_t new_capacity = GB_ARRAY_GROW_FORMULA(h->capacity);
       if (new_capacity < capacity)
         new_capacity = capacity;
-      gb__array_set_capacity(array, new_capacity, element_size);
+      gb__array_set_capacity(array, new_capacity, element_size, file, line);
     }
     h->count = capacity;
   }
 
+  // NOTE: Through resize so the allocator can grow the block in place (arena or stack top, remapped heap
+  // blocks), the header keeps its offset as the alignment does not change
   {
-    ssize_t size = gb_size_of(gbArrayHeader) + element_size * capacity;
-    gbArrayHeader *nh = cast(gbArrayHeader *) gb_alloc(h->allocator, size);
-    gb_memmove(nh, h, gb_size_of(gbArrayHeader) + element_size * h->count);
-    nh->allocator = h->allocator;
-    nh->count = h->count;
+    ssize_t offset = GB_ARRAY_HEADER_OFFSET(h->alignment);
+    void *block = gb_resize_at(h->allocator, GB_ARRAY_BLOCK(array), offset + element_size * h->capacity,
+                               offset + element_size * capacity, h->alignment, 0, file, line);
+    gbArrayHeader *nh = cast(gbArrayHeader *) gb_pointer_add(block, offset) - 1;
     nh->capacity = capacity;
-    gb_free(h->allocator, h);
     return nh + 1;
   }
 }
+
+gb_no_inline void *gb__small_array_set_capacity(gb_allocator_t a, void *data, void *inline_data, ssize_t inline_capacity,
+                                                ssize_t *count, ssize_t *capacity, ssize_t new_capacity,
+                                                ssize_t element_size, ssize_t alignment, char const *file, int32_t line) {
+  void *new_data;
+
+  GB_ASSERT(element_size > 0);
+
+  if (new_capacity < *count)
+    *count = new_capacity;
+
+  // NOTE: Back to the inline storage once everything fits again
+  if (new_capacity <= inline_capacity) {
+    if (data != inline_data) {
+      gb_memcopy(inline_data, data, element_size * *count);
+      gb_free(a, data);
+    }
+    *capacity = inline_capacity;
+    return inline_data;
+  }
+
+  if (new_capacity == *capacity)
+    return data;
+
+  if (data == inline_data) {
+    new_data = gb_alloc_at(a, element_size * new_capacity, gb_max(alignment, GB_DEFAULT_MEMORY_ALIGNMENT), 0,
+                           file, line);
+    gb_memcopy(new_data, data, element_size * *count);
+  } else {
+    new_data = gb_resize_at(a, data, element_size * *capacity, element_size * new_capacity,
+                            gb_max(alignment, GB_DEFAULT_MEMORY_ALIGNMENT), 0, file, line);
+  }
+  *capacity = new_capacity;
+  return new_data;
+}
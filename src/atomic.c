@@ -369,11 +369,11 @@ gb_inline int64_t gb_atomic64_fetch_or(gbAtomic64 volatile *a, int64_t operand)
 #endif
 
 gb_inline byte32_t gb_atomic32_spin_lock(gbAtomic32 volatile *a, ssize_t time_out) {
-  int32_t old_value = gb_atomic32_compare_exchange(a, 1, 0);
+  int32_t old_value = gb_atomic32_compare_exchange(a, 0, 1);
   int32_t counter = 0;
   while (old_value != 0 && (time_out < 0 || counter++ < time_out)) {
     gb_yield_thread();
-    old_value = gb_atomic32_compare_exchange(a, 1, 0);
+    old_value = gb_atomic32_compare_exchange(a, 0, 1);
     gb_mfence();
   }
   return old_value == 0;
@@ -385,11 +385,11 @@ gb_inline void gb_atomic32_spin_unlock(gbAtomic32 volatile *a) {
 }
 
 gb_inline byte32_t gb_atomic64_spin_lock(gbAtomic64 volatile *a, ssize_t time_out) {
-  int64_t old_value = gb_atomic64_compare_exchange(a, 1, 0);
+  int64_t old_value = gb_atomic64_compare_exchange(a, 0, 1);
   int64_t counter = 0;
   while (old_value != 0 && (time_out < 0 || counter++ < time_out)) {
     gb_yield_thread();
-    old_value = gb_atomic64_compare_exchange(a, 1, 0);
+    old_value = gb_atomic64_compare_exchange(a, 0, 1);
     gb_mfence();
   }
   return old_value == 0;
@@ -403,7 +403,7 @@ gb_inline void gb_atomic64_spin_unlock(gbAtomic64 volatile *a) {
 gb_inline byte32_t gb_atomic32_try_acquire_lock(gbAtomic32 volatile *a) {
   int32_t old_value;
   gb_yield_thread();
-  old_value = gb_atomic32_compare_exchange(a, 1, 0);
+  old_value = gb_atomic32_compare_exchange(a, 0, 1);
   gb_mfence();
   return old_value == 0;
 }
@@ -411,7 +411,7 @@ gb_inline byte32_t gb_atomic32_try_acquire_lock(gbAtomic32 volatile *a) {
 gb_inline byte32_t gb_atomic64_try_acquire_lock(gbAtomic64 volatile *a) {
   int64_t old_value;
   gb_yield_thread();
-  old_value = gb_atomic64_compare_exchange(a, 1, 0);
+  old_value = gb_atomic64_compare_exchange(a, 0, 1);
   gb_mfence();
   return old_value == 0;
 }
@@ -25,8 +25,21 @@
  * For more information, please refer to <http://unlicense.org>
  */
 
+// NOTE: Before any header, gb/string.h pulls in <string.h> ahead of the _GNU_SOURCE of gb/compiler.h so
+// realpath, pread, pwrite and ftruncate would not be declared under -std=c99
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include "gb/fs.h"
 
+#if !defined(GB_SYSTEM_WINDOWS)
+#include <limits.h>
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+#endif
+
 #if defined(GB_SYSTEM_WINDOWS)
 gb_internal GB_FILE_SEEK_PROC(gb__win32_file_seek) {
     LARGE_INTEGER li_offset;
@@ -378,9 +391,11 @@ gbFileError gb_file_truncate(gbFile *f, int64_t size) {
 
 byte32_t gb_file_exists(char const *name) {
   WIN32_FIND_DATAW data;
+  gb_scratch_frame_t frame = gb_thread_scratch_begin();
   void *handle = FindFirstFileW(cast(wchar_t const *)gb_utf8_to_ucs2_buf(cast(uint8_t *)name), &data);
   byte32_t found = handle != INVALID_HANDLE_VALUE;
   if (found) FindClose(handle);
+  gb_scratch_frame_end(frame);
   return found;
 }
 
@@ -507,7 +522,7 @@ gbFileContents gb_file_read_contents(gb_allocator_t a, byte32_t zero_terminate,
   if (gb_file_open(&file, filepath) == gbFileError_None) {
     ssize_t file_size = cast(ssize_t) gb_file_size(&file);
     if (file_size > 0) {
-      result.data = gb_alloc(a, zero_terminate ? file_size + 1 : file_size);
+      result.data = gb_alloc_uninit(a, zero_terminate ? file_size + 1 : file_size);
       result.size = file_size;
       gb_file_read_at(&file, result.data, result.size, 0);
       if (zero_terminate) {
@@ -573,24 +588,33 @@ GB_DLL_IMPORT DWORD WINAPI GetFullPathNameA(char const *lpFileName, DWORD nBuffe
 #endif
 
 char *gb_path_get_full_name(gb_allocator_t a, char const *path) {
+  gb_scratch_frame_t frame = gb_thread_scratch_begin();
+  char *buf, *ret;
+  ssize_t len;
 #if defined(GB_SYSTEM_WINDOWS)
+  DWORD size = MAX_PATH;
   // TODO(bill): Make UTF-8
-  char buf[300];
-  ssize_t len = GetFullPathNameA(path, gb_count_of(buf), buf, NULL);
-  return gb_alloc_str_len(a, buf, len+1);
+  buf = cast(char *) gb_alloc_uninit(gb_thread_scratch_allocator(), size);
+  len = GetFullPathNameA(path, size, buf, NULL);
+  if (len >= size) {
+    // NOTE: Too long, the required size (terminator included) was returned instead
+    size = cast(DWORD) len;
+    buf = cast(char *) gb_alloc_uninit(gb_thread_scratch_allocator(), size);
+    len = GetFullPathNameA(path, size, buf, NULL);
+  }
+  GB_ASSERT_MSG(len > 0 && len < size, "Unable to get the full path of %s", path);
 #else
-// TODO(bill): Make work on *nix, etc.
-  char *p = realpath(path, 0);
-  GB_ASSERT(p && "file does not exist");
-
-  ssize_t len = gb_strlen(p);
+  buf = cast(char *) gb_alloc_uninit(gb_thread_scratch_allocator(), PATH_MAX);
+  buf = realpath(path, buf);
+  GB_ASSERT(buf && "file does not exist");
+  len = gb_strlen(buf);
+#endif
 
-// bill... gb_alloc_str_len refused to work for this...
-  char *ret = gb_alloc(a, sizeof(char) * len + 1);
-  gb_memmove(ret, p, len);
+  // NOTE: The frame ends first so `a` may be the thread scratch itself, the result can then land over buf
+  // (nothing else runs in between), hence an uncleared block and gb_memmove
+  gb_scratch_frame_end(frame);
+  ret = cast(char *) gb_alloc_uninit(a, len + 1);
+  gb_memmove(ret, buf, len);
   ret[len] = 0;
-  free(p);
-
   return ret;
-#endif
 }
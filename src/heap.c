@@ -0,0 +1,568 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/heap.h"
+
+GB_STATIC_ASSERT(GB_HEAP_SEGMENT_SIZE % GB_HEAP_SPAN_SIZE == 0);
+GB_STATIC_ASSERT(GB_HEAP_MAX_SMALL_SIZE <= GB_HEAP_SPAN_SIZE / 2);
+
+typedef struct gb__heap_span gb__heap_span_t;
+typedef struct gb__heap_segment gb__heap_segment_t;
+typedef struct gb__heap_central gb__heap_central_t;
+typedef struct gb__heap_cache gb__heap_cache_t;
+
+struct gb__heap_span {
+  gb__heap_span_t *next;
+  gb__heap_span_t *prev;
+  void *free_list;
+  ssize_t carved;      // NOTE: Blocks are carved lazily from the start of the span
+  int32_t size_class;  // NOTE: -1 when the span is not in use
+  int32_t used;
+};
+
+struct gb__heap_segment {
+  gb_virtual_memory_t vm;
+  byte32_t is_large;
+  ssize_t free_spans;
+  gb__heap_span_t spans[GB_HEAP_SPANS_PER_SEGMENT];
+};
+
+// NOTE: The first span of a segment holds its header
+GB_STATIC_ASSERT(gb_size_of(gb__heap_segment_t) <= GB_HEAP_SPAN_SIZE);
+
+// NOTE: Full batches parked by thread caches, handed back out without touching the spans
+#define GB__HEAP_TRANSFER_SLOTS 64
+
+struct gb__heap_central {
+  gbAtomic32 lock;
+  gb__heap_span_t *spans; // NOTE: Spans with at least one free block
+  int32_t transfer_count;
+  void *transfer[GB__HEAP_TRANSFER_SLOTS];
+  uint8_t padding[GB_CACHE_LINE_SIZE];
+};
+
+struct gb__heap_cache {
+  void *lists[GB_HEAP_CLASS_COUNT];
+  int32_t counts[GB_HEAP_CLASS_COUNT];
+  byte32_t is_registered;
+};
+
+gb_global gb__heap_central_t gb__heap_centrals[GB_HEAP_CLASS_COUNT];
+
+gb_global gbAtomic32 gb__heap_page_lock;
+gb_global gb__heap_span_t *gb__heap_free_spans;
+gb_global ssize_t gb__heap_empty_segments;
+
+gb_global gb_thread_local gb__heap_cache_t gb__heap_cache;
+
+#if !defined(GB_SYSTEM_WINDOWS)
+gb_global pthread_once_t gb__heap_key_once = PTHREAD_ONCE_INIT;
+gb_global pthread_key_t gb__heap_key;
+#endif
+
+
+// NOTE: Spin for a bit then give the time slice away, the holder may have been preempted
+gb_internal gb_inline void gb__heap_lock(gbAtomic32 *lock) {
+  while (!gb_atomic32_spin_lock(lock, 64))
+    gb_yield();
+}
+
+ssize_t gb_heap_size_class(ssize_t size) {
+  ssize_t b;
+  if (size <= 128)
+    return size <= 16 ? 0 : (size - 1) / 16;
+  GB_ASSERT(size <= GB_HEAP_MAX_SMALL_SIZE);
+  b = gb_log2(cast(uint64_t) (size - 1));
+  return 8 + (b - 7) * 4 + (((size - 1) >> (b - 2)) - 4);
+}
+
+ssize_t gb_heap_class_size(ssize_t size_class) {
+  ssize_t k, b;
+  GB_ASSERT(size_class >= 0 && size_class < GB_HEAP_CLASS_COUNT);
+  if (size_class < 8)
+    return (size_class + 1) * 16;
+  k = size_class - 8;
+  b = 7 + k / 4;
+  return (cast(ssize_t) 1 << b) + ((k % 4) + 1) * (cast(ssize_t) 1 << (b - 2));
+}
+
+// NOTE: Number of blocks moved between a thread cache and the central list at once
+gb_internal gb_inline int32_t gb__heap_batch_count(ssize_t size_class) {
+  ssize_t count = gb_kilobytes(8) / gb_heap_class_size(size_class);
+  return cast(int32_t) gb_clamp(count, 2, 32);
+}
+
+gb_internal gb_inline gb__heap_segment_t *gb__heap_segment_of(void const *ptr) {
+  return cast(gb__heap_segment_t *) (cast(uintptr_t) ptr & ~cast(uintptr_t) (GB_HEAP_SEGMENT_SIZE - 1));
+}
+
+gb_internal gb_inline gb__heap_span_t *gb__heap_span_of(void const *ptr) {
+  gb__heap_segment_t *seg = gb__heap_segment_of(ptr);
+  return &seg->spans[gb_pointer_diff(seg, ptr) / GB_HEAP_SPAN_SIZE];
+}
+
+gb_internal gb_inline void *gb__heap_span_start(gb__heap_span_t *span) {
+  gb__heap_segment_t *seg = gb__heap_segment_of(span);
+  return gb_pointer_add(seg, (span - seg->spans) * GB_HEAP_SPAN_SIZE);
+}
+
+gb_internal gb_inline byte32_t gb__heap_span_is_full(gb__heap_span_t *span) {
+  return span->free_list == NULL && span->carved + gb_heap_class_size(span->size_class) > GB_HEAP_SPAN_SIZE;
+}
+
+// NOTE: Reserves `size` bytes aligned to GB_HEAP_SEGMENT_SIZE
+gb_internal gb_virtual_memory_t gb__heap_vm_alloc(ssize_t size) {
+  gb_virtual_memory_t vm = gb_vm_alloc(NULL, size + GB_HEAP_SEGMENT_SIZE);
+  ssize_t lead_size;
+  if (vm.data == NULL)
+    return vm;
+  lead_size = gb_pointer_diff(vm.data, gb_align_forward(vm.data, GB_HEAP_SEGMENT_SIZE));
+  return gb_vm_trim(vm, lead_size, size);
+}
+
+
+//
+// Page Heap
+//
+
+gb_internal gb_inline void gb__heap_span_link(gb__heap_span_t **list, gb__heap_span_t *span) {
+  span->prev = NULL;
+  span->next = *list;
+  if (*list) (*list)->prev = span;
+  *list = span;
+}
+
+gb_internal gb_inline void gb__heap_span_unlink(gb__heap_span_t **list, gb__heap_span_t *span) {
+  if (span->prev) span->prev->next = span->next;
+  else *list = span->next;
+  if (span->next) span->next->prev = span->prev;
+  span->next = span->prev = NULL;
+}
+
+gb_internal gb__heap_span_t *gb__heap_span_alloc(int32_t size_class) {
+  gb__heap_span_t *span;
+  gb__heap_segment_t *seg;
+
+  gb__heap_lock(&gb__heap_page_lock);
+  if (gb__heap_free_spans == NULL) {
+    ssize_t i;
+    gb_virtual_memory_t vm = gb__heap_vm_alloc(GB_HEAP_SEGMENT_SIZE);
+    if (vm.data == NULL) {
+      gb_atomic32_spin_unlock(&gb__heap_page_lock);
+      return NULL;
+    }
+    seg = cast(gb__heap_segment_t *) vm.data;
+    seg->vm = vm;
+    seg->is_large = false;
+    seg->free_spans = GB_HEAP_SPANS_PER_SEGMENT - 1;
+    seg->spans[0].size_class = -1;
+    for (i = GB_HEAP_SPANS_PER_SEGMENT - 1; i > 0; i--) {
+      seg->spans[i].size_class = -1;
+      gb__heap_span_link(&gb__heap_free_spans, &seg->spans[i]);
+    }
+    gb__heap_empty_segments++;
+  }
+
+  span = gb__heap_free_spans;
+  gb__heap_span_unlink(&gb__heap_free_spans, span);
+  seg = gb__heap_segment_of(span);
+  if (seg->free_spans-- == GB_HEAP_SPANS_PER_SEGMENT - 1)
+    gb__heap_empty_segments--;
+  gb_atomic32_spin_unlock(&gb__heap_page_lock);
+
+  span->free_list = NULL;
+  span->carved = 0;
+  span->size_class = size_class;
+  span->used = 0;
+  return span;
+}
+
+gb_internal void gb__heap_span_release(gb__heap_span_t *span) {
+  gb__heap_segment_t *seg = gb__heap_segment_of(span);
+
+  span->size_class = -1;
+
+  gb__heap_lock(&gb__heap_page_lock);
+  gb__heap_span_link(&gb__heap_free_spans, span);
+  if (++seg->free_spans == GB_HEAP_SPANS_PER_SEGMENT - 1) {
+    if (gb__heap_empty_segments < GB_HEAP_RETAINED_SEGMENTS) {
+      gb__heap_empty_segments++;
+    } else {
+      ssize_t i;
+      for (i = 1; i < GB_HEAP_SPANS_PER_SEGMENT; i++)
+        gb__heap_span_unlink(&gb__heap_free_spans, &seg->spans[i]);
+      gb_vm_free(seg->vm);
+    }
+  }
+  gb_atomic32_spin_unlock(&gb__heap_page_lock);
+}
+
+
+//
+// Central Free Lists
+//
+
+// NOTE: Pops up to `count` blocks as an intrusive list into `*list`, returns the amount
+gb_internal int32_t gb__heap_central_fetch(int32_t size_class, void **list, int32_t count) {
+  gb__heap_central_t *c = &gb__heap_centrals[size_class];
+  ssize_t block_size = gb_heap_class_size(size_class);
+  int32_t n = 0;
+  void *head = NULL;
+
+  gb__heap_lock(&c->lock);
+  if (count == gb__heap_batch_count(size_class) && c->transfer_count > 0) {
+    *list = c->transfer[--c->transfer_count];
+    gb_atomic32_spin_unlock(&c->lock);
+    return count;
+  }
+  while (n < count) {
+    gb__heap_span_t *span = c->spans;
+    void *block;
+    if (span == NULL) {
+      span = gb__heap_span_alloc(size_class);
+      if (span == NULL)
+        break;
+      gb__heap_span_link(&c->spans, span);
+    }
+
+    if (span->free_list) {
+      block = span->free_list;
+      span->free_list = *cast(void **) block;
+    } else {
+      block = gb_pointer_add(gb__heap_span_start(span), span->carved);
+      span->carved += block_size;
+    }
+    span->used++;
+    if (gb__heap_span_is_full(span))
+      gb__heap_span_unlink(&c->spans, span);
+
+    *cast(void **) block = head;
+    head = block;
+    n++;
+  }
+  gb_atomic32_spin_unlock(&c->lock);
+
+  *list = head;
+  return n;
+}
+
+gb_internal void gb__heap_central_release(int32_t size_class, void *list, int32_t count) {
+  gb__heap_central_t *c = &gb__heap_centrals[size_class];
+
+  gb__heap_lock(&c->lock);
+  if (count == gb__heap_batch_count(size_class) && c->transfer_count < GB__HEAP_TRANSFER_SLOTS) {
+    c->transfer[c->transfer_count++] = list;
+    gb_atomic32_spin_unlock(&c->lock);
+    return;
+  }
+  while (list) {
+    void *next = *cast(void **) list;
+    gb__heap_span_t *span = gb__heap_span_of(list);
+    byte32_t was_full = gb__heap_span_is_full(span);
+
+    *cast(void **) list = span->free_list;
+    span->free_list = list;
+    if (was_full)
+      gb__heap_span_link(&c->spans, span);
+
+    if (--span->used == 0) {
+      gb__heap_span_unlink(&c->spans, span);
+      gb__heap_span_release(span);
+    }
+    list = next;
+  }
+  gb_atomic32_spin_unlock(&c->lock);
+}
+
+
+//
+// Thread Cache
+//
+
+gb_internal void gb__heap_cache_flush(gb__heap_cache_t *cache) {
+  ssize_t i;
+  for (i = 0; i < GB_HEAP_CLASS_COUNT; i++) {
+    if (cache->lists[i]) {
+      gb__heap_central_release(cast(int32_t) i, cache->lists[i], cache->counts[i]);
+      cache->lists[i] = NULL;
+      cache->counts[i] = 0;
+    }
+  }
+}
+
+#if !defined(GB_SYSTEM_WINDOWS)
+gb_internal void gb__heap_thread_exit(void *data) {
+  gb__heap_cache_flush(cast(gb__heap_cache_t *) data);
+}
+
+gb_internal void gb__heap_key_init(void) {
+  pthread_key_create(&gb__heap_key, gb__heap_thread_exit);
+}
+#endif
+
+gb_internal void gb__heap_cache_register(gb__heap_cache_t *cache) {
+#if !defined(GB_SYSTEM_WINDOWS)
+  pthread_once(&gb__heap_key_once, gb__heap_key_init);
+  pthread_setspecific(gb__heap_key, cache);
+#endif
+  // NOTE: Nothing flushes it on Windows, see gb/heap.h
+  cache->is_registered = true;
+}
+
+gb_no_inline gb_internal void *gb__heap_cache_refill(gb__heap_cache_t *cache, int32_t size_class) {
+  void *list;
+  int32_t n;
+
+  if (!cache->is_registered)
+    gb__heap_cache_register(cache);
+
+  n = gb__heap_central_fetch(size_class, &list, gb__heap_batch_count(size_class));
+  if (n == 0)
+    return NULL;
+
+  cache->lists[size_class] = *cast(void **) list;
+  cache->counts[size_class] = n - 1;
+  return list;
+}
+
+gb_no_inline gb_internal void gb__heap_cache_scavenge(gb__heap_cache_t *cache, int32_t size_class) {
+  int32_t i, n = gb__heap_batch_count(size_class);
+  void *list = cache->lists[size_class], *last = list;
+
+  for (i = 1; i < n; i++)
+    last = *cast(void **) last;
+  cache->lists[size_class] = *cast(void **) last;
+  cache->counts[size_class] -= n;
+  *cast(void **) last = NULL;
+
+  gb__heap_central_release(size_class, list, n);
+}
+
+void gb_heap_thread_flush(void) {
+  gb__heap_cache_flush(&gb__heap_cache);
+}
+
+
+//
+// Large Blocks
+//
+
+#define GB__HEAP_LARGE_HEADER_SIZE gb_offset_of(gb__heap_segment_t, spans)
+
+gb_internal void *gb__heap_large_alloc(ssize_t size, ssize_t alignment) {
+  ssize_t page_size = gb_virtual_memory_page_size(NULL);
+  ssize_t offset = GB__HEAP_LARGE_HEADER_SIZE;
+  ssize_t total_size;
+  gb_virtual_memory_t vm;
+  gb__heap_segment_t *seg;
+
+  GB_ASSERT(alignment < GB_HEAP_SEGMENT_SIZE);
+  offset = (offset + alignment - 1) & ~(alignment - 1);
+  total_size = (offset + size + page_size - 1) & ~(page_size - 1);
+
+  vm = gb__heap_vm_alloc(total_size);
+  if (vm.data == NULL)
+    return NULL;
+
+  seg = cast(gb__heap_segment_t *) vm.data;
+  seg->vm = vm;
+  seg->is_large = true;
+  return gb_pointer_add(seg, offset);
+}
+
+#if defined(GB_SYSTEM_LINUX)
+// NOTE: Resizes the mapping of a large block without copying it, a move lands on a fresh segment aligned
+// range which mremap replaces in one go. Returns NULL when the kernel refuses.
+gb_internal void *gb__heap_large_remap(gb__heap_segment_t *seg, void *ptr, ssize_t new_size) {
+  ssize_t page_size = gb_virtual_memory_page_size(NULL);
+  ssize_t offset = gb_pointer_diff(seg, ptr);
+  ssize_t total_size = (offset + new_size + page_size - 1) & ~(page_size - 1);
+  gb_virtual_memory_t dst;
+  void *moved;
+
+  if (total_size == seg->vm.size)
+    return ptr;
+  if (mremap(seg->vm.data, seg->vm.size, total_size, 0) != MAP_FAILED) {
+    seg->vm.size = total_size;
+    return ptr;
+  }
+
+  dst = gb__heap_vm_alloc(total_size);
+  if (dst.data == NULL)
+    return NULL;
+  moved = mremap(seg->vm.data, seg->vm.size, total_size, MREMAP_MAYMOVE | MREMAP_FIXED, dst.data);
+  if (moved == MAP_FAILED) {
+    gb_vm_free(dst);
+    return NULL;
+  }
+  seg = cast(gb__heap_segment_t *) moved;
+  seg->vm = gb_virtual_memory(moved, total_size);
+  return gb_pointer_add(seg, offset);
+}
+#endif
+
+
+//
+// Heap
+//
+
+void *gb_heap_alloc(ssize_t size, ssize_t alignment) {
+  gb__heap_cache_t *cache = &gb__heap_cache;
+  int32_t size_class;
+  void *ptr;
+
+  if (alignment < GB_DEFAULT_MEMORY_ALIGNMENT)
+    alignment = GB_DEFAULT_MEMORY_ALIGNMENT;
+  GB_ASSERT(gb_is_power_of_two(alignment));
+
+  if (size > GB_HEAP_MAX_SMALL_SIZE || alignment > GB_HEAP_MAX_SMALL_SIZE)
+    return gb__heap_large_alloc(size, alignment);
+
+  // NOTE: Spans are span aligned so a block is aligned when its class size is a multiple of the alignment
+  size_class = cast(int32_t) gb_heap_size_class(gb_max(size, alignment));
+  while (gb_heap_class_size(size_class) & (alignment - 1))
+    size_class++;
+
+  ptr = cache->lists[size_class];
+  if (ptr) {
+    cache->lists[size_class] = *cast(void **) ptr;
+    cache->counts[size_class]--;
+    return ptr;
+  }
+  return gb__heap_cache_refill(cache, size_class);
+}
+
+void gb_heap_free(void *ptr) {
+  gb__heap_cache_t *cache = &gb__heap_cache;
+  gb__heap_segment_t *seg;
+  gb__heap_span_t *span;
+  int32_t size_class;
+
+  if (ptr == NULL)
+    return;
+
+  seg = gb__heap_segment_of(ptr);
+  if (seg->is_large) {
+    gb_vm_free(seg->vm);
+    return;
+  }
+
+  span = &seg->spans[gb_pointer_diff(seg, ptr) / GB_HEAP_SPAN_SIZE];
+  size_class = span->size_class;
+  // NOTE: A pointer inside a block would be handed out again while still in use, refuse it here
+  GB_ASSERT_MSG(size_class >= 0 && gb_pointer_diff(gb__heap_span_start(span), ptr) % gb_heap_class_size(size_class) == 0,
+                "gb_heap_free: %p is not the start of a heap block", ptr);
+  if (!cache->is_registered)
+    gb__heap_cache_register(cache);
+
+  *cast(void **) ptr = cache->lists[size_class];
+  cache->lists[size_class] = ptr;
+  if (++cache->counts[size_class] > 2 * gb__heap_batch_count(size_class))
+    gb__heap_cache_scavenge(cache, size_class);
+}
+
+ssize_t gb_heap_usable_size(void const *ptr) {
+  gb__heap_segment_t *seg = gb__heap_segment_of(ptr);
+  if (seg->is_large)
+    return gb_pointer_diff(ptr, gb_pointer_add(seg->vm.data, seg->vm.size));
+  return gb_heap_class_size(gb__heap_span_of(ptr)->size_class);
+}
+
+void *gb_heap_resize(void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment) {
+  void *new_ptr;
+  ssize_t usable;
+
+  if (ptr == NULL)
+    return gb_heap_alloc(new_size, alignment);
+  if (new_size == 0) {
+    gb_heap_free(ptr);
+    return NULL;
+  }
+
+#if defined(GB_SYSTEM_LINUX)
+  // NOTE: Large blocks staying large are remapped, the pages move without being copied
+  if (new_size > GB_HEAP_MAX_SMALL_SIZE && gb__heap_segment_of(ptr)->is_large && (cast(uintptr_t) ptr & (alignment - 1)) == 0) {
+    new_ptr = gb__heap_large_remap(gb__heap_segment_of(ptr), ptr, new_size);
+    if (new_ptr)
+      return new_ptr;
+  }
+#endif
+
+  // NOTE: The block is already big enough (size classes round up), unless a shrink fits a smaller class:
+  // small blocks move down a class, large ones to a small block or once half of their pages are unused
+  usable = gb_heap_usable_size(ptr);
+  if (new_size <= usable && (cast(uintptr_t) ptr & (alignment - 1)) == 0) {
+    if (gb__heap_segment_of(ptr)->is_large) {
+      if (new_size > GB_HEAP_MAX_SMALL_SIZE && new_size > usable / 2)
+        return ptr;
+    } else if (gb_heap_class_size(gb_heap_size_class(gb_max(new_size, alignment))) >= usable) {
+      return ptr;
+    }
+  }
+
+  new_ptr = gb_heap_alloc(new_size, alignment);
+  if (new_ptr == NULL)
+    return NULL;
+  gb_memcopy(new_ptr, ptr, gb_min(old_size, new_size));
+  gb_heap_free(ptr);
+  return new_ptr;
+}
+
+GB_ALLOCATOR_PROC(gb_heap_allocator_proc) {
+  void *ptr = NULL;
+  gb_unused(allocator_data);
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      // NOTE: Large blocks are fresh mappings and already zero
+      ptr = gb_heap_alloc(size, alignment);
+      if (ptr && (flags & gbAllocatorFlag_ClearToZero) && !gb__heap_segment_of(ptr)->is_large)
+        gb_zero_size(ptr, size);
+      break;
+
+    case gbAllocation_Free:
+      gb_heap_free(old_memory);
+      break;
+
+    case gbAllocation_FreeAll:
+      break;
+
+    case gbAllocation_Resize: {
+      ssize_t old_usable = old_memory ? gb_heap_usable_size(old_memory) : 0;
+      ptr = gb_heap_resize(old_memory, old_size, size, alignment);
+      if (ptr && size > old_size && (flags & gbAllocatorFlag_ClearToZero)) {
+        // NOTE: Past the old block a large block only has fresh pages, remapped or newly mapped
+        ssize_t end = gb__heap_segment_of(ptr)->is_large ? gb_min(size, old_usable) : size;
+        if (end > old_size)
+          gb_zero_size(gb_pointer_add(ptr, old_size), end - old_size);
+      }
+    }
+      break;
+  }
+
+  return ptr;
+}
@@ -0,0 +1,53 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/htable.h"
+#include "gb/memory.h"
+
+gbByteSlice gb_byte_slice(void const *data, ssize_t size) {
+  gbByteSlice slice;
+  slice.data = data;
+  slice.size = size;
+  return slice;
+}
+
+uint64_t gb_table_hash_string(gbString const *key) {
+  return gb_murmur64(*key, gb_string_length(*key));
+}
+
+byte32_t gb_table_eq_string(gbString const *a, gbString const *b) {
+  ssize_t len = gb_string_length(*a);
+  return len == gb_string_length(*b) && gb_memcompare(*a, *b, len) == 0;
+}
+
+uint64_t gb_table_hash_bytes(gbByteSlice const *key) {
+  return gb_murmur64(key->data, key->size);
+}
+
+byte32_t gb_table_eq_bytes(gbByteSlice const *a, gbByteSlice const *b) {
+  return a->size == b->size && gb_memcompare(a->data, b->data, a->size) == 0;
+}
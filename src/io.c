@@ -81,15 +81,17 @@ gb_inline ssize_t gb_printf_err_va(char const *fmt, va_list va) {
 }
 
 gb_inline ssize_t gb_fprintf_va(struct gbFile *f, char const *fmt, va_list va) {
-  gb_local_persist char buf[4096];
-  ssize_t len = gb_snprintf_va(buf, gb_size_of(buf), fmt, va);
+  gb_scratch_frame_t frame = gb_thread_scratch_begin();
+  char *buf = cast(char *) gb_alloc_uninit(gb_thread_scratch_allocator(), GB_PRINTF_BUFFER_SIZE);
+  ssize_t len = gb_snprintf_va(buf, GB_PRINTF_BUFFER_SIZE, fmt, va);
   gb_file_write(f, buf, len - 1); // NOTE(bill): prevent extra whitespace
+  gb_scratch_frame_end(frame);
   return len;
 }
 
 gb_inline char *gb_bprintf_va(char const *fmt, va_list va) {
-  gb_local_persist char buffer[4096];
-  gb_snprintf_va(buffer, gb_size_of(buffer), fmt, va);
+  char *buffer = cast(char *) gb_alloc_uninit(gb_thread_scratch_allocator(), GB_PRINTF_BUFFER_SIZE);
+  gb_snprintf_va(buffer, GB_PRINTF_BUFFER_SIZE, fmt, va);
   return buffer;
 }
 
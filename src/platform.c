@@ -85,6 +85,22 @@ gb_inline ssize_t gb_count_set_bits(uint64_t mask) {
   return count;
 }
 
+gb_inline ssize_t gb_log2(uint64_t x) {
+#if defined(GB_COMPILER_MSVC) && defined(GB_ARCH_64_BIT)
+  unsigned long index;
+  _BitScanReverse64(&index, x);
+  return cast(ssize_t) index;
+#elif defined(GB_COMPILER_MSVC)
+  unsigned long index;
+  if (_BitScanReverse(&index, cast(uint32_t) (x >> 32)))
+    return cast(ssize_t) index + 32;
+  _BitScanReverse(&index, cast(uint32_t) x);
+  return cast(ssize_t) index;
+#else
+  return 63 - __builtin_clzll(cast(unsigned long long) x);
+#endif
+}
+
 
 
 
@@ -0,0 +1,375 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/profile.h"
+#include "gb/time.h"
+
+#if (defined(GB_SYSTEM_LINUX) && defined(__GLIBC__)) || defined(GB_SYSTEM_OSX)
+#include <execinfo.h>
+#define GB__HEAP_PROFILE_BACKTRACE 1
+#endif
+
+GB_TABLE_DEFINE(gbHeapProfileStackTable, gb_heap_profile_stack_table_, gb_heap_profile_stack_t)
+
+// NOTE: Frames of the profiler itself on top of every captured stack
+#define GB__HEAP_PROFILE_SKIP_FRAMES 3
+
+// NOTE: Bytes left before the next sample and the generator drawing the distances, per thread
+gb_global gb_thread_local ssize_t gb__heap_profile_countdown = 0;
+gb_global gb_thread_local uint64_t gb__heap_profile_rng = 0;
+
+gb_internal gb_inline void gb__heap_profile_lock(gb_heap_profiler_t *p) {
+  while (!gb_atomic32_spin_lock(&p->lock, 64))
+    gb_yield();
+}
+
+gb_internal gb_inline uint64_t gb__heap_profile_hash(void const *ptr) {
+  return (cast(uint64_t) cast(uintptr_t) ptr >> 4) * 0x9e3779b97f4a7c15ull;
+}
+
+gb_internal gb_inline ssize_t gb__heap_profile_filter_slot(void const *ptr) {
+  return cast(ssize_t) (gb__heap_profile_hash(ptr) >> 40) & (GB_HEAP_PROFILE_FILTER_SIZE - 1);
+}
+
+// NOTE: Under the lock, the bit of a slot follows whether its count is zero
+gb_internal void gb__heap_profile_filter_add(gb_heap_profiler_t *p, void const *ptr, int32_t delta) {
+  ssize_t slot = gb__heap_profile_filter_slot(ptr);
+  int32_t bit = cast(int32_t) (cast(uint32_t) 1 << (slot & 31));
+  GB_ASSERT(p->filter_counts[slot] + delta >= 0 && p->filter_counts[slot] + delta <= 0xffff);
+  p->filter_counts[slot] = cast(uint16_t) (p->filter_counts[slot] + delta);
+  if (p->filter_counts[slot] == 0)
+    gb_atomic32_fetch_and(&p->filter[slot >> 5], ~bit);
+  else
+    gb_atomic32_fetch_or(&p->filter[slot >> 5], bit);
+}
+
+// NOTE: Good to about 0.01, plenty to draw sampling distances
+gb_internal float64_t gb__heap_profile_log2(float64_t x) {
+  union { float64_t f; uint64_t u; } v;
+  float64_t m;
+  int64_t e;
+  v.f = x;
+  e = cast(int64_t) ((v.u >> 52) & 0x7ff) - 1024;
+  v.u = (v.u & ((cast(uint64_t) 1 << 52) - 1)) | (cast(uint64_t) 1023 << 52);
+  m = v.f;
+  return cast(float64_t) e + (-0.34484843 * m + 2.02466578) * m - 0.67487759;
+}
+
+// NOTE: Exponentially distributed with a mean of `period`, -ln(U) * period
+gb_internal ssize_t gb__heap_profile_next_sample(ssize_t period) {
+  uint64_t x = gb__heap_profile_rng;
+  float64_t q;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  gb__heap_profile_rng = x;
+  q = cast(float64_t) ((x >> 38) + 1); // NOTE: [1, 2^26]
+  q = (26.0 - gb__heap_profile_log2(q)) * 0.6931471805599453 * cast(float64_t) period;
+  // NOTE: Saturated, a huge period simply never samples
+  return q < cast(float64_t) (SIZE_MAX / 4) ? cast(ssize_t) q + 1 : cast(ssize_t) (SIZE_MAX / 4);
+}
+
+gb_no_inline gb_internal int32_t gb__heap_profile_backtrace(void **frames) {
+#if defined(GB__HEAP_PROFILE_BACKTRACE)
+  void *buffer[GB_HEAP_PROFILE_MAX_DEPTH + GB__HEAP_PROFILE_SKIP_FRAMES];
+  int32_t depth = backtrace(buffer, gb_count_of(buffer)) - GB__HEAP_PROFILE_SKIP_FRAMES;
+  if (depth <= 0)
+    return 0;
+  gb_memcopy(frames, buffer + GB__HEAP_PROFILE_SKIP_FRAMES, depth * gb_size_of(void *));
+  return depth;
+#elif defined(GB_SYSTEM_WINDOWS)
+  return cast(int32_t) RtlCaptureStackBackTrace(GB__HEAP_PROFILE_SKIP_FRAMES, GB_HEAP_PROFILE_MAX_DEPTH, frames, NULL);
+#else
+  return 0;
+#endif
+}
+
+gb_internal void gb__heap_profile_samples_insert(gb_heap_profiler_t *p, gb_heap_profile_sample_t sample);
+
+gb_internal void gb__heap_profile_samples_grow(gb_heap_profiler_t *p) {
+  gb_heap_profile_sample_t *old_samples = p->samples;
+  ssize_t i, old_capacity = p->sample_capacity;
+
+  p->sample_capacity = old_capacity ? old_capacity * 2 : 256;
+  p->samples = gb_alloc_array(p->backing, gb_heap_profile_sample_t, p->sample_capacity);
+  p->sample_count = 0;
+  for (i = 0; i < old_capacity; i++)
+    if (old_samples[i].ptr)
+      gb__heap_profile_samples_insert(p, old_samples[i]);
+  if (old_samples)
+    gb_free(p->backing, old_samples);
+}
+
+gb_internal void gb__heap_profile_samples_insert(gb_heap_profiler_t *p, gb_heap_profile_sample_t sample) {
+  ssize_t mask, i;
+  if (2 * (p->sample_count + 1) > p->sample_capacity)
+    gb__heap_profile_samples_grow(p);
+  mask = p->sample_capacity - 1;
+  i = cast(ssize_t) (gb__heap_profile_hash(sample.ptr) >> 32) & mask;
+  while (p->samples[i].ptr)
+    i = (i + 1) & mask;
+  p->samples[i] = sample;
+  p->sample_count++;
+}
+
+// NOTE: Linear probing with backward shift deletion, no tombstones
+gb_internal byte32_t gb__heap_profile_samples_remove(gb_heap_profiler_t *p, void *ptr, gb_heap_profile_sample_t *out) {
+  ssize_t mask, i, j;
+  if (p->sample_count == 0)
+    return false;
+  mask = p->sample_capacity - 1;
+  i = cast(ssize_t) (gb__heap_profile_hash(ptr) >> 32) & mask;
+  while (p->samples[i].ptr != ptr) {
+    if (!p->samples[i].ptr)
+      return false;
+    i = (i + 1) & mask;
+  }
+  *out = p->samples[i];
+  for (j = i;;) {
+    ssize_t k;
+    j = (j + 1) & mask;
+    if (!p->samples[j].ptr)
+      break;
+    k = cast(ssize_t) (gb__heap_profile_hash(p->samples[j].ptr) >> 32) & mask;
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+      continue;
+    p->samples[i] = p->samples[j];
+    i = j;
+  }
+  p->samples[i].ptr = NULL;
+  p->sample_count--;
+  return true;
+}
+
+gb_no_inline gb_internal void gb__heap_profile_sample(gb_heap_profiler_t *p, void *ptr, ssize_t size) {
+  gb_heap_profile_sample_t sample;
+  gb_heap_profile_stack_t *stack;
+  void *frames[GB_HEAP_PROFILE_MAX_DEPTH];
+  int32_t depth;
+
+  if (!gb__heap_profile_rng) {
+    // NOTE: First allocation of this thread, only starts the countdown
+    gb__heap_profile_rng = (gb_rdtsc() ^ gb__heap_profile_hash(&gb__heap_profile_rng)) | 1;
+    gb__heap_profile_countdown = gb__heap_profile_next_sample(p->sample_period);
+    return;
+  }
+  gb__heap_profile_countdown = gb__heap_profile_next_sample(p->sample_period);
+
+  depth = gb__heap_profile_backtrace(frames);
+  sample.ptr = ptr;
+  sample.size = size;
+  sample.stack = gb_murmur64(frames, depth * gb_size_of(void *));
+
+  gb__heap_profile_lock(p);
+  stack = gb_heap_profile_stack_table_get(&p->stacks, sample.stack);
+  if (!stack) {
+    gb_heap_profile_stack_t empty = {0};
+    gb_memcopy(empty.frames, frames, depth * gb_size_of(void *));
+    empty.depth = depth;
+    gb_heap_profile_stack_table_set(&p->stacks, sample.stack, empty);
+    stack = gb_heap_profile_stack_table_get(&p->stacks, sample.stack);
+  }
+  stack->live_count++;
+  stack->live_bytes += size;
+  stack->alloc_count++;
+  stack->alloc_bytes += size;
+  gb__heap_profile_samples_insert(p, sample);
+  gb__heap_profile_filter_add(p, ptr, 1);
+  gb_atomic32_spin_unlock(&p->lock);
+}
+
+// NOTE: Plain read on the free path, a stale zero only means a sampled block freed concurrently with its sampling
+gb_internal gb_inline byte32_t gb__heap_profile_maybe_sampled(gb_heap_profiler_t *p, void const *ptr) {
+  ssize_t slot = gb__heap_profile_filter_slot(ptr);
+  return ptr && ((cast(uint32_t) p->filter[slot >> 5].value >> (slot & 31)) & 1) != 0;
+}
+
+gb_no_inline gb_internal void gb__heap_profile_forget(gb_heap_profiler_t *p, void *ptr) {
+  gb_heap_profile_sample_t sample;
+
+  gb__heap_profile_lock(p);
+  if (gb__heap_profile_samples_remove(p, ptr, &sample)) {
+    gb_heap_profile_stack_t *stack = gb_heap_profile_stack_table_get(&p->stacks, sample.stack);
+    stack->live_count--;
+    stack->live_bytes -= sample.size;
+    gb__heap_profile_filter_add(p, ptr, -1);
+  }
+  gb_atomic32_spin_unlock(&p->lock);
+}
+
+void gb_heap_profiler_init(gb_heap_profiler_t *profiler, gb_allocator_t backing, ssize_t sample_period) {
+  gb_zero_item(profiler);
+  profiler->backing = backing;
+  profiler->sample_period = sample_period > 0 ? sample_period : GB_HEAP_PROFILE_SAMPLE_PERIOD;
+  gb_heap_profile_stack_table_init(&profiler->stacks, backing);
+}
+
+void gb_heap_profiler_free(gb_heap_profiler_t *profiler) {
+  gb_heap_profile_stack_table_destroy(&profiler->stacks);
+  if (profiler->samples)
+    gb_free(profiler->backing, profiler->samples);
+  profiler->samples = NULL;
+  profiler->sample_capacity = profiler->sample_count = 0;
+}
+
+byte32_t gb_heap_profiler_write(gb_heap_profiler_t *profiler, gbFile *f, gbHeapProfileKind kind) {
+  gb_heap_profile_stack_t *stacks;
+  ssize_t i, j, count;
+  ssize_t live_count = 0, live_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+
+  // NOTE: Snapshot under the lock, the writes happen without it
+  gb__heap_profile_lock(profiler);
+  count = gb_array_count(profiler->stacks.entries);
+  stacks = gb_alloc_array(profiler->backing, gb_heap_profile_stack_t, gb_max(count, 1));
+  if (!stacks) {
+    gb_atomic32_spin_unlock(&profiler->lock);
+    return false;
+  }
+  for (i = 0; i < count; i++) {
+    gb_heap_profile_stack_t *s = &profiler->stacks.entries[i].value;
+    stacks[i] = *s;
+    if (kind == gbHeapProfile_Allocs) {
+      stacks[i].alloc_count -= s->last_alloc_count;
+      stacks[i].alloc_bytes -= s->last_alloc_bytes;
+      s->last_alloc_count = s->alloc_count;
+      s->last_alloc_bytes = s->alloc_bytes;
+    }
+  }
+  gb_atomic32_spin_unlock(&profiler->lock);
+
+  for (i = 0; i < count; i++) {
+    live_count  += stacks[i].live_count;
+    live_bytes  += stacks[i].live_bytes;
+    alloc_count += stacks[i].alloc_count;
+    alloc_bytes += stacks[i].alloc_bytes;
+  }
+
+  gb_fprintf(f, "heap profile: %td: %td [%td: %td] @ heap_v2/%td\n",
+             live_count, live_bytes, alloc_count, alloc_bytes, profiler->sample_period);
+  for (i = 0; i < count; i++) {
+    gb_heap_profile_stack_t *s = &stacks[i];
+    if (s->live_count == 0 && s->alloc_count == 0)
+      continue;
+    gb_fprintf(f, "%td: %td [%td: %td] @", s->live_count, s->live_bytes, s->alloc_count, s->alloc_bytes);
+    for (j = 0; j < s->depth; j++)
+      gb_fprintf(f, " 0x%p", s->frames[j]);
+    gb_fprintf(f, "\n");
+  }
+  gb_free(profiler->backing, stacks);
+
+#if defined(GB_SYSTEM_LINUX)
+  {
+    // NOTE: pprof needs the mappings to symbolize the addresses
+    gbFile maps;
+    char buffer[4096];
+    int64_t offset = 0;
+    ssize_t bytes_read;
+
+    gb_fprintf(f, "\nMAPPED_LIBRARIES:\n");
+    if (gb_file_open(&maps, "/proc/self/maps") == gbFileError_None) {
+      while (gb_file_read_at_check(&maps, buffer, gb_size_of(buffer), offset, &bytes_read) && bytes_read > 0) {
+        gb_file_write(f, buffer, bytes_read);
+        offset += bytes_read;
+      }
+      gb_file_close(&maps);
+    }
+  }
+#endif
+
+  return true;
+}
+
+gb_inline gb_allocator_t gb_heap_profiler_allocator(gb_heap_profiler_t *profiler) {
+  gb_allocator_t a;
+  a.proc = gb_heap_profiler_allocator_proc;
+  a.data = profiler;
+  return a;
+}
+
+// NOTE: Allocations due for a sample, frees of possibly sampled blocks, free_all and resize
+gb_no_inline gb_internal void *gb__heap_profile_proc_slow(gb_heap_profiler_t *profiler, enum gb_allocation_type type,
+                                                           ssize_t size, ssize_t alignment, void *old_memory,
+                                                           ssize_t old_size, uint64_t flags) {
+  gb_allocator_t backing = profiler->backing;
+  void *ptr = NULL;
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      // NOTE: The countdown went negative already, it stays so until an allocation succeeds
+      ptr = backing.proc(backing.data, type, size, alignment, old_memory, old_size, flags);
+      if (ptr)
+        gb__heap_profile_sample(profiler, ptr, size);
+      break;
+
+    case gbAllocation_Free:
+      gb__heap_profile_forget(profiler, old_memory);
+      return backing.proc(backing.data, type, size, alignment, old_memory, old_size, flags);
+
+    case gbAllocation_FreeAll: {
+      ssize_t i;
+      backing.proc(backing.data, type, size, alignment, old_memory, old_size, flags);
+      gb__heap_profile_lock(profiler);
+      for (i = 0; i < profiler->sample_capacity; i++)
+        profiler->samples[i].ptr = NULL;
+      profiler->sample_count = 0;
+      for (i = 0; i < gb_array_count(profiler->stacks.entries); i++) {
+        profiler->stacks.entries[i].value.live_count = 0;
+        profiler->stacks.entries[i].value.live_bytes = 0;
+      }
+      for (i = 0; i < GB_HEAP_PROFILE_FILTER_SIZE / 32; i++)
+        gb_atomic32_store(&profiler->filter[i], 0);
+      gb_zero_array(profiler->filter_counts, GB_HEAP_PROFILE_FILTER_SIZE);
+      gb_atomic32_spin_unlock(&profiler->lock);
+    } break;
+
+    case gbAllocation_Resize:
+      // NOTE: A resize is sampled as a new allocation of the new size
+      if (gb__heap_profile_maybe_sampled(profiler, old_memory))
+        gb__heap_profile_forget(profiler, old_memory);
+      ptr = backing.proc(backing.data, type, size, alignment, old_memory, old_size, flags);
+      if (ptr && size > 0 && (gb__heap_profile_countdown -= size) < 0)
+        gb__heap_profile_sample(profiler, ptr, size);
+      break;
+  }
+
+  return ptr;
+}
+
+GB_ALLOCATOR_PROC(gb_heap_profiler_allocator_proc) {
+  gb_heap_profiler_t *profiler = cast(gb_heap_profiler_t *) allocator_data;
+
+  // NOTE: Unsampled allocations and frees only check the countdown or the filter before a tail call to the
+  // backing allocator, everything else is out of line
+  if (type == gbAllocation_Alloc) {
+    if ((gb__heap_profile_countdown -= size) >= 0)
+      return profiler->backing.proc(profiler->backing.data, type, size, alignment, old_memory, old_size, flags);
+  } else if (type == gbAllocation_Free) {
+    if (!gb__heap_profile_maybe_sampled(profiler, old_memory))
+      return profiler->backing.proc(profiler->backing.data, type, size, alignment, old_memory, old_size, flags);
+  }
+  return gb__heap_profile_proc_slow(profiler, type, size, alignment, old_memory, old_size, flags);
+}
@@ -26,6 +26,7 @@
  */
 
 #include "gb/string.h"
+#include "gb/track.h"
 
 gb_inline void gb_str_to_lower(char *str) {
   if (!str) return;
@@ -461,7 +462,7 @@ gb_inline gbString gb_string_make(gb_allocator_t a, char const *str) {
 
 gbString gb_string_make_length(gb_allocator_t a, void const *init_str, ssize_t num_bytes) {
   ssize_t header_size = gb_size_of(gbStringHeader);
-  void *ptr = gb_alloc(a, header_size + num_bytes + 1);
+  void *ptr = gb_alloc_uninit(a, header_size + num_bytes + 1);
 
   gbString str;
   gbStringHeader *header;
@@ -509,15 +510,15 @@ gb_inline void gb_string_clear(gbString str) {
   str[0] = '\0';
 }
 
-gb_inline gbString gb_string_append(gbString str, gbString const other) {
-  return gb_string_append_length(str, other, gb_string_length(other));
+gb_inline gbString gb_string_append_at(gbString str, gbString const other, char const *file, int32_t line) {
+  return gb_string_append_length_at(str, other, gb_string_length(other), file, line);
 }
 
-gbString gb_string_append_length(gbString str, void const *other, ssize_t other_len) {
+gbString gb_string_append_length_at(gbString str, void const *other, ssize_t other_len, char const *file, int32_t line) {
   if (other_len > 0) {
     ssize_t curr_len = gb_string_length(str);
 
-    str = gb_string_make_space_for(str, other_len);
+    str = gb_string_make_space_for_at(str, other_len, file, line);
     if (str == NULL)
       return NULL;
 
@@ -528,14 +529,14 @@ gbString gb_string_append_length(gbString str, void const *other, ssize_t other_
   return str;
 }
 
-gb_inline gbString gb_string_appendc(gbString str, char const *other) {
-  return gb_string_append_length(str, other, gb_strlen(other));
+gb_inline gbString gb_string_appendc_at(gbString str, char const *other, char const *file, int32_t line) {
+  return gb_string_append_length_at(str, other, gb_strlen(other), file, line);
 }
 
-gbString gb_string_set(gbString str, char const *cstr) {
+gbString gb_string_set_at(gbString str, char const *cstr, char const *file, int32_t line) {
   ssize_t len = gb_strlen(cstr);
   if (gb_string_capacity(str) < len) {
-    str = gb_string_make_space_for(str, len - gb_string_length(str));
+    str = gb_string_make_space_for_at(str, len - gb_string_length(str), file, line);
     if (str == NULL)
       return NULL;
   }
@@ -547,7 +548,7 @@ gbString gb_string_set(gbString str, char const *cstr) {
   return str;
 }
 
-gbString gb_string_make_space_for(gbString str, ssize_t add_len) {
+gbString gb_string_make_space_for_at(gbString str, ssize_t add_len, char const *file, int32_t line) {
   ssize_t available = gb_string_available_space(str);
 
 // NOTE(bill): Return if there is enough space left
@@ -564,7 +565,8 @@ gbString gb_string_make_space_for(gbString str, ssize_t add_len) {
     old_size = gb_size_of(gbStringHeader) + gb_string_length(str) + 1;
     new_size = gb_size_of(gbStringHeader) + new_len + 1;
 
-    new_ptr = gb_resize(a, ptr, old_size, new_size);
+    new_ptr = gb_resize_at(a, ptr, old_size, new_size, GB_DEFAULT_MEMORY_ALIGNMENT,
+                           GB_DEFAULT_ALLOCATOR_FLAGS & ~gbAllocatorFlag_ClearToZero, file, line);
     if (new_ptr == NULL) return NULL;
 
     header = cast(gbStringHeader *) new_ptr;
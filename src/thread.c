@@ -160,6 +160,49 @@ void gb_thread_set_name(gbThread *t, char const *name) {
 #endif
 }
 
+gb_global gbAtomic64 gb__thread_slots[(GB_THREAD_SLOT_COUNT + 63) / 64];
+gb_global gb_thread_local ssize_t gb__thread_slot; // NOTE: slot + 1, 0 when not assigned yet, -1 when none left
+
+#if !defined(GB_SYSTEM_WINDOWS)
+gb_global pthread_once_t gb__thread_slot_once = PTHREAD_ONCE_INIT;
+gb_global pthread_key_t gb__thread_slot_key;
+
+gb_internal void gb__thread_slot_release(void *data) {
+  ssize_t slot = cast(ssize_t) cast(intptr_t) data - 1;
+  uint64_t mask = cast(uint64_t) 1 << (slot % 64);
+  gb_atomic64_fetch_and(&gb__thread_slots[slot / 64], cast(int64_t) ~mask);
+}
+
+gb_internal void gb__thread_slot_key_init(void) {
+  pthread_key_create(&gb__thread_slot_key, gb__thread_slot_release);
+}
+#endif
+
+gb_no_inline gb_internal ssize_t gb__thread_slot_acquire(void) {
+  ssize_t word, bit;
+  for (word = 0; word < gb_count_of(gb__thread_slots); word++) {
+    for (bit = 0; bit < 64 && word * 64 + bit < GB_THREAD_SLOT_COUNT; bit++) {
+      uint64_t mask = cast(uint64_t) 1 << bit;
+      if ((cast(uint64_t) gb_atomic64_fetch_or(&gb__thread_slots[word], cast(int64_t) mask) & mask) == 0) {
+        gb__thread_slot = word * 64 + bit + 1;
+#if !defined(GB_SYSTEM_WINDOWS)
+        pthread_once(&gb__thread_slot_once, gb__thread_slot_key_init);
+        pthread_setspecific(gb__thread_slot_key, cast(void *) cast(intptr_t) gb__thread_slot);
+#endif
+        return gb__thread_slot - 1;
+      }
+    }
+  }
+  gb__thread_slot = -1;
+  return -1;
+}
+
+gb_inline ssize_t gb_thread_slot(void) {
+  if (gb__thread_slot != 0)
+    return gb__thread_slot > 0 ? gb__thread_slot - 1 : -1;
+  return gb__thread_slot_acquire();
+}
+
 void gb_sync_init(gbSync *s) {
   gb_zero_item(s);
   gb_mutex_init(&s->mutex);
@@ -0,0 +1,337 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include "gb/track.h"
+#include "gb/sort.h"
+
+GB_TABLE_DEFINE(gbTrackSiteTable, gb_track_site_table_, gb_track_site_t)
+
+typedef struct gb__track_header gb__track_header_t;
+
+// NOTE: Sits right before every tracked allocation
+struct gb__track_header {
+  ssize_t size;
+  ssize_t offset; // NOTE: From the start of the backing allocation to the user pointer
+  uint64_t site;
+};
+
+// NOTE: Site of the allocation in flight on this thread, set by gb_alloc_at/gb_resize_at
+gb_global gb_thread_local char const *gb__track_file = NULL;
+gb_global gb_thread_local int32_t gb__track_line = 0;
+
+gb_internal gb_inline void gb__track_lock(gb_tracker_t *tracker) {
+  while (!gb_atomic32_spin_lock(&tracker->lock, 64))
+    gb_yield();
+}
+
+gb_internal gb_inline uint64_t gb__track_site_key(char const *file, int32_t line) {
+  uint64_t key;
+  if (!file)
+    return 0;
+  key = gb_fnv64a(&file, gb_size_of(file));
+  key ^= cast(uint64_t) line * 0x9e3779b97f4a7c15ull;
+  return key ? key : 1;
+}
+
+gb_internal gb_inline ssize_t gb__track_histogram_bucket(ssize_t size) {
+  ssize_t bucket = size > 0 ? gb_log2(cast(uint64_t) size) + 1 : 0;
+  return gb_min(bucket, GB_TRACK_HISTOGRAM_COUNT - 1);
+}
+
+gb_internal gb_inline ssize_t gb__track_header_offset(ssize_t alignment) {
+  ssize_t size = gb_size_of(gb__track_header_t);
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+gb_internal gb_inline gb__track_header_t *gb__track_header(void *ptr) {
+  return cast(gb__track_header_t *) ptr - 1;
+}
+
+gb_internal gb_track_site_t *gb__track_site(gb_tracker_t *tracker, uint64_t key, char const *file, int32_t line) {
+  gb_track_site_t *site;
+  if (!tracker->track_sites)
+    return NULL;
+  site = gb_track_site_table_get(&tracker->sites, key);
+  if (!site) {
+    gb_track_site_t empty = {0};
+    empty.file = file;
+    empty.line = line;
+    gb_track_site_table_set(&tracker->sites, key, empty);
+    site = gb_track_site_table_get(&tracker->sites, key);
+  }
+  return site;
+}
+
+gb_internal void gb__track_add(gb_tracker_t *tracker, gb_track_site_t *site, ssize_t delta) {
+  gb_track_stats_t *s = &tracker->stats;
+  s->live_bytes += delta;
+  if (s->peak_bytes < s->live_bytes)
+    s->peak_bytes = s->live_bytes;
+  if (site) {
+    site->live_bytes += delta;
+    if (site->peak_bytes < site->live_bytes)
+      site->peak_bytes = site->live_bytes;
+  }
+  if (delta > 0) {
+    s->total_bytes += delta;
+    if (site)
+      site->total_bytes += delta;
+  }
+}
+
+gb_internal void gb__track_free(gb_tracker_t *tracker, void *ptr) {
+  gb__track_header_t *header = gb__track_header(ptr);
+  gb_track_site_t *site;
+  void *base = gb_pointer_sub(ptr, header->offset);
+
+  gb__track_lock(tracker);
+  site = tracker->track_sites ? gb_track_site_table_get(&tracker->sites, header->site) : NULL;
+  gb__track_add(tracker, site, -header->size);
+  tracker->stats.free_count++;
+  if (site)
+    site->free_count++;
+  gb_atomic32_spin_unlock(&tracker->lock);
+
+  gb_free(tracker->backing, base);
+}
+
+gb_internal void *gb__track_alloc(gb_tracker_t *tracker, ssize_t size, ssize_t alignment, uint64_t flags,
+                                  char const *file, int32_t line) {
+  ssize_t offset = gb__track_header_offset(alignment);
+  uint64_t key = gb__track_site_key(file, line);
+  gb__track_header_t *header;
+  gb_track_site_t *site;
+  void *base, *ptr;
+
+  base = gb_alloc_align_flags(tracker->backing, offset + size, alignment, flags);
+  if (!base)
+    return NULL;
+  ptr = gb_pointer_add(base, offset);
+  header = gb__track_header(ptr);
+  header->size = size;
+  header->offset = offset;
+  header->site = key;
+
+  gb__track_lock(tracker);
+  site = gb__track_site(tracker, key, file, line);
+  gb__track_add(tracker, site, size);
+  tracker->stats.alloc_count++;
+  tracker->stats.histogram[gb__track_histogram_bucket(size)]++;
+  if (site)
+    site->alloc_count++;
+  gb_atomic32_spin_unlock(&tracker->lock);
+
+  return ptr;
+}
+
+void gb_tracker_init(gb_tracker_t *tracker, gb_allocator_t backing, byte32_t track_sites) {
+  gb_zero_item(tracker);
+  tracker->backing = backing;
+  tracker->track_sites = track_sites;
+  if (track_sites)
+    gb_track_site_table_init(&tracker->sites, backing);
+}
+
+void gb_tracker_free(gb_tracker_t *tracker) {
+  if (tracker->track_sites)
+    gb_track_site_table_destroy(&tracker->sites);
+}
+
+gb_track_stats_t gb_tracker_stats(gb_tracker_t *tracker) {
+  gb_track_stats_t stats;
+  gb__track_lock(tracker);
+  stats = tracker->stats;
+  gb_atomic32_spin_unlock(&tracker->lock);
+  return stats;
+}
+
+gb_track_site_t *gb_tracker_site(gb_tracker_t *tracker, char const *file, int32_t line) {
+  if (!tracker->track_sites)
+    return NULL;
+  return gb_track_site_table_get(&tracker->sites, gb__track_site_key(file, line));
+}
+
+gb_internal GB_COMPARE_PROC(gb__track_site_cmp) {
+  gb_track_site_t const *x = cast(gb_track_site_t const *) a;
+  gb_track_site_t const *y = cast(gb_track_site_t const *) b;
+  return x->total_bytes < y->total_bytes ? +1 : x->total_bytes > y->total_bytes ? -1 : 0;
+}
+
+void gb_tracker_dump(gb_tracker_t *tracker, gbFile *f, ssize_t max_sites) {
+  gb_track_stats_t *s = &tracker->stats;
+  ssize_t i, count;
+
+  gb__track_lock(tracker);
+  gb_fprintf(f, "live %td, peak %td, total %td bytes; %td allocs, %td frees, %td resizes\n",
+             s->live_bytes, s->peak_bytes, s->total_bytes, s->alloc_count, s->free_count, s->resize_count);
+  for (i = 0; i < GB_TRACK_HISTOGRAM_COUNT; i++) {
+    if (s->histogram[i] == 0)
+      continue;
+    if (i == 0)
+      gb_fprintf(f, "  %12d: %td\n", 0, s->histogram[i]);
+    else
+      gb_fprintf(f, "  %12llu: %td\n", 1ull << (i - 1), s->histogram[i]);
+  }
+
+  count = tracker->track_sites ? gb_array_count(tracker->sites.entries) : 0;
+  if (count > 0) {
+    gb_track_site_t *sites = gb_alloc_array(tracker->backing, gb_track_site_t, count);
+    for (i = 0; i < count; i++)
+      sites[i] = tracker->sites.entries[i].value;
+    gb_sort(sites, count, gb_size_of(gb_track_site_t), gb__track_site_cmp);
+    if (max_sites >= 0 && count > max_sites)
+      count = max_sites;
+    for (i = 0; i < count; i++) {
+      gb_track_site_t *site = &sites[i];
+      gb_fprintf(f, "%s:%d: live %td, peak %td, total %td bytes; %td allocs, %td frees, %td resizes\n",
+                 site->file ? site->file : "<unknown>", site->line, site->live_bytes, site->peak_bytes, site->total_bytes,
+                 site->alloc_count, site->free_count, site->resize_count);
+    }
+    gb_free(tracker->backing, sites);
+  }
+  gb_atomic32_spin_unlock(&tracker->lock);
+}
+
+gb_inline gb_allocator_t gb_tracker_allocator(gb_tracker_t *tracker) {
+  gb_allocator_t a;
+  a.proc = gb_tracker_allocator_proc;
+  a.data = tracker;
+  return a;
+}
+
+GB_ALLOCATOR_PROC(gb_tracker_allocator_proc) {
+  gb_tracker_t *tracker = cast(gb_tracker_t *) allocator_data;
+  char const *file = gb__track_file;
+  int32_t line = gb__track_line;
+  void *ptr = NULL;
+
+  alignment = gb_max(alignment, gb_align_of(gb__track_header_t));
+
+  switch (type) {
+    case gbAllocation_Alloc:
+      ptr = gb__track_alloc(tracker, size, alignment, flags, file, line);
+      break;
+
+    case gbAllocation_Free:
+      if (old_memory)
+        gb__track_free(tracker, old_memory);
+      break;
+
+    case gbAllocation_FreeAll: {
+      ssize_t i;
+      gb_free_all(tracker->backing);
+      gb__track_lock(tracker);
+      tracker->stats.live_bytes = 0;
+      if (tracker->track_sites)
+        for (i = 0; i < gb_array_count(tracker->sites.entries); i++)
+          tracker->sites.entries[i].value.live_bytes = 0;
+      gb_atomic32_spin_unlock(&tracker->lock);
+    } break;
+
+    case gbAllocation_Resize: {
+      gb__track_header_t *header;
+      gb_track_site_t *site;
+      ssize_t offset, prev_size;
+      uint64_t key;
+      void *base;
+
+      if (!old_memory) {
+        ptr = gb__track_alloc(tracker, size, alignment, flags, file, line);
+        break;
+      }
+      if (size == 0) {
+        gb__track_free(tracker, old_memory);
+        break;
+      }
+
+      header = gb__track_header(old_memory);
+      offset = gb__track_header_offset(alignment);
+      if (header->offset != offset || (cast(uintptr_t) old_memory & (alignment - 1)) != 0) {
+        // NOTE: Different alignment, the header cannot stay where it is
+        ssize_t old_usable = header->size;
+        ptr = gb__track_alloc(tracker, size, alignment, flags, file, line);
+        if (ptr) {
+          gb_memcopy(ptr, old_memory, gb_min(size, old_usable));
+          gb__track_free(tracker, old_memory);
+        }
+        break;
+      }
+
+      prev_size = header->size;
+      base = gb_pointer_sub(old_memory, offset);
+      base = gb_resize_align_flags(tracker->backing, base, offset + prev_size, offset + size, alignment, flags);
+      if (!base)
+        break;
+      ptr = gb_pointer_add(base, offset);
+      header = gb__track_header(ptr);
+      header->size = size;
+
+      gb__track_lock(tracker);
+      key = header->site;
+      if (file) {
+        // NOTE: A resize at a known site moves the block there, so grows are charged to whoever grows
+        key = gb__track_site_key(file, line);
+        if (key != header->site && tracker->track_sites) {
+          site = gb_track_site_table_get(&tracker->sites, header->site);
+          if (site)
+            site->live_bytes -= prev_size;
+          site = gb__track_site(tracker, key, file, line);
+          site->live_bytes += prev_size;
+        }
+        header->site = key;
+      }
+      site = tracker->track_sites ? gb__track_site(tracker, key, file, line) : NULL;
+      gb__track_add(tracker, site, size - prev_size);
+      tracker->stats.resize_count++;
+      tracker->stats.histogram[gb__track_histogram_bucket(size)]++;
+      if (site)
+        site->resize_count++;
+      gb_atomic32_spin_unlock(&tracker->lock);
+    } break;
+  }
+
+  return ptr;
+}
+
+void *gb_alloc_at(gb_allocator_t a, ssize_t size, ssize_t alignment, uint64_t flags, char const *file, int32_t line) {
+  void *ptr;
+  gb__track_file = file;
+  gb__track_line = line;
+  ptr = gb_alloc_align_flags(a, size, alignment, flags);
+  gb__track_file = NULL;
+  return ptr;
+}
+
+void *gb_resize_at(gb_allocator_t a, void *ptr, ssize_t old_size, ssize_t new_size, ssize_t alignment, uint64_t flags,
+                   char const *file, int32_t line) {
+  void *new_ptr;
+  gb__track_file = file;
+  gb__track_line = line;
+  new_ptr = gb_resize_align_flags(a, ptr, old_size, new_size, alignment, flags);
+  gb__track_file = NULL;
+  return new_ptr;
+}
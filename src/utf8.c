@@ -130,14 +130,14 @@ uint8_t *gb_ucs2_to_utf8(uint8_t *buffer, ssize_t len, uint16_t const *str) {
   return buffer;
 }
 
-uint16_t *gb_utf8_to_ucs2_buf(uint8_t const *str) { // NOTE(bill): Uses locally persisting buffer
-  gb_local_persist uint16_t buf[4096];
-  return gb_utf8_to_ucs2(buf, gb_count_of(buf), str);
+uint16_t *gb_utf8_to_ucs2_buf(uint8_t const *str) {
+  uint16_t *buf = cast(uint16_t *) gb_alloc_uninit(gb_thread_scratch_allocator(), gb_size_of(uint16_t) * GB_UTF8_BUFFER_SIZE);
+  return gb_utf8_to_ucs2(buf, GB_UTF8_BUFFER_SIZE, str);
 }
 
-uint8_t *gb_ucs2_to_utf8_buf(uint16_t const *str) { // NOTE(bill): Uses locally persisting buffer
-  gb_local_persist uint8_t buf[4096];
-  return gb_ucs2_to_utf8(buf, gb_count_of(buf), str);
+uint8_t *gb_ucs2_to_utf8_buf(uint16_t const *str) {
+  uint8_t *buf = cast(uint8_t *) gb_alloc_uninit(gb_thread_scratch_allocator(), GB_UTF8_BUFFER_SIZE);
+  return gb_ucs2_to_utf8(buf, GB_UTF8_BUFFER_SIZE, str);
 }
 
 gb_global uint8_t const gb__utf8_first[256] = {
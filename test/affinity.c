@@ -30,5 +30,20 @@
 #include "gb/affinity.h"
 
 int main(void) {
+  gb_affinity_t affinity;
+  ssize_t i;
+
+  // NOTE: Every processor maps to a known node, even without NUMA
+  {
+    gb_affinity_init(&affinity);
+    GB_ASSERT(affinity.thread_count >= 1 && affinity.core_count >= 1);
+    GB_ASSERT(affinity.node_count >= 1 && affinity.node_count <= GB_AFFINITY_MAX_NODES);
+    for (i = 0; i < GB_AFFINITY_MAX_THREADS; i++)
+      GB_ASSERT(gb_affinity_node_of_thread(&affinity, i) < affinity.node_count);
+    GB_ASSERT(gb_affinity_node_of_thread(&affinity, -1) == 0);
+    GB_ASSERT(gb_affinity_current_node() >= 0 && gb_affinity_current_node() < affinity.node_count);
+    gb_affinity_destroy(&affinity);
+  }
+
   return EXIT_SUCCESS;
 }
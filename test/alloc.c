@@ -28,7 +28,582 @@
 #include <cute.h>
 
 #include "gb/alloc.h"
+#include "gb/io.h"
+
+#define POOL_THREADS 4
+#define POOL_BLOCKS  1024
+
+gb_global gb_concurrent_pool_t shared_pool;
+
+GB_THREAD_PROC(pool_worker) {
+  gb_allocator_t a = gb_concurrent_pool_allocator(&shared_pool);
+  uint64_t *blocks[POOL_BLOCKS / POOL_THREADS / 2];
+  ssize_t round, i;
+
+  for (round = 0; round < 1000; round++) {
+    for (i = 0; i < gb_count_of(blocks); i++) {
+      blocks[i] = cast(uint64_t *) gb_alloc(a, gb_size_of(uint64_t) * 4);
+      GB_ASSERT_NOT_NULL(blocks[i]);
+      blocks[i][0] = blocks[i][3] = cast(uint64_t) cast(uintptr_t) data + i;
+    }
+    for (i = 0; i < gb_count_of(blocks); i++) {
+      GB_ASSERT(blocks[i][0] == cast(uint64_t) cast(uintptr_t) data + i);
+      GB_ASSERT(blocks[i][3] == cast(uint64_t) cast(uintptr_t) data + i);
+      gb_free(a, blocks[i]);
+    }
+  }
+}
+
+#define ARENA_THREADS 4
+#define ARENA_ITEMS   4096
+
+gb_global gb_arena_t shared_arena;
+gb_global uint64_t *arena_items[ARENA_THREADS][ARENA_ITEMS];
+
+GB_THREAD_PROC(arena_worker) {
+  gb_allocator_t a = gb_arena_allocator(&shared_arena);
+  ssize_t t = cast(ssize_t) cast(uintptr_t) data;
+  ssize_t i;
+
+  for (i = 0; i < ARENA_ITEMS; i++) {
+    ssize_t count = i % 64 == 0 ? 512 : 1 + i % 8;
+    uint64_t *item = cast(uint64_t *) gb_alloc(a, count * gb_size_of(uint64_t));
+    GB_ASSERT_NOT_NULL(item);
+    GB_ASSERT(item[0] == 0 && item[count - 1] == 0);
+    item[0] = item[count - 1] = cast(uint64_t) (t << 32 | i);
+    arena_items[t][i] = item;
+  }
+}
+
+#define REMOTE_THREADS 4
+#define REMOTE_BLOCKS  256
+
+gb_global gb_allocator_t remote_allocator;
+gb_global void *remote_blocks[REMOTE_THREADS][REMOTE_BLOCKS];
+
+GB_THREAD_PROC(remote_free_worker) {
+  ssize_t t = cast(ssize_t) cast(uintptr_t) data;
+  ssize_t i;
+  for (i = 0; i < REMOTE_BLOCKS; i++)
+    gb_free(remote_allocator, remote_blocks[t][i]);
+}
+
+#define NUMA_THREADS 4
+
+gb_global gb_numa_arena_t shared_numa;
+
+GB_THREAD_PROC(numa_worker) {
+  gb_allocator_t a = gb_numa_arena_allocator(&shared_numa);
+  uint64_t *items[1000];
+  ssize_t i;
+
+  for (i = 0; i < gb_count_of(items); i++) {
+    items[i] = cast(uint64_t *) gb_alloc(a, 64);
+    GB_ASSERT(items[i][0] == 0 && items[i][7] == 0);
+    items[i][0] = items[i][7] = cast(uint64_t) i;
+  }
+  for (i = 0; i < gb_count_of(items); i++)
+    GB_ASSERT(items[i][0] == cast(uint64_t) i && items[i][7] == cast(uint64_t) i);
+}
+
+#define SCRATCH_THREADS 4
+
+GB_THREAD_PROC(scratch_worker) {
+  ssize_t t = cast(ssize_t) cast(uintptr_t) data;
+  gb_scratch_memory_t *s = gb_thread_scratch();
+  ssize_t i;
+
+  for (i = 0; i < 10000; i++) {
+    gb_scratch_frame_t frame = gb_thread_scratch_begin();
+    char *a = gb_bprintf("%td:%td", t, i);
+    char *b = gb_bprintf("%td:%td", t, i + 1);
+    GB_ASSERT(a != b);
+    GB_ASSERT(gb_strcmp(a, gb_bprintf("%td:%td", t, i)) == 0);
+    GB_ASSERT(gb_strcmp(b, gb_bprintf("%td:%td", t, i + 1)) == 0);
+    gb_scratch_frame_end(frame);
+  }
+  GB_ASSERT(s == gb_thread_scratch() && s->frame_count == 0);
+}
 
 int main(void) {
+  gbThread threads[POOL_THREADS];
+  gb_arena_t arena;
+  gb_allocator_t a;
+  gb_temp_arena_memory_t tmp;
+  uint8_t *p;
+  ssize_t i;
+
+  // NOTE: Copies return the start of the new block
+  {
+    char *str = gb_alloc_str(gb_heap_allocator(), "abc");
+    int64_t value = 42, *copy = cast(int64_t *) gb_alloc_copy_align(gb_heap_allocator(), &value, gb_size_of(value), 64);
+    GB_ASSERT(str && gb_strcmp(str, "abc") == 0);
+    GB_ASSERT(copy && *copy == 42 && (cast(uintptr_t) copy & 63) == 0);
+    gb_free(gb_heap_allocator(), str);
+    gb_free(gb_heap_allocator(), copy);
+  }
+
+  // NOTE: Virtual arena, only the touched pages are committed
+  gb_arena_init_virtual(&arena, gb_gigabytes(1));
+  a = gb_arena_allocator(&arena);
+  GB_ASSERT(arena.total_committed == 0);
+
+  p = cast(uint8_t *) gb_alloc(a, 100);
+  p[99] = 1;
+  GB_ASSERT(arena.total_committed == GB_ARENA_COMMIT_SIZE);
+
+  tmp = gb_temp_arena_memory_begin(&arena);
+  p = cast(uint8_t *) gb_alloc(a, gb_megabytes(8));
+  p[gb_megabytes(8) - 1] = 1;
+  GB_ASSERT(arena.total_committed > gb_megabytes(8));
+  gb_temp_arena_memory_end(tmp);
+  GB_ASSERT(arena.total_committed == 2 * GB_ARENA_COMMIT_SIZE);
+
+  p = cast(uint8_t *) gb_alloc(a, gb_megabytes(1));
+  GB_ASSERT(p[gb_megabytes(1) - 1] == 0);
+
+  gb_free_all(a);
+  GB_ASSERT(arena.total_allocated == 0);
+  GB_ASSERT(arena.total_committed == GB_ARENA_COMMIT_SIZE);
+  gb_arena_free(&arena);
+
+  // NOTE: Concurrent pool, half of the blocks are in use at any time and the rest may sit in magazines
+  gb_concurrent_pool_init(&shared_pool, gb_heap_allocator(), POOL_BLOCKS, gb_size_of(uint64_t) * 4);
+  for (i = 0; i < POOL_THREADS; i++) {
+    gb_thread_init(&threads[i]);
+    gb_thread_start(&threads[i], pool_worker, cast(void *) cast(uintptr_t) (i << 20));
+  }
+  for (i = 0; i < POOL_THREADS; i++) {
+    gb_thread_join(&threads[i]);
+    gb_thread_destory(&threads[i]);
+  }
+  // NOTE: Once the workers are done free_all hands back the blocks left in their magazines too
+  {
+    gb_allocator_t a = gb_concurrent_pool_allocator(&shared_pool);
+    gb_free_all(a);
+    for (i = 0; i < POOL_BLOCKS; i++)
+      GB_ASSERT_NOT_NULL(gb_alloc(a, gb_size_of(uint64_t) * 4));
+    GB_ASSERT(gb_alloc(a, gb_size_of(uint64_t) * 4) == NULL);
+  }
+  gb_concurrent_pool_free(&shared_pool);
+
+  // NOTE: Slab, mixed sizes share pages of their class and empty pages go back to the backing
+  {
+    gb_slab_t slab;
+    void *ptrs[1000];
+
+    for (i = 1; i <= GB_SLAB_MAX_SIZE; i++) {
+      ssize_t c = gb_slab_size_class(i);
+      GB_ASSERT(gb_slab_class_size(c) >= i);
+      GB_ASSERT(c == 0 || gb_slab_class_size(c - 1) < i);
+      GB_ASSERT(gb_slab_class_size(c) - i <= gb_max(15, gb_slab_class_size(c) / 8));
+    }
+    GB_ASSERT(gb_slab_class_size(GB_SLAB_CLASS_COUNT - 1) == GB_SLAB_MAX_SIZE);
+
+    gb_slab_init(&slab, gb_heap_allocator());
+    a = gb_slab_allocator(&slab);
+    for (i = 0; i < gb_count_of(ptrs); i++) {
+      ssize_t size = 1 + (i * 37) % (i % 10 == 0 ? gb_kilobytes(64) : 300);
+      ptrs[i] = gb_alloc(a, size);
+      GB_ASSERT_NOT_NULL(ptrs[i]);
+      GB_ASSERT((cast(uint8_t *) ptrs[i])[size - 1] == 0);
+      gb_memset(ptrs[i], cast(uint8_t) i, size);
+    }
+    for (i = 0; i < gb_count_of(ptrs); i += 2) {
+      gb_free(a, ptrs[i]);
+    }
+    p = cast(uint8_t *) gb_alloc_align(a, 100, 64);
+    GB_ASSERT((cast(uintptr_t) p & 63) == 0);
+    p[0] = 1;
+    p = cast(uint8_t *) gb_resize(a, p, 100, 110);
+    GB_ASSERT(p[0] == 1 && p[109] == 0);
+    p = cast(uint8_t *) gb_resize(a, p, 110, gb_kilobytes(40));
+    GB_ASSERT(p[0] == 1);
+    // NOTE: Large blocks keep the alignment they asked for instead of a page of their own
+    GB_ASSERT((cast(uintptr_t) p & (GB_SLAB_PAGE_SIZE - 1)) != 0);
+    p[gb_kilobytes(40) - 1] = 2;
+    p = cast(uint8_t *) gb_resize(a, p, gb_kilobytes(40), gb_kilobytes(400));
+    GB_ASSERT(p[0] == 1 && p[gb_kilobytes(40) - 1] == 2 && p[gb_kilobytes(400) - 1] == 0);
+    GB_ASSERT(slab.large_count == 1);
+    gb_free(a, p);
+    for (i = 1; i < gb_count_of(ptrs); i += 2) {
+      ssize_t size = 1 + (i * 37) % (i % 10 == 0 ? gb_kilobytes(64) : 300);
+      GB_ASSERT((cast(uint8_t *) ptrs[i])[0] == cast(uint8_t) i);
+      GB_ASSERT((cast(uint8_t *) ptrs[i])[size - 1] == cast(uint8_t) i);
+      gb_free(a, ptrs[i]);
+    }
+    GB_ASSERT(slab.total_size == 0);
+    GB_ASSERT(slab.large_count == 0 && slab.full == NULL);
+    gb_slab_free(&slab);
+    GB_ASSERT(slab.page_count == 0);
+
+    // NOTE: The pages of different classes are cut from a single chunk
+    gb_slab_init(&slab, gb_heap_allocator());
+    for (i = 0; i < GB_SLAB_CHUNK_PAGES; i++)
+      ptrs[i] = gb_alloc(a, gb_slab_class_size(i));
+    GB_ASSERT(slab.page_count == GB_SLAB_CHUNK_PAGES && slab.empty == NULL);
+    GB_ASSERT(slab.chunks != NULL && slab.chunks->chunk_next == NULL);
+    for (i = 0; i < GB_SLAB_CHUNK_PAGES; i++)
+      GB_ASSERT(cast(uintptr_t) ptrs[i] - cast(uintptr_t) slab.chunks < GB_SLAB_CHUNK_PAGES * GB_SLAB_PAGE_SIZE);
+    ptrs[i] = gb_alloc(a, gb_slab_class_size(i));
+    GB_ASSERT(slab.chunks->chunk_next != NULL && slab.page_count == GB_SLAB_CHUNK_PAGES + 1);
+    gb_free(a, ptrs[i]);
+    gb_slab_free(&slab);
+    GB_ASSERT(slab.page_count == 0 && slab.chunks == NULL);
+  }
+
+  // NOTE: Free list, freed neighbours coalesce so the whole block is usable again
+  {
+    gb_free_list_t fl;
+    void *ptrs[256];
+    void *buffer = gb_alloc(gb_heap_allocator(), gb_kilobytes(64));
+
+    gb_free_list_init(&fl, buffer, gb_kilobytes(64));
+    a = gb_free_list_allocator(&fl);
+    for (i = 0; i < gb_count_of(ptrs); i++) {
+      ptrs[i] = gb_alloc(a, 1 + (i * 13) % 200);
+      GB_ASSERT_NOT_NULL(ptrs[i]);
+      GB_ASSERT((cast(uintptr_t) ptrs[i] & (GB_DEFAULT_MEMORY_ALIGNMENT - 1)) == 0);
+      gb_memset(ptrs[i], cast(uint8_t) i, 1 + (i * 13) % 200);
+    }
+    for (i = 0; i < gb_count_of(ptrs); i += 2)
+      gb_free(a, ptrs[i]);
+    for (i = 1; i < gb_count_of(ptrs); i += 2) {
+      GB_ASSERT(*cast(uint8_t *) ptrs[i] == cast(uint8_t) i);
+      gb_free(a, ptrs[i]);
+    }
+    GB_ASSERT(fl.allocation_count == 0 && fl.total_allocated == 0);
+
+    p = cast(uint8_t *) gb_alloc(a, gb_kilobytes(60));
+    GB_ASSERT_NOT_NULL(p);
+    gb_free(a, p);
+
+    // NOTE: Grows in place into the free block that follows
+    p = cast(uint8_t *) gb_alloc(a, 64);
+    p[0] = 7;
+    GB_ASSERT(gb_resize(a, p, 64, 4096) == p);
+    GB_ASSERT(p[0] == 7 && p[4095] == 0);
+    ptrs[0] = gb_alloc_align(a, 10, 256);
+    GB_ASSERT((cast(uintptr_t) ptrs[0] & 255) == 0);
+    gb_free(a, ptrs[0]);
+    gb_free(a, p);
+    GB_ASSERT(fl.allocation_count == 0);
+    GB_ASSERT_NOT_NULL(gb_alloc(a, gb_kilobytes(60)));
+
+    gb_free(gb_heap_allocator(), buffer);
+  }
+
+  // NOTE: Fixed heap, holes are reported as fragmentation and merge back once freed
+  {
+    gb_fixed_heap_t heap;
+    gb_fixed_heap_stats_t stats;
+    void *ptrs[256];
+
+    gb_fixed_heap_init_virtual(&heap, gb_megabytes(1));
+    a = gb_fixed_heap_allocator(&heap);
+    stats = gb_fixed_heap_stats(&heap);
+    GB_ASSERT(stats.free_block_count == 1 && stats.fragmentation == 0.0f);
+
+    for (i = 0; i < gb_count_of(ptrs); i++) {
+      ptrs[i] = gb_alloc(a, 1 + (i * 131) % 3000);
+      GB_ASSERT_NOT_NULL(ptrs[i]);
+      gb_memset(ptrs[i], cast(uint8_t) i, 1 + (i * 131) % 3000);
+    }
+    for (i = 0; i < gb_count_of(ptrs); i += 2)
+      gb_free(a, ptrs[i]);
+    stats = gb_fixed_heap_stats(&heap);
+    GB_ASSERT(stats.allocation_count == gb_count_of(ptrs) / 2);
+    GB_ASSERT(stats.free_block_count > 1 && stats.fragmentation > 0.0f);
+
+    p = cast(uint8_t *) gb_alloc_align(a, 100, 512);
+    GB_ASSERT((cast(uintptr_t) p & 511) == 0);
+    p = cast(uint8_t *) gb_resize(a, p, 100, 20000);
+    GB_ASSERT_NOT_NULL(p);
+    gb_free(a, p);
+
+    for (i = 1; i < gb_count_of(ptrs); i += 2) {
+      GB_ASSERT(*cast(uint8_t *) ptrs[i] == cast(uint8_t) i);
+      gb_free(a, ptrs[i]);
+    }
+    stats = gb_fixed_heap_stats(&heap);
+    GB_ASSERT(stats.allocation_count == 0 && stats.total_allocated == 0);
+    GB_ASSERT(stats.free_block_count == 1 && stats.largest_free_block == stats.total_free);
+    gb_fixed_heap_free(&heap);
+  }
+
+  // NOTE: Stack, the top moves in place and markers drop everything above them
+  {
+    gb_stack_t stack;
+    gb_stack_marker_t marker;
+    uint8_t *q;
+
+    gb_stack_init_from_allocator(&stack, gb_heap_allocator(), gb_kilobytes(16));
+    a = gb_stack_allocator(&stack);
+
+    p = cast(uint8_t *) gb_alloc(a, 100);
+    p[0] = 3;
+    GB_ASSERT(gb_resize(a, p, 100, 1000) == p);
+    GB_ASSERT(p[0] == 3 && p[999] == 0);
+    GB_ASSERT(gb_resize(a, p, 1000, 10) == p);
+
+    marker = gb_stack_push_marker(&stack);
+    q = cast(uint8_t *) gb_alloc_align(a, 50, 64);
+    GB_ASSERT((cast(uintptr_t) q & 63) == 0);
+    gb_free(a, gb_alloc(a, 20));
+    GB_ASSERT(gb_alloc(a, gb_kilobytes(16)) == NULL);
+    gb_stack_pop_marker(marker);
+
+    GB_ASSERT(gb_resize(a, p, 10, 2000) == p);
+    gb_free(a, p);
+    GB_ASSERT(stack.total_allocated == 0);
+    gb_stack_free(&stack);
+  }
+
+  // NOTE: Arena, the last allocation grows without moving
+  {
+    gb_arena_init_from_allocator(&arena, gb_heap_allocator(), gb_kilobytes(16));
+    a = gb_arena_allocator(&arena);
+    gb_alloc(a, 10);
+    p = cast(uint8_t *) gb_alloc(a, 100);
+    p[0] = 5;
+    GB_ASSERT(gb_resize(a, p, 100, 8000) == p);
+    GB_ASSERT(p[0] == 5 && p[7999] == 0);
+    gb_alloc(a, 1);
+    GB_ASSERT(gb_resize(a, p, 8000, 8100) != p);
+    gb_arena_free(&arena);
+  }
+
+  // NOTE: Reused memory is still cleared when asked, uninit allocations are left alone
+  {
+    gb_arena_init_virtual(&arena, gb_megabytes(1));
+    a = gb_arena_allocator(&arena);
+    tmp = gb_temp_arena_memory_begin(&arena);
+    p = cast(uint8_t *) gb_alloc_uninit(a, 4096);
+    gb_memset(p, 0xff, 4096);
+    gb_temp_arena_memory_end(tmp);
+    p = cast(uint8_t *) gb_alloc(a, 8192);
+    for (i = 0; i < 8192; i++)
+      GB_ASSERT(p[i] == 0);
+    p = cast(uint8_t *) gb_resize_align_flags(a, p, 8192, 9000, GB_DEFAULT_MEMORY_ALIGNMENT, 0);
+    gb_arena_free(&arena);
+
+    a = gb_malloc_allocator();
+    p = cast(uint8_t *) gb_alloc_uninit(a, 64);
+    gb_memset(p, 0xff, 64);
+    p = cast(uint8_t *) gb_resize(a, p, 64, 128);
+    GB_ASSERT(p[63] == 0xff && p[64] == 0 && p[127] == 0);
+    gb_free(a, p);
+  }
+
+  // NOTE: Placement options are hints, the mapping must be usable whether or not they were honoured
+  {
+    gb_virtual_memory_t vm = gb_vm_alloc_ex(NULL, gb_megabytes(3), gbVmFlag_TransparentHugePages | gbVmFlag_Populate, 0);
+    gb_pool_t pool;
+
+    GB_ASSERT_NOT_NULL(vm.data);
+    GB_ASSERT(vm.size >= gb_megabytes(3));
+    p = cast(uint8_t *) vm.data;
+    GB_ASSERT(p[0] == 0 && p[vm.size - 1] == 0);
+    p[vm.size - 1] = 1;
+    gb_vm_free(vm);
+
+    gb_arena_init_from_vm(&arena, gb_megabytes(4), gbVmFlag_HugePages, GB_VM_NUMA_ANY);
+    a = gb_arena_allocator(&arena);
+    p = cast(uint8_t *) gb_alloc(a, gb_megabytes(3));
+    GB_ASSERT_NOT_NULL(p);
+    p[gb_megabytes(3) - 1] = 1;
+    gb_arena_free(&arena);
+
+    gb_pool_init_from_vm(&pool, 1024, 48, 16, gbVmFlag_Populate, GB_VM_NUMA_ANY);
+    a = gb_pool_allocator(&pool);
+    p = cast(uint8_t *) gb_alloc_align(a, 48, 16);
+    GB_ASSERT_NOT_NULL(p);
+    gb_free(a, p);
+    gb_pool_free(&pool);
+  }
+
+  // NOTE: Concurrent arena, threads share one arena and a phase is dropped at once afterwards
+  {
+    gb_temp_arena_memory_t phase;
+    ssize_t t, count;
+
+    gb_arena_init_virtual(&shared_arena, gb_gigabytes(1));
+    a = gb_arena_allocator(&shared_arena);
+    p = cast(uint8_t *) gb_alloc(a, 100);
+    p[0] = 1;
+
+    gb_arena_set_concurrent(&shared_arena, true);
+    phase = gb_temp_arena_memory_begin(&shared_arena);
+    for (i = 0; i < ARENA_THREADS; i++) {
+      gb_thread_init(&threads[i]);
+      gb_thread_start(&threads[i], arena_worker, cast(void *) cast(uintptr_t) i);
+    }
+    for (i = 0; i < ARENA_THREADS; i++) {
+      gb_thread_join(&threads[i]);
+      gb_thread_destory(&threads[i]);
+    }
+    for (t = 0; t < ARENA_THREADS; t++) {
+      for (i = 0; i < ARENA_ITEMS; i++) {
+        count = i % 64 == 0 ? 512 : 1 + i % 8;
+        GB_ASSERT(arena_items[t][i][0] == cast(uint64_t) (t << 32 | i));
+        GB_ASSERT(arena_items[t][i][count - 1] == cast(uint64_t) (t << 32 | i));
+        GB_ASSERT((cast(uintptr_t) arena_items[t][i] & (GB_DEFAULT_MEMORY_ALIGNMENT - 1)) == 0);
+      }
+    }
+    p = cast(uint8_t *) gb_alloc_align(a, 100, 256);
+    GB_ASSERT((cast(uintptr_t) p & 255) == 0);
+    gb_temp_arena_memory_end(phase);
+    GB_ASSERT(shared_arena.total_allocated == 100);
+
+    // NOTE: Chunks held from the previous phase are dropped, memory handed out again is cleared
+    p = cast(uint8_t *) gb_alloc(a, 64);
+    GB_ASSERT(gb_pointer_diff(shared_arena.physical_start, p) == 112);
+    GB_ASSERT(p[0] == 0 && p[63] == 0);
+    gb_arena_set_concurrent(&shared_arena, false);
+    GB_ASSERT(shared_arena.total_allocated >= 164);
+    GB_ASSERT((cast(uint8_t *) shared_arena.physical_start)[0] == 1);
+    gb_arena_free(&shared_arena);
+  }
+
+  // NOTE: Scratch, blocks are reclaimed in order as the ring wraps and frames drop what they allocated
+  {
+    gb_scratch_memory_t scratch;
+    gb_scratch_frame_t frame, inner;
+    uint8_t *held, *q;
+    ssize_t *mem = cast(ssize_t *) gb_alloc(gb_heap_allocator(), 1024);
+
+    gb_scratch_memory_init(&scratch, mem, 1024);
+    a = gb_scratch_allocator(&scratch);
+    for (i = 0; i < 1000; i++) {
+      p = cast(uint8_t *) gb_alloc(a, 100 + i % 200);
+      GB_ASSERT_NOT_NULL(p);
+      GB_ASSERT(gb_pointer_diff(mem, p) >= gb_size_of(ssize_t) && gb_pointer_diff(mem, p) + 100 + i % 200 <= 1024);
+      GB_ASSERT((cast(uintptr_t) p & (GB_DEFAULT_MEMORY_ALIGNMENT - 1)) == 0);
+      gb_memset(p, 0xab, 100 + i % 200);
+      gb_free(a, p);
+    }
+
+    // NOTE: An older block still in use keeps the ring from reclaiming what follows it
+    held = cast(uint8_t *) gb_alloc(a, 256);
+    p = cast(uint8_t *) gb_alloc(a, 256);
+    GB_ASSERT(held && p);
+    gb_free(a, p);
+    GB_ASSERT(gb_alloc(a, 768) == NULL);
+    gb_free(a, held);
+    GB_ASSERT(scratch.free_point == scratch.alloc_point);
+
+    frame = gb_scratch_frame_begin(&scratch);
+    held = cast(uint8_t *) gb_alloc(a, 128);
+    inner = gb_scratch_frame_begin(&scratch);
+    p = cast(uint8_t *) gb_alloc(a, 128);
+    q = cast(uint8_t *) gb_alloc(a, 128);
+    GB_ASSERT(held && p && q && gb_scratch_memory_is_in_use(&scratch, q));
+    gb_scratch_frame_end(inner);
+    GB_ASSERT(gb_alloc(a, 128) == p);
+    gb_scratch_frame_end(frame);
+    GB_ASSERT(scratch.free_point == scratch.alloc_point && scratch.frame_count == 0);
+    gb_free(gb_heap_allocator(), mem);
+  }
+
+  // NOTE: Thread scratch, every thread formats into its own ring and old blocks are dropped when it is full
+  {
+    gb_scratch_memory_t *s = gb_thread_scratch();
+    gb_scratch_frame_t frame;
+    char *str;
+
+    a = gb_thread_scratch_allocator();
+    str = gb_bprintf("%d %s", 42, "potato");
+    GB_ASSERT(gb_strcmp(str, "42 potato") == 0);
+    for (i = 0; i < 4 * GB_THREAD_SCRATCH_SIZE / 1000; i++) {
+      p = cast(uint8_t *) gb_alloc(a, 1000);
+      GB_ASSERT(gb_scratch_memory_is_in_use(s, p));
+    }
+
+    frame = gb_thread_scratch_begin();
+    str = gb_bprintf("%d", 7);
+    for (i = 0; i < GB_THREAD_SCRATCH_SIZE / 2 / 1000; i++)
+      GB_ASSERT_NOT_NULL(gb_alloc(a, 1000));
+    GB_ASSERT(gb_strcmp(str, "7") == 0);
+    gb_scratch_frame_end(frame);
+    GB_ASSERT(s->alloc_point == frame.alloc_point);
+
+    for (i = 0; i < SCRATCH_THREADS; i++) {
+      gb_thread_init(&threads[i]);
+      gb_thread_start(&threads[i], scratch_worker, cast(void *) cast(uintptr_t) i);
+    }
+    for (i = 0; i < SCRATCH_THREADS; i++) {
+      gb_thread_join(&threads[i]);
+      gb_thread_destory(&threads[i]);
+    }
+  }
+
+  // NOTE: Remote frees, blocks freed by other threads come back to the owner once its free list runs dry
+  {
+    gb_pool_t pool;
+    gb_slab_t slab;
+    ssize_t t, round;
+
+    gb_pool_init(&pool, gb_heap_allocator(), REMOTE_THREADS * REMOTE_BLOCKS, 48);
+    gb_slab_init(&slab, gb_heap_allocator());
+    for (round = 0; round < 2 * 3; round++) {
+      remote_allocator = round % 2 == 0 ? gb_pool_allocator(&pool) : gb_slab_allocator(&slab);
+      for (t = 0; t < REMOTE_THREADS; t++) {
+        for (i = 0; i < REMOTE_BLOCKS; i++) {
+          ssize_t size = round % 2 == 0 ? 48 : (i % 16 == 0 ? gb_kilobytes(40) : 1 + i % 200);
+          remote_blocks[t][i] = gb_alloc(remote_allocator, size);
+          GB_ASSERT_NOT_NULL(remote_blocks[t][i]);
+        }
+      }
+      GB_ASSERT(round % 2 != 0 || pool.free_list == NULL);
+      for (t = 0; t < REMOTE_THREADS; t++) {
+        gb_thread_init(&threads[t]);
+        gb_thread_start(&threads[t], remote_free_worker, cast(void *) cast(uintptr_t) t);
+      }
+      for (t = 0; t < REMOTE_THREADS; t++) {
+        gb_thread_join(&threads[t]);
+        gb_thread_destory(&threads[t]);
+      }
+      GB_ASSERT(round % 2 != 0 || pool.total_size == REMOTE_THREADS * REMOTE_BLOCKS * 48);
+    }
+    p = cast(uint8_t *) gb_alloc(gb_pool_allocator(&pool), 48);
+    GB_ASSERT(p && pool.total_size == 48);
+    gb_free(gb_pool_allocator(&pool), p);
+    GB_ASSERT(pool.total_size == 0);
+    gb_pool_free(&pool);
+
+    p = cast(uint8_t *) gb_alloc(gb_slab_allocator(&slab), gb_kilobytes(40));
+    GB_ASSERT(p && slab.total_size == gb_kilobytes(40));
+    GB_ASSERT(slab.large_count == 1);
+    gb_slab_free(&slab);
+  }
+
+  // NOTE: NUMA arena, a thread allocates from the arena of its node
+  {
+    gb_affinity_t affinity;
+    gb_arena_t *local;
+    ssize_t used = 0;
+
+    gb_affinity_init(&affinity);
+    gb_numa_arena_init(&shared_numa, &affinity, gb_megabytes(8), 0);
+    GB_ASSERT(shared_numa.node_count == affinity.node_count);
+    local = gb_numa_arena_local(&shared_numa);
+    GB_ASSERT(local == &shared_numa.arenas[gb_affinity_current_node()]);
+    for (i = 0; i < NUMA_THREADS; i++) {
+      gb_thread_init(&threads[i]);
+      gb_thread_start(&threads[i], numa_worker, NULL);
+    }
+    for (i = 0; i < NUMA_THREADS; i++) {
+      gb_thread_join(&threads[i]);
+      gb_thread_destory(&threads[i]);
+    }
+    for (i = 0; i < shared_numa.node_count; i++)
+      used += cast(ssize_t) shared_numa.arenas[i].offset.value;
+    GB_ASSERT(used >= NUMA_THREADS * 1000 * 64);
+    gb_free_all(gb_numa_arena_allocator(&shared_numa));
+    for (i = 0; i < shared_numa.node_count; i++)
+      GB_ASSERT(shared_numa.arenas[i].offset.value == 0);
+    gb_numa_arena_free(&shared_numa);
+  }
+
   return EXIT_SUCCESS;
 }
@@ -28,7 +28,9 @@
 #include <cute.h>
 
 #include "gb/array.h"
+#include "gb/heap.h"
 #include "gb/io.h"
+#include "gb/track.h"
 
 int main(void) {
   ssize_t i;
@@ -64,5 +66,133 @@ int main(void) {
   // 7
 
   gb_array_free(items);
+
+  // NOTE: The last allocation of an arena or a stack grows in place, the array never moves
+  {
+    gb_arena_t arena;
+    gb_stack_t stack;
+    gbArray(int64_t) xs;
+    int64_t *first;
+
+    gb_arena_init_from_allocator(&arena, a, gb_megabytes(1));
+    gb_array_init(xs, gb_arena_allocator(&arena));
+    first = xs;
+    for (i = 0; i < 10000; i++)
+      gb_array_append(xs, i);
+    GB_ASSERT(xs == first && xs[9999] == 9999);
+    gb_arena_free(&arena);
+
+    gb_stack_init_from_allocator(&stack, a, gb_megabytes(1));
+    gb_array_init(xs, gb_stack_allocator(&stack));
+    first = xs;
+    for (i = 0; i < 10000; i++)
+      gb_array_append(xs, i);
+    GB_ASSERT(xs == first && xs[9999] == 9999);
+    gb_array_shrink_to_fit(xs);
+    GB_ASSERT(xs == first && gb_array_capacity(xs) == 10000);
+    gb_array_free(xs);
+    GB_ASSERT(stack.total_allocated == 0);
+    gb_stack_free(&stack);
+  }
+
+  // NOTE: Elements stay aligned as the array grows, the header is padded in front of them
+  {
+    float *floats;
+    uint64_t *words;
+    gbBuffer(double) doubles;
+
+    gb_array_init_align(floats, a, 64);
+    for (i = 0; i < 1000; i++) {
+      gb_array_append(floats, cast(float) i);
+      GB_ASSERT((cast(uintptr_t) floats & 63) == 0);
+    }
+    GB_ASSERT(GB_ARRAY_HEADER(floats)->alignment == 64 && floats[999] == 999.0f);
+    gb_array_free(floats);
+
+    gb_array_init(words, a);
+    GB_ASSERT((cast(uintptr_t) words & (GB_DEFAULT_MEMORY_ALIGNMENT - 1)) == 0);
+    GB_ASSERT(gb_pointer_diff(GB_ARRAY_BLOCK(words), words) < gb_size_of(gbArrayHeader) + GB_DEFAULT_MEMORY_ALIGNMENT);
+    gb_array_free(words);
+
+    gb_buffer_init_align(doubles, a, 100, 32);
+    GB_ASSERT((cast(uintptr_t) doubles & 31) == 0);
+    for (i = 0; i < 100; i++)
+      gb_buffer_append(doubles, cast(double) i);
+    GB_ASSERT(gb_buffer_count(doubles) == 100 && doubles[99] == 99.0);
+    gb_buffer_free(doubles, a);
+  }
+
+  // NOTE: Edits in the middle move the tail once, the order is kept unless swapping
+  {
+    int32_t *ids;
+    int32_t evens[50];
+
+    gb_array_init(ids, a);
+    for (i = 0; i < 50; i++) {
+      gb_array_append(ids, cast(int32_t) (2 * i + 1));
+      evens[i] = cast(int32_t) (2 * i);
+    }
+    gb_array_insertv(ids, 0, evens, 1);
+    gb_array_insertv(ids, 50, evens, 0);
+    gb_array_insertv(ids, gb_array_count(ids), &evens[10], 40);
+    GB_ASSERT(gb_array_count(ids) == 91 && ids[0] == 0 && ids[1] == 1 && ids[51] == 20 && ids[90] == 98);
+
+    gb_array_erase_range(ids, 51, 40);
+    gb_array_erase_range(ids, 0, 1);
+    GB_ASSERT(gb_array_count(ids) == 50);
+    for (i = 0; i < 50; i++)
+      GB_ASSERT(ids[i] == 2 * i + 1);
+
+    gb_array_remove_swap(ids, 0);
+    GB_ASSERT(gb_array_count(ids) == 49 && ids[0] == 99 && ids[1] == 3);
+    gb_array_remove_swap(ids, 48);
+    GB_ASSERT(gb_array_count(ids) == 48 && ids[47] == 95);
+
+    gb_array_shrink_to_fit(ids);
+    GB_ASSERT(gb_array_capacity(ids) == 48 && ids[47] == 95 && ids[0] == 99);
+    gb_array_free(ids);
+
+    // NOTE: Shrinking gives the memory back to the heap, large blocks included
+    gb_array_init(ids, gb_heap_allocator());
+    gb_array_resize(ids, 100000);
+    GB_ASSERT(gb_heap_usable_size(GB_ARRAY_BLOCK(ids)) >= 100000 * gb_size_of(ids[0]));
+    gb_array_resize(ids, 10);
+    ids[9] = 9;
+    gb_array_shrink_to_fit(ids);
+    GB_ASSERT(ids[9] == 9 && gb_heap_usable_size(GB_ARRAY_BLOCK(ids)) < 256);
+    gb_array_resize(ids, 1000);
+    gb_array_resize(ids, 10);
+    gb_array_shrink_to_fit(ids);
+    GB_ASSERT(ids[9] == 9 && gb_heap_usable_size(GB_ARRAY_BLOCK(ids)) < 256);
+    gb_array_free(ids);
+  }
+
+  // NOTE: Small array, nothing is allocated until the inline storage is outgrown
+  {
+    gb_tracker_t tracker;
+    gbSmallArray(int, 8) small;
+
+    gb_tracker_init(&tracker, a, false);
+    gb_small_array_init(small, gb_tracker_allocator(&tracker));
+    for (i = 0; i < 8; i++)
+      gb_small_array_append(small, cast(int) i);
+    gb_small_array_pop(small);
+    gb_small_array_appendv(small, test_values, 1);
+    GB_ASSERT(gb_small_array_is_inline(small) && gb_small_array_count(small) == 8 && small.data[7] == 4);
+    GB_ASSERT(gb_tracker_stats(&tracker).alloc_count == 0);
+
+    gb_small_array_appendv(small, test_values, gb_count_of(test_values));
+    GB_ASSERT(!gb_small_array_is_inline(small) && gb_small_array_count(small) == 12);
+    GB_ASSERT(small.data[0] == 0 && small.data[7] == 4 && small.data[11] == 7);
+    gb_small_array_resize(small, 100);
+    GB_ASSERT(small.data[11] == 7 && gb_small_array_capacity(small) >= 100);
+
+    gb_small_array_set_capacity(small, 4);
+    GB_ASSERT(gb_small_array_is_inline(small) && gb_small_array_count(small) == 4 && small.data[3] == 3);
+    GB_ASSERT(gb_tracker_stats(&tracker).live_bytes == 0);
+    gb_small_array_free(small);
+    gb_tracker_free(&tracker);
+  }
+
   return EXIT_SUCCESS;
 }
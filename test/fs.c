@@ -28,7 +28,18 @@
 #include <cute.h>
 
 #include "gb/fs.h"
+#include "gb/heap.h"
 
 int main(void) {
+  // NOTE: The full name survives when it is allocated from the thread scratch the lookup itself uses
+  {
+    gb_scratch_frame_t frame = gb_thread_scratch_begin();
+    char *full = gb_path_get_full_name(gb_heap_allocator(), ".");
+    char *scratch = gb_path_get_full_name(gb_thread_scratch_allocator(), ".");
+    GB_ASSERT(full[0] != 0 && gb_strcmp(full, scratch) == 0);
+    gb_free(gb_heap_allocator(), full);
+    gb_scratch_frame_end(frame);
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,144 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+
+#include "gb/heap.h"
+#include "gb/array.h"
+#include "gb/thread.h"
+#include "gb/io.h"
+
+#define THREAD_COUNT 4
+#define BLOCK_COUNT 4096
+
+gb_global void *blocks[THREAD_COUNT][BLOCK_COUNT];
+gb_global ssize_t counts[4]; // NOTE: Per gbAllocation_ type
+
+// NOTE: The heap, counting the requests it gets
+GB_ALLOCATOR_PROC(counting_allocator_proc) {
+  counts[type]++;
+  return gb_heap_allocator_proc(allocator_data, type, size, alignment, old_memory, old_size, flags);
+}
+
+GB_THREAD_PROC(alloc_blocks) {
+  void **b = cast(void **) data;
+  ssize_t i;
+  for (i = 0; i < BLOCK_COUNT; i++) {
+    ssize_t size = 1 + (i * 37) % 2048;
+    b[i] = gb_alloc(gb_heap_allocator(), size);
+    GB_ASSERT_NOT_NULL(b[i]);
+    gb_memset(b[i], cast(uint8_t) i, size);
+  }
+}
+
+GB_THREAD_PROC(free_blocks) {
+  void **b = cast(void **) data;
+  ssize_t i;
+  for (i = 0; i < BLOCK_COUNT; i++) {
+    ssize_t size = 1 + (i * 37) % 2048;
+    GB_ASSERT(*cast(uint8_t *) b[i] == cast(uint8_t) i);
+    GB_ASSERT(*cast(uint8_t *) gb_pointer_add(b[i], size - 1) == cast(uint8_t) i);
+    gb_free(gb_heap_allocator(), b[i]);
+  }
+}
+
+int main(void) {
+  gb_allocator_t a = gb_heap_allocator();
+  gbThread threads[THREAD_COUNT];
+  ssize_t i;
+  uint8_t *p, *q;
+
+  for (i = 0; i < GB_HEAP_CLASS_COUNT; i++) {
+    ssize_t size = gb_heap_class_size(i);
+    GB_ASSERT(gb_heap_size_class(size) == i);
+    GB_ASSERT(gb_heap_size_class(size - 1) == i || gb_heap_class_size(i - 1) >= size - 1);
+  }
+  GB_ASSERT(gb_heap_class_size(GB_HEAP_CLASS_COUNT - 1) == GB_HEAP_MAX_SMALL_SIZE);
+
+  // NOTE: Alignment and zeroing
+  for (i = 16; i <= gb_kilobytes(64); i *= 2) {
+    p = cast(uint8_t *) gb_alloc_align(a, 24, i);
+    GB_ASSERT((cast(uintptr_t) p & (i - 1)) == 0);
+    GB_ASSERT(p[0] == 0 && p[23] == 0);
+    gb_free(a, p);
+  }
+
+  // NOTE: Resize within a size class stays in place
+  p = cast(uint8_t *) gb_alloc(a, 100);
+  gb_memset(p, 0xab, 100);
+  q = cast(uint8_t *) gb_resize(a, p, 100, 110);
+  GB_ASSERT(p == q);
+  q = cast(uint8_t *) gb_resize(a, q, 110, gb_megabytes(1));
+  GB_ASSERT(q[0] == 0xab && q[99] == 0xab && q[110] == 0);
+  GB_ASSERT(gb_heap_usable_size(q) >= gb_megabytes(1));
+
+  // NOTE: Large blocks keep their contents through growth and shrinking, even when they move
+  q[gb_megabytes(1) - 1] = 0xcd;
+  for (i = 2; i <= 64; i *= 2) {
+    q = cast(uint8_t *) gb_resize(a, q, gb_megabytes(i / 2), gb_megabytes(i));
+    GB_ASSERT(q[0] == 0xab && q[gb_megabytes(1) - 1] == 0xcd);
+    GB_ASSERT(q[gb_megabytes(i) - 1] == 0);
+    GB_ASSERT(gb_heap_usable_size(q) >= gb_megabytes(i));
+  }
+  q[gb_megabytes(2)] = 0xef;
+  q = cast(uint8_t *) gb_resize_align_flags(a, q, gb_megabytes(64), gb_megabytes(2), GB_DEFAULT_MEMORY_ALIGNMENT, 0);
+  q = cast(uint8_t *) gb_resize(a, q, gb_megabytes(2), gb_megabytes(3));
+  GB_ASSERT(q[0] == 0xab && q[gb_megabytes(2)] == 0);
+  gb_free(a, q);
+
+  // NOTE: A huge gbArray grows through resize, every doubling past the small sizes is a remap, not a copy
+  {
+    gb_allocator_t counting = {counting_allocator_proc, NULL};
+    gbArray(int64_t) xs;
+
+    gb_array_init(xs, counting);
+    for (i = 0; i < (1 << 22); i++)
+      gb_array_append(xs, i);
+    GB_ASSERT(xs[(1 << 22) - 1] == (1 << 22) - 1 && xs[12345] == 12345);
+    GB_ASSERT(counts[gbAllocation_Alloc] == 1 && counts[gbAllocation_Free] == 0);
+    GB_ASSERT(counts[gbAllocation_Resize] > 15);
+    gb_array_free(xs);
+    GB_ASSERT(counts[gbAllocation_Free] == 1);
+  }
+
+  // NOTE: Blocks allocated on one thread and freed on another
+  for (i = 0; i < THREAD_COUNT; i++) {
+    gb_thread_init(&threads[i]);
+    gb_thread_start(&threads[i], alloc_blocks, blocks[i]);
+  }
+  for (i = 0; i < THREAD_COUNT; i++)
+    gb_thread_join(&threads[i]);
+  for (i = 0; i < THREAD_COUNT; i++)
+    gb_thread_start(&threads[i], free_blocks, blocks[(i + 1) % THREAD_COUNT]);
+  for (i = 0; i < THREAD_COUNT; i++) {
+    gb_thread_join(&threads[i]);
+    gb_thread_destory(&threads[i]);
+  }
+
+  gb_heap_thread_flush();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,281 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+
+#include "gb/htable.h"
+#include "gb/io.h"
+
+GB_TABLE(static, IntTable, int_table_, int64_t);
+GB_FLAT_TABLE(static, FlatTable, flat_table_, int64_t);
+
+typedef struct point {
+  int16_t x;
+  int32_t y;
+} point_t;
+
+GB_TABLE_KEYED(static, StringTable, string_table_, gbString, int64_t, gb_table_hash_string, gb_table_eq_string);
+GB_TABLE_KEYED(static, BytesTable, bytes_table_, gbByteSlice, int64_t, gb_table_hash_bytes, gb_table_eq_bytes);
+GB_TABLE_KEYED(static, PointTable, point_table_, point_t, int64_t, gb_table_hash_pod, gb_table_eq_pod);
+
+// NOTE: Every key hashes the same, so only the cached hash comparison failing would be wrong
+gb_internal uint64_t colliding_hash(gbByteSlice const *key) {
+  return 42;
+}
+GB_TABLE_KEYED(static, CollidingTable, colliding_table_, gbByteSlice, int64_t, colliding_hash, gb_table_eq_bytes);
+
+int main(void) {
+  gb_allocator_t a = gb_heap_allocator();
+  ssize_t i;
+
+  // NOTE: Flat table, keys sharing their low bits still spread and every group stays reachable
+  {
+    FlatTable h;
+    int64_t *v;
+    ssize_t full = 0;
+
+    flat_table_init(&h, a);
+    GB_ASSERT(flat_table_get(&h, 42) == NULL);
+    for (i = 0; i < 100000; i++)
+      flat_table_set(&h, cast(uint64_t) i << 20, i);
+    for (i = 0; i < 100000; i += 2)
+      flat_table_set(&h, cast(uint64_t) i << 20, -i);
+    GB_ASSERT(h.count == 100000);
+    GB_ASSERT(gb_is_power_of_two(h.capacity) && h.count * 8 <= h.capacity * 7);
+    for (i = 0; i < 100000; i++) {
+      v = flat_table_get(&h, cast(uint64_t) i << 20);
+      GB_ASSERT(v != NULL && *v == (i % 2 == 0 ? -i : i));
+      GB_ASSERT(flat_table_get(&h, (cast(uint64_t) i << 20) + 1) == NULL);
+    }
+    for (i = 0; i < h.capacity; i++) {
+      if (h.ctrl[i] >= 0)
+        full++;
+      if (i < GB_FLAT_TABLE_GROUP_SIZE)
+        GB_ASSERT(h.ctrl[h.capacity + i] == h.ctrl[i]);
+    }
+    GB_ASSERT(full == h.count);
+
+    flat_table_rehash(&h, 4 * h.capacity);
+    GB_ASSERT(h.count == 100000 && *flat_table_get(&h, cast(uint64_t) 99999 << 20) == 99999);
+    flat_table_destroy(&h);
+
+    flat_table_init(&h, a);
+    flat_table_set(&h, 0, 7);
+    GB_ASSERT(h.capacity == GB_FLAT_TABLE_GROUP_SIZE && *flat_table_get(&h, 0) == 7);
+    flat_table_destroy(&h);
+  }
+
+  // NOTE: Chained table, same surface
+  {
+    IntTable h;
+
+    int_table_init(&h, a);
+    for (i = 0; i < 10000; i++)
+      int_table_set(&h, cast(uint64_t) i * 7, i);
+    for (i = 0; i < 10000; i++)
+      GB_ASSERT(*int_table_get(&h, cast(uint64_t) i * 7) == i);
+    GB_ASSERT(int_table_get(&h, 1) == NULL);
+    int_table_destroy(&h);
+  }
+
+  // NOTE: Removing swaps the last entry into the hole and relinks its chain, colliding keys included
+  {
+    IntTable h;
+
+    int_table_init(&h, a);
+    GB_ASSERT(!int_table_remove(&h, 3));
+    for (i = 0; i < 1000; i++)
+      int_table_set(&h, cast(uint64_t) i, i);
+    for (i = 0; i < 1000; i += 3)
+      GB_ASSERT(int_table_remove(&h, cast(uint64_t) i));
+    GB_ASSERT(!int_table_remove(&h, 0));
+    GB_ASSERT(gb_array_count(h.entries) == 666);
+    for (i = 0; i < 1000; i++) {
+      int64_t *v = int_table_get(&h, cast(uint64_t) i);
+      GB_ASSERT(i % 3 == 0 ? v == NULL : v != NULL && *v == i);
+    }
+    for (i = 0; i < 1000; i++)
+      int_table_remove(&h, cast(uint64_t) i);
+    GB_ASSERT(gb_array_count(h.entries) == 0 && int_table_get(&h, 1) == NULL);
+    int_table_set(&h, 5, 50);
+    GB_ASSERT(*int_table_get(&h, 5) == 50);
+    int_table_destroy(&h);
+  }
+
+  // NOTE: Incremental rehash, both bucket arrays stay consistent while a migration is pending
+  {
+    IntTable h;
+    byte32_t pending = false;
+
+    int_table_init(&h, a);
+    int_table_set_rehash_step(&h, 4);
+    for (i = 0; i < 100000; i++) {
+      int_table_set(&h, cast(uint64_t) i * 7, i);
+      if (h.old_hashes) {
+        pending = true;
+        GB_ASSERT(h.migrated < gb_array_count(h.old_hashes));
+        GB_ASSERT(*int_table_get(&h, 0) == 0 && *int_table_get(&h, cast(uint64_t) i * 7) == i);
+      }
+      if (i % 5 == 0 && i > 0)
+        GB_ASSERT(int_table_remove(&h, cast(uint64_t) (i - 1) * 7));
+    }
+    GB_ASSERT(pending);
+    for (i = 0; i < 100000; i++) {
+      int64_t *v = int_table_get(&h, cast(uint64_t) i * 7);
+      GB_ASSERT((i % 5 == 4 && i < 99999) ? v == NULL : v != NULL && *v == i);
+    }
+    int_table_set_rehash_step(&h, 0);
+    GB_ASSERT(h.old_hashes == NULL);
+    int_table_rehash(&h, 1024);
+    GB_ASSERT(h.old_hashes == NULL && gb_array_count(h.hashes) == 1024 && *int_table_get(&h, 7) == 1);
+    int_table_destroy(&h);
+  }
+
+  // NOTE: Batched lookups and inserts agree with get and set, repeated keys inside a window included
+  {
+    IntTable h;
+    uint64_t keys[1000];
+    int64_t values[1000], *found[1000];
+
+    int_table_init(&h, a);
+    for (i = 0; i < 1000; i++) {
+      keys[i] = cast(uint64_t) (i % 600) * 13;
+      values[i] = i;
+    }
+    int_table_set_many(&h, keys, values, 1000);
+    GB_ASSERT(gb_array_count(h.entries) == 600);
+    for (i = 0; i < 600; i++)
+      GB_ASSERT(*int_table_get(&h, cast(uint64_t) i * 13) == (i < 400 ? i + 600 : i));
+
+    for (i = 0; i < 1000; i++)
+      keys[i] = cast(uint64_t) i * 13;
+    GB_ASSERT(int_table_get_many(&h, keys, 1000, found) == 600);
+    for (i = 0; i < 1000; i++)
+      GB_ASSERT(found[i] == int_table_get(&h, keys[i]));
+    GB_ASSERT(int_table_get_many(&h, keys, 0, found) == 0);
+    int_table_destroy(&h);
+
+    int_table_init(&h, a);
+    GB_ASSERT(int_table_get_many(&h, keys, 3, found) == 0 && found[2] == NULL);
+    int_table_set_rehash_step(&h, 4);
+    for (i = 0; i < 100; i++) {
+      ssize_t j;
+      for (j = 0; j < 1000; j++) {
+        keys[j] = cast(uint64_t) (i * 1000 + j);
+        values[j] = -keys[j];
+      }
+      int_table_set_many(&h, keys, values, 1000);
+      GB_ASSERT(int_table_get_many(&h, keys, 1000, found) == 1000);
+      for (j = 0; j < 1000; j++)
+        GB_ASSERT(*found[j] == values[j]);
+    }
+    GB_ASSERT(gb_array_count(h.entries) == 100000 && *int_table_get(&h, 0) == 0);
+
+    // NOTE: A step too large to scale by the window saturates instead of overflowing
+    int_table_set_rehash_step(&h, SSIZE_MAX);
+    for (i = 0; i < 1000; i++)
+      keys[i] = cast(uint64_t) (100000 + i);
+    int_table_set_many(&h, keys, values, 1000);
+    GB_ASSERT(h.old_hashes == NULL && int_table_get_many(&h, keys, 1000, found) == 1000);
+    int_table_destroy(&h);
+  }
+
+  // NOTE: Keyed tables, strings equal by content, slices by bytes and structs by their zeroed bytes
+  {
+    StringTable st;
+    BytesTable bt;
+    PointTable pt;
+    CollidingTable ct;
+    gbString keys[1000];
+    gbByteSlice slice;
+    char const *words[] = {"alpha", "beta", "alphabet", ""};
+
+    string_table_init(&st, a);
+    for (i = 0; i < 1000; i++) {
+      keys[i] = gb_string_make(a, gb_bprintf("key%td", i));
+      string_table_set(&st, &keys[i], i);
+    }
+    for (i = 0; i < 1000; i++) {
+      gbString probe = gb_string_make(a, gb_bprintf("key%td", i));
+      GB_ASSERT(*string_table_get(&st, &probe) == i);
+      gb_string_free(probe);
+    }
+    for (i = 0; i < 1000; i += 2)
+      GB_ASSERT(string_table_remove(&st, &keys[i]));
+    GB_ASSERT(gb_array_count(st.entries) == 500 && string_table_get(&st, &keys[0]) == NULL);
+    for (i = 1; i < 1000; i += 2)
+      GB_ASSERT(*string_table_get(&st, &keys[i]) == i);
+    for (i = 0; i < gb_array_count(st.entries); i++)
+      GB_ASSERT(st.entries[i].hash == gb_table_hash_string(&st.entries[i].key));
+    string_table_destroy(&st);
+    for (i = 0; i < 1000; i++)
+      gb_string_free(keys[i]);
+
+    bytes_table_init(&bt, a);
+    colliding_table_init(&ct, a);
+    for (i = 0; i < gb_count_of(words); i++) {
+      slice = gb_byte_slice(words[i], gb_strlen(words[i]));
+      bytes_table_set(&bt, &slice, i);
+      colliding_table_set(&ct, &slice, i);
+    }
+    for (i = 0; i < gb_count_of(words); i++) {
+      slice = gb_byte_slice(words[i], gb_strlen(words[i]));
+      GB_ASSERT(*bytes_table_get(&bt, &slice) == i);
+      GB_ASSERT(*colliding_table_get(&ct, &slice) == i);
+    }
+    slice = gb_byte_slice("alphabet soup", 5);
+    GB_ASSERT(*bytes_table_get(&bt, &slice) == 0);
+    slice = gb_byte_slice("alp", 3);
+    GB_ASSERT(colliding_table_get(&ct, &slice) == NULL);
+    slice = gb_byte_slice("beta", 4);
+    GB_ASSERT(colliding_table_remove(&ct, &slice));
+    slice = gb_byte_slice("", 0);
+    GB_ASSERT(*colliding_table_get(&ct, &slice) == 3);
+    bytes_table_destroy(&bt);
+    colliding_table_destroy(&ct);
+
+    point_table_init(&pt, a);
+    for (i = 0; i < 10000; i++) {
+      point_t p;
+      gb_zero_item(&p);
+      p.x = cast(int16_t) (i % 100);
+      p.y = cast(int32_t) (i / 100);
+      point_table_set(&pt, &p, i);
+    }
+    point_table_rehash(&pt, 3);
+    for (i = 0; i < 10000; i++) {
+      point_t p;
+      gb_zero_item(&p);
+      p.x = cast(int16_t) (i % 100);
+      p.y = cast(int32_t) (i / 100);
+      GB_ASSERT(*point_table_get(&pt, &p) == i);
+    }
+    point_table_destroy(&pt);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+#include <stdio.h>
+
+#include "gb/profile.h"
+#include "gb/heap.h"
+#include "gb/string.h"
+
+#define BLOCK_COUNT 16384
+#define BLOCK_SIZE  256
+
+gb_global void *blocks[BLOCK_COUNT];
+
+int main(void) {
+  gb_heap_profiler_t profiler;
+  gb_allocator_t a;
+  gbFileContents fc;
+  gbFile f;
+  ssize_t i, expected;
+
+  gb_heap_profiler_init(&profiler, gb_heap_allocator(), gb_kilobytes(4));
+  a = gb_heap_profiler_allocator(&profiler);
+
+  // NOTE: About one sample every 4 KiB allocated
+  {
+    for (i = 0; i < BLOCK_COUNT; i++) {
+      blocks[i] = gb_alloc(a, BLOCK_SIZE);
+      GB_ASSERT_NOT_NULL(blocks[i]);
+    }
+    expected = BLOCK_COUNT * BLOCK_SIZE / gb_kilobytes(4);
+    GB_ASSERT(profiler.sample_count > expected / 2 && profiler.sample_count < expected * 2);
+    GB_ASSERT(gb_array_count(profiler.stacks.entries) >= 1);
+
+    for (i = 0; i < BLOCK_COUNT; i += 2)
+      gb_free(a, blocks[i]);
+    GB_ASSERT(profiler.sample_count > expected / 4 && profiler.sample_count < expected);
+    for (i = 1; i < BLOCK_COUNT; i += 2)
+      blocks[i] = gb_resize(a, blocks[i], BLOCK_SIZE, 2 * BLOCK_SIZE);
+    for (i = 1; i < BLOCK_COUNT; i += 2)
+      gb_free(a, blocks[i]);
+    GB_ASSERT(profiler.sample_count == 0);
+    for (i = 0; i < gb_array_count(profiler.stacks.entries); i++)
+      GB_ASSERT(profiler.stacks.entries[i].value.live_bytes == 0);
+  }
+
+  // NOTE: Legacy pprof text format
+  {
+    GB_ASSERT(gb_file_create(&f, "test_profile.heap") == gbFileError_None);
+    GB_ASSERT(gb_heap_profiler_write(&profiler, &f, gbHeapProfile_Allocs));
+    gb_file_close(&f);
+
+    fc = gb_file_read_contents(gb_heap_allocator(), true, "test_profile.heap");
+    GB_ASSERT_NOT_NULL(fc.data);
+    GB_ASSERT(gb_strncmp(cast(char *) fc.data, "heap profile: 0: 0 [", 20) == 0);
+    GB_ASSERT(strstr(cast(char *) fc.data, "] @ heap_v2/4096\n") != NULL);
+    GB_ASSERT(strstr(cast(char *) fc.data, " @ 0x") != NULL);
+    gb_file_free_contents(&fc);
+
+    // NOTE: Nothing was allocated since the last allocation profile
+    GB_ASSERT(gb_file_create(&f, "test_profile.heap") == gbFileError_None);
+    GB_ASSERT(gb_heap_profiler_write(&profiler, &f, gbHeapProfile_Allocs));
+    gb_file_close(&f);
+    fc = gb_file_read_contents(gb_heap_allocator(), true, "test_profile.heap");
+    GB_ASSERT(gb_strncmp(cast(char *) fc.data, "heap profile: 0: 0 [0: 0] @ heap_v2/4096\n", 41) == 0);
+    gb_file_free_contents(&fc);
+    remove("test_profile.heap");
+  }
+
+  gb_heap_profiler_free(&profiler);
+
+  return EXIT_SUCCESS;
+}
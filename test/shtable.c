@@ -0,0 +1,136 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+
+#include "gb/shtable.h"
+#include "gb/thread.h"
+
+typedef struct pair {
+  int64_t a, b;
+} pair_t;
+
+GB_SHARDED_TABLE(static, IntTable, int_table_, int64_t);
+GB_SHARDED_TABLE(static, PairTable, pair_table_, pair_t);
+
+#define THREAD_COUNT 8
+#define KEY_COUNT    20000
+
+gb_global PairTable shared;
+gb_global int64_t inserted_by[THREAD_COUNT][KEY_COUNT];
+gb_global gbAtomic32 writers_done;
+
+gb_internal void pair_increment(pair_t *value, byte32_t found, void *data) {
+  GB_ASSERT(found || (value->a == 0 && value->b == 0));
+  value->a++;
+  value->b++;
+}
+
+gb_internal GB_THREAD_PROC(writer) {
+  int64_t id = cast(int64_t) cast(intptr_t) data;
+  ssize_t i;
+
+  for (i = 0; i < KEY_COUNT; i++) {
+    pair_t mine, out;
+    pair_table_update(&shared, cast(uint64_t) i, pair_increment, NULL);
+    mine.a = mine.b = id;
+    pair_table_get_or_insert(&shared, cast(uint64_t) (KEY_COUNT + i), mine, &out);
+    inserted_by[id][i] = out.a;
+  }
+  gb_atomic32_fetch_add(&writers_done, 1);
+}
+
+gb_internal GB_THREAD_PROC(reader) {
+  uint64_t key = 0;
+
+  while (gb_atomic32_load(&writers_done) < THREAD_COUNT) {
+    pair_t value;
+    if (pair_table_get(&shared, key, &value))
+      GB_ASSERT(value.a == value.b && value.a <= THREAD_COUNT);
+    key = (key + 7919) % (2 * KEY_COUNT);
+  }
+}
+
+int main(void) {
+  gb_allocator_t a = gb_heap_allocator();
+  ssize_t i, j;
+
+  // NOTE: Single thread, growth through every shard, overwrite and backward shift removal
+  {
+    IntTable h;
+    int64_t v;
+
+    int_table_init(&h, a, 4);
+    GB_ASSERT(!int_table_get(&h, 1, &v));
+    for (i = 0; i < 100000; i++)
+      int_table_set(&h, cast(uint64_t) i << 16, i);
+    for (i = 0; i < 100000; i += 2)
+      int_table_set(&h, cast(uint64_t) i << 16, -i);
+    GB_ASSERT(int_table_count(&h) == 100000);
+    for (i = 0; i < 100000; i += 3)
+      GB_ASSERT(int_table_remove(&h, cast(uint64_t) i << 16));
+    GB_ASSERT(!int_table_remove(&h, 0));
+    GB_ASSERT(int_table_count(&h) == 100000 - 33334);
+    for (i = 0; i < 100000; i++) {
+      byte32_t found = int_table_get(&h, cast(uint64_t) i << 16, &v);
+      GB_ASSERT(i % 3 == 0 ? !found : found && v == (i % 2 == 0 ? -i : i));
+    }
+    GB_ASSERT(!int_table_get_or_insert(&h, 1 << 16, 5, &v) && v == 1);
+    GB_ASSERT(int_table_get_or_insert(&h, 3 << 16, 5, &v) && v == 5);
+    int_table_destroy(&h);
+  }
+
+  // NOTE: Writers race on the same keys while a reader checks it never sees a half written value
+  {
+    gbThread threads[THREAD_COUNT + 1];
+
+    pair_table_init(&shared, a, 0);
+    for (i = 0; i < THREAD_COUNT; i++) {
+      gb_thread_init(&threads[i]);
+      gb_thread_start(&threads[i], writer, cast(void *) cast(intptr_t) i);
+    }
+    gb_thread_init(&threads[THREAD_COUNT]);
+    gb_thread_start(&threads[THREAD_COUNT], reader, NULL);
+    for (i = 0; i <= THREAD_COUNT; i++) {
+      gb_thread_join(&threads[i]);
+      gb_thread_destory(&threads[i]);
+    }
+
+    GB_ASSERT(pair_table_count(&shared) == 2 * KEY_COUNT);
+    for (i = 0; i < KEY_COUNT; i++) {
+      pair_t value;
+      GB_ASSERT(pair_table_get(&shared, cast(uint64_t) i, &value));
+      GB_ASSERT(value.a == THREAD_COUNT && value.b == THREAD_COUNT);
+      GB_ASSERT(pair_table_get(&shared, cast(uint64_t) (KEY_COUNT + i), &value));
+      for (j = 0; j < THREAD_COUNT; j++)
+        GB_ASSERT(inserted_by[j][i] == value.a);
+    }
+    pair_table_destroy(&shared);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+
+#include "gb/slotmap.h"
+
+typedef struct Entity {
+  int64_t id;
+  float x, y;
+} Entity;
+
+GB_SLOT_MAP(static, EntityMap, entity_map_, Entity);
+
+int main(void) {
+  EntityMap m;
+  uint64_t handles[1000];
+  uint64_t stale;
+  Entity e = {0}, *p;
+  ssize_t i, sum;
+
+  entity_map_init(&m, gb_heap_allocator());
+
+  // NOTE: Handles find their value wherever it was moved to by removals
+  {
+    for (i = 0; i < gb_count_of(handles); i++) {
+      e.id = i;
+      handles[i] = entity_map_insert(&m, e);
+      GB_ASSERT(handles[i] != GB_SLOT_HANDLE_NONE);
+    }
+    for (i = 0; i < gb_count_of(handles); i += 2)
+      GB_ASSERT(entity_map_remove(&m, handles[i]));
+    GB_ASSERT(gb_array_count(m.values) == 500);
+    for (i = 0; i < gb_count_of(handles); i++) {
+      p = entity_map_get(&m, handles[i]);
+      GB_ASSERT(i % 2 == 0 ? p == NULL : p != NULL && p->id == i);
+    }
+
+    sum = 0;
+    for (i = 0; i < gb_array_count(m.values); i++) {
+      sum += m.values[i].id;
+      GB_ASSERT(entity_map_get(&m, entity_map_handle(&m, i)) == &m.values[i]);
+    }
+    GB_ASSERT(sum == 250000);
+  }
+
+  // NOTE: Freed slots are reused with a new generation, stale handles stay dead
+  {
+    stale = handles[0];
+    GB_ASSERT(!entity_map_remove(&m, stale));
+    e.id = -1;
+    handles[0] = entity_map_insert(&m, e);
+    GB_ASSERT(gb_slot_handle_index(handles[0]) == gb_slot_handle_index(handles[998]));
+    GB_ASSERT(gb_slot_handle_generation(handles[0]) == 2);
+    GB_ASSERT(gb_array_count(m.slots) == 1000);
+    GB_ASSERT(entity_map_get(&m, stale) == NULL);
+    GB_ASSERT(entity_map_get(&m, handles[0])->id == -1);
+  }
+
+  // NOTE: Clearing invalidates every handle but keeps the storage
+  {
+    entity_map_clear(&m);
+    GB_ASSERT(gb_array_count(m.values) == 0);
+    GB_ASSERT(entity_map_get(&m, handles[1]) == NULL);
+    GB_ASSERT(entity_map_get(&m, handles[0]) == NULL);
+    for (i = 0; i < gb_count_of(handles); i++)
+      handles[i] = entity_map_insert(&m, e);
+    GB_ASSERT(gb_array_count(m.slots) == 1000);
+    GB_ASSERT(entity_map_remove(&m, handles[999]) && gb_array_count(m.values) == 999);
+  }
+
+  entity_map_destroy(&m);
+  return EXIT_SUCCESS;
+}
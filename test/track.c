@@ -0,0 +1,118 @@
+/*
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#include <cute.h>
+
+#include "gb/track.h"
+#include "gb/string.h"
+
+int main(void) {
+  gb_tracker_t tracker;
+  gb_allocator_t a;
+  gb_track_stats_t stats;
+  gb_track_site_t *site;
+  uint8_t *p, *q;
+  int32_t line;
+  ssize_t i;
+
+  gb_tracker_init(&tracker, gb_heap_allocator(), true);
+  a = gb_tracker_allocator(&tracker);
+
+  // NOTE: Live and peak bytes, counts and histogram
+  {
+    p = cast(uint8_t *) gb_alloc(a, 100);
+    q = cast(uint8_t *) gb_alloc_align(a, 1000, 64);
+    GB_ASSERT((cast(uintptr_t) q & 63) == 0);
+    for (i = 0; i < 100; i++)
+      GB_ASSERT(p[i] == 0);
+    gb_memset(p, 0xab, 100);
+    stats = gb_tracker_stats(&tracker);
+    GB_ASSERT(stats.live_bytes == 1100 && stats.peak_bytes == 1100);
+    GB_ASSERT(stats.alloc_count == 2);
+    GB_ASSERT(stats.histogram[7] == 1 && stats.histogram[10] == 1);
+
+    p = cast(uint8_t *) gb_resize(a, p, 100, 5000);
+    for (i = 0; i < 100; i++)
+      GB_ASSERT(p[i] == 0xab);
+    for (i = 100; i < 5000; i++)
+      GB_ASSERT(p[i] == 0);
+    gb_free(a, q);
+    stats = gb_tracker_stats(&tracker);
+    GB_ASSERT(stats.live_bytes == 5000 && stats.peak_bytes == 6000);
+    GB_ASSERT(stats.resize_count == 1 && stats.free_count == 1);
+
+    gb_free(a, p);
+    stats = gb_tracker_stats(&tracker);
+    GB_ASSERT(stats.live_bytes == 0 && stats.total_bytes == 6000);
+  }
+
+  // NOTE: Call sites
+  {
+    line = __LINE__ + 1;
+    p = cast(uint8_t *) gb_alloc_here(a, 64);
+    p = cast(uint8_t *) gb_resize_here(a, p, 64, 128);
+    site = gb_tracker_site(&tracker, __FILE__, line);
+    GB_ASSERT_NOT_NULL(site);
+    GB_ASSERT(site->alloc_count == 1 && site->peak_bytes == 64);
+    GB_ASSERT(site->live_bytes == 0); // NOTE: The resize took the block over
+    site = gb_tracker_site(&tracker, __FILE__, line + 1);
+    GB_ASSERT_NOT_NULL(site);
+    GB_ASSERT(site->resize_count == 1 && site->live_bytes == 128);
+    gb_free(a, p);
+    GB_ASSERT(site->free_count == 1 && site->live_bytes == 0 && site->peak_bytes == 128);
+  }
+
+  // NOTE: gbArray grows and gbString appends are charged to the line that called the macro
+  {
+    gbArray(int32_t) ints;
+    gbString str = gb_string_make(a, "");
+    gb_track_site_t *array_site, *string_site;
+    int32_t array_line = 0, string_line = 0;
+
+    gb_array_init(ints, a);
+    for (i = 0; i < 1000; i++) {
+      array_line = __LINE__ + 1;
+      gb_array_append(ints, cast(int32_t) i);
+      string_line = __LINE__ + 1;
+      str = gb_string_appendc(str, "x");
+    }
+    array_site = gb_tracker_site(&tracker, __FILE__, array_line);
+    string_site = gb_tracker_site(&tracker, __FILE__, string_line);
+    GB_ASSERT_NOT_NULL(array_site);
+    GB_ASSERT_NOT_NULL(string_site);
+    GB_ASSERT(array_site->alloc_count + array_site->resize_count > 1);
+    GB_ASSERT(string_site->resize_count > 1);
+    gb_array_free(ints);
+    gb_string_free(str);
+    GB_ASSERT(gb_tracker_stats(&tracker).live_bytes == 0);
+  }
+
+  gb_tracker_dump(&tracker, gb_file_get_standard(gbFileStandard_Output), 8);
+  gb_tracker_free(&tracker);
+
+  return EXIT_SUCCESS;
+}